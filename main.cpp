@@ -10,9 +10,26 @@
 // Method
 //  A thread scheduallar is used in order to carry out multiple processes. The maximum number of 
 //  additional threads we were able to use was 10. As a result, several processes with the same
-//  repetition rate had to go under a single thread.  
+//  repetition rate had to go under a single thread. The slow processes now run as
+//  cooperative tasks on one thread, which only needs a stack for that thread.
+//  Defining TIME_TRIGGERED instead releases every process from a static schedule table.
+//  Defining ACTIVATION_CHAIN samples the pedals right before every simulation step, so at
+//  20 Hz instead of 10 Hz, averages every 4th step and moves the servo after every 5th average,
+//  each stage activating the next one when it is done. The LCD stays a cooperative task at 2 Hz:
+//  its I2C update takes about 20 ms and is no whole multiple of the average rate.
+//  A watchdog checks that every thread, chain stage and cooperative task with the LCD or the
+//  servo keeps to its period and worst case response time,
+//  defining HARDWARE_WATCHDOG resets the car when a thread hangs.
 // 
-//  4 semaphores are used which allows controlled access between these processes.  
+//  A semaphore and a reader-writer lock are used which allows controlled access between
+//  these processes. The inputs are read by several processes at the same time.
+//  Values passed between processes of different rates go through rate transition buffers,
+//  so each process works on values taken at one instant.
+//  The speed, the average speed and the odometer are published on topics, which readers
+//  access without a semaphore.
+//  Defining KERNEL_STATS reports the kernel and mail box usage over the serial port.
+//  Every pedal sample carries its capture time to the outputs, which track its age.
+//  Defining DATA_AGE_STATS reports the age histograms over the serial port.
 // 
 // Version
 //    Roshenac Mitchell  March 2016
@@ -55,19 +72,24 @@ int read =0;
 //  - average speed
 //  - acelerometer value
 //  - break value 
+//  - capture time and number of the oldest pedal sample behind the values
 typedef struct {
   float    speedVal; 
   float    accelerometerVal; 
   float    breakVal; 
+  uint32_t captureTime;
+  uint32_t sampleId;
 } mail_t;
 
-Mail<mail_t, 100> mail_box;
+MailBox<mail_t, 100> mail_box;
    
 //Semaphores to manage accessing the viriables 
-Semaphore CAR_MAIL_SEM(1);          // controls the read and sent messages
-Semaphore INPUT_SEM(1);             // controls the read and sent inputs
-Semaphore Speed_SEM(1);             // controls the calculated speed
-Semaphore AVR_SPEED_SEM(1);         // controls the calculated average speed
+Semaphore CAR_MAIL_SEM(1, true);    // controls the read and sent messages
+
+#ifndef TIME_TRIGGERED
+// the slow periodic processes run as cooperative tasks on a single thread
+StaticCoopScheduler<4> cooperative;
+#endif
 
 // Local filesystem under the name "local" 
 // This is used for writing to the csv file
@@ -75,163 +97,185 @@ LocalFileSystem local("local");
 
 // speed variables
 const float maxSpeed = 140; //
-float currentSpeed; 
-float averageSpeed; 
+Topic<Stamped<float> > currentSpeed; // latest simulated speed, with a version number
+Topic<Stamped<float> > averageSpeed; // latest average speed, with a version number
 
-// counter used to store last 3 speed values
+// last 3 speed values
 // this is used when calculating average speed
 const int sampleNumber = 3;
-float speeds[sampleNumber];
+typedef struct {
+  Stamped<float> speeds[sampleNumber];
+} speeds_t;
+
+speeds_t recentSpeeds;
 int counter = 0;
 
+// pedal values read at the same time
+typedef struct {
+  float    accelerationValue;
+  float    brakeValue;
+} pedals_t;
+
+// values passed between processes of different rates,
+// each reader takes a snapshot at the start of its frame
+enum { simulationReader, mailReader };
+RateTransition<Stamped<pedals_t>, 2> pedals;    // 10 Hz to the 20 Hz simulation and the mail
+RateTransition<speeds_t> lastSpeeds;            // 20 Hz simulation to the 5 Hz average
+
+// on/off states read from the switches, one bit each
+// read and written without a lock through the bit-band alias of the AHB SRAM
+FlagSet vehicleFlags __attribute__((section("AHBSRAM0")));
+BitFlag engineState(vehicleFlags, 0);
+BitFlag leftLightState(vehicleFlags, 1);
+BitFlag rightLightState(vehicleFlags, 2);
+
 // calculated or read values from the inputs
-float accelerationValue;
-float brakeValue;
-int engineState;
-int leftLightState; 
-int rightLightState;
-float odometerValue = 0; 
+Topic<float> odometer;              // distance driven, with a version number
+uint32_t pedalSample = 0;
+
+// age of the pedal samples behind each output
+// an output using a sample older than staleAge_us raises an alarm
+const uint32_t staleAge_us = 2000000;
+AgeMonitor servoAge("servo");
+AgeMonitor lcdAge("lcd");
+AgeMonitor mailAge("mail", 0, 100000);
+
+// report an output showing a speed from an old pedal sample
+void staleAlarm(AgeMonitor &monitor, uint32_t age_us, uint32_t seq)
+{
+    serial.printf("stale %s: pedal sample %lu is %lu ms old\r\n", monitor.name(), seq, age_us / 1000);
+}
 
 
 // Get the car acceleration and break and calculate speed
-// speed semaphores are used so these values are not altered
-// any anything process while getting the values. 
+// the pedals and engine state are taken once, so they belong to the same instant
 // repetition rate 20Hz = 0.05 seconds
 void carSimulation(void const *args){
-    while (true) {
-        // calculate current speed from these values
-        Speed_SEM.wait(); 
-        // both acceleration and break value range between 0 and 1
-        // engine state is either 0 or 1
-        float totalAcc = (accelerationValue - brakeValue) * 100;
-        float time = 0.05;
-        currentSpeed = (currentSpeed + float(totalAcc * time)) * engineState;
-        
-        if(currentSpeed < 0)
-        {
-            currentSpeed = 0;
-        }
-        if(currentSpeed > maxSpeed)
-        {
-            currentSpeed = maxSpeed; 
-        }
-        
-        Speed_SEM.release();
-        
-        // saves the last 3 speeds
-        speeds[counter] = currentSpeed;       
-        counter++;
-        if(counter > 2)
-        {
-            counter = 0;
-        }
-           
-        Thread::wait(50);
+    pedals.update(simulationReader);
+    const Stamped<pedals_t> &pedal = pedals.value(simulationReader);
+    bool engineOn = engineState;
+
+    // calculate current speed from these values
+    // both acceleration and break value range between 0 and 1
+    // engine state is either 0 or 1
+    float totalAcc = (pedal.value.accelerationValue - pedal.value.brakeValue) * 100;
+    float time = 0.05;
+    Stamped<float> speed;
+    speed.value = (currentSpeed.get().value + float(totalAcc * time)) * engineOn;
+    
+    if(speed.value < 0)
+    {
+        speed.value = 0;
     }
+    if(speed.value > maxSpeed)
+    {
+        speed.value = maxSpeed; 
+    }
+    speed.derive(pedal);
+    currentSpeed.publish(speed);
+    
+    // saves the last 3 speeds and passes them on as one set
+    recentSpeeds.speeds[counter] = speed;       
+    counter++;
+    if(counter > 2)
+    {
+        counter = 0;
+    }
+    lastSpeeds.publish(recentSpeeds);
 }
 
 
 // Read brake and accelerator values from variable resistors
-// input semaphore is so these values are not changed while reading them
-// Repetition rate 10Hz  =  0.1 seconds
+// both values are published together so readers never mix old and new values
+// Repetition rate 10Hz  =  0.1 seconds (20Hz with ACTIVATION_CHAIN)
 void readBreakAndAccel(void const *args){
-    while (true) {
-        INPUT_SEM.wait();
-        accelerationValue = acceleratorPedal.read();
-        brakeValue =  brakePedal.read();
-        INPUT_SEM.release();
-        Thread::wait(100);
-    }
+    Stamped<pedals_t> pedal;
+    pedal.capture(++pedalSample);
+    pedal.value.accelerationValue = acceleratorPedal.read();
+    pedal.value.brakeValue =  brakePedal.read();
+    pedals.publish(pedal);
 } 
 
 
 // Read engine on/off switch and show current state on an LED.
-// input semaphore is so this values is not changed while reading it
+// the state is kept in a vehicle flag for the simulation
 // Repetition rate 2 Hz = 0.5 seconds
 void readEngine(void const *args){
-    while (true) {
-        INPUT_SEM.wait();
-        engineState = engineSwitch.read();
-        INPUT_SEM.release();
-        // switch engine light on or off respectively
-        engineLight = engineState;   
-        Thread::wait(500); 
-    }
+    int engineOn = engineSwitch.read();
+    engineState = engineOn;
+    // switch engine light on or off respectively
+    engineLight = engineOn;   
 }
 
 
 // Filter speed with averaging filter
-// The last 3 speeds are used to caculate an average
-// Both the speed and the average speed semaphores are used
+// The last 3 speeds of one simulation step are used to caculate an average
+// The average is published to its readers with the stamp of the oldest speed
 // Repetition rate 5 Hz = 0.2 seconds
 void getAverageSpeed(void const *args) {
-    while (true) {
-        int sum = 0; 
-        Speed_SEM.wait();
-        AVR_SPEED_SEM.wait();
-        
-        // get the sum of the last 3 speeds
-        for(int i =0; i< sampleNumber ; i++)
-        {
-            sum += speeds[i];
-        }
-        // get the average of the last 3 speeds
-        averageSpeed = sum/sampleNumber;
-        
-        AVR_SPEED_SEM.release();
-        Speed_SEM.release();
-        Thread::wait(200);
-    } 
+    int sum = 0; 
+    lastSpeeds.update();
+    const speeds_t &recent = lastSpeeds.value();
+    Stamped<float> average = recent.speeds[0];
+    
+    // get the sum of the last 3 speeds
+    for(int i =0; i< sampleNumber ; i++)
+    {
+        sum += recent.speeds[i].value;
+        average.derive_oldest(recent.speeds[i]);
+    }
+    // get the average of the last 3 speeds
+    average.value = sum/sampleNumber;
+    averageSpeed.publish(average);
 }
 
 
 // Flash an LED if speed goes over 70 mph
-// average speed semaphore is used so this value is not changed
-// Repetition rate 0.5 Hz = 2 seconds
+// Repetition rate 0.5 Hz = 2 seconds (cooperative task)
 void speedOver70(void const *args){
-    while(true){
-        AVR_SPEED_SEM.wait();
-        if(averageSpeed > 70)
-        {
-            // ! used to flip the values each time which
-            // creates flashing.
-            OverSpeedLED = !OverSpeedLED; 
-        }else
-        {
-            OverSpeedLED = 0;
-        }
-        AVR_SPEED_SEM.release();        
-        Thread::wait(2000);
-    }       
+    if(averageSpeed.get().value > 70)
+    {
+        // ! used to flip the values each time which
+        // creates flashing.
+        OverSpeedLED = !OverSpeedLED; 
+    }else
+    {
+        OverSpeedLED = 0;
+    }
 }
 
 
 // Send speed, accelerometer and brake values to a 100 element MAIL queue
 // car mail semaphore used to protect messages
-// average speed and input semphore used to fix vales
+// the pedal values are taken from one instant
 // Repetition rate 0.2 Hz = 5 seconds
 void sendToMail(void const *args){
-    while(true){
-        mail_t *mail = mail_box.alloc();
-        CAR_MAIL_SEM.wait();
-
-        AVR_SPEED_SEM.wait();
-        mail->speedVal = averageSpeed; 
-        AVR_SPEED_SEM.release();
-        
-        INPUT_SEM.wait();
-        mail->accelerometerVal = accelerationValue;
-        mail->breakVal = brakeValue;
-        INPUT_SEM.release();
-        
-        write++;        
-       
-        mail_box.put(mail);
-                
-        CAR_MAIL_SEM.release();
-                
-        Thread::wait(5000);  
+    // the mail is returned to the mail box if it is not sent
+    MailHandle<mail_t> mail;
+    if(!mail_box.emplace(mail))
+    {
+        return;
     }
+    CAR_MAIL_SEM.wait();
+
+    Stamped<float> speed = averageSpeed.get();
+    mail->speedVal = speed.value; 
+    
+    pedals.update(mailReader);
+    const Stamped<pedals_t> &pedal = pedals.value(mailReader);
+    mail->accelerometerVal = pedal.value.accelerationValue;
+    mail->breakVal = pedal.value.brakeValue;
+    
+    // the mail is as old as the oldest sample in it
+    speed.derive_oldest(pedal);
+    mail->captureTime = speed.capture_us;
+    mail->sampleId = speed.seq;
+    
+    write++;        
+   
+    mail_box.send(mail);
+            
+    CAR_MAIL_SEM.release();
 }
 
 
@@ -241,129 +285,132 @@ void sendToMail(void const *args){
 // car mail semaphore used to protect messages
 // Repetition rate 0.05 Hz = 20 seconds
 void dumpContents(void const *args){
-    while(true){
-        CAR_MAIL_SEM.wait();
-        while(write > read){
-            osEvent evt = mail_box.get();
-            if (evt.status == osEventMail) 
-            { 
-                mail_t *mail = (mail_t*)evt.value.p;           
-                
-                // values sent to csv file
-                FILE *fp = fopen("/local/Car_Values.csv", "a"); 
-                fprintf(fp,"%f ,", mail->speedVal);
-                fprintf(fp,"%f ,", mail->accelerometerVal);
-                fprintf(fp,"%f ", mail->breakVal);
-                fprintf(fp,"\r\n");
-                fclose(fp); 
-                
-                // values sent to serial port
-                serial.printf("average speed: %f ,", mail->speedVal);
-                serial.printf("break value: %f ,", mail->breakVal);
-                serial.printf("acceleration: %f ,", mail->accelerometerVal);
-                serial.printf("\r\n");
-                mail_box.free(mail);
-                read++;
-            }
+    CAR_MAIL_SEM.wait();
+    while(write > read){
+        // the mail is freed when the handle goes out of scope
+        MailHandle<mail_t> mail;
+        if (mail_box.receive(mail)) 
+        { 
+            uint32_t age_us = mailAge.record(mail->captureTime, mail->sampleId);
+            
+            // values sent to csv file
+            FILE *fp = fopen("/local/Car_Values.csv", "a"); 
+            fprintf(fp,"%f ,", mail->speedVal);
+            fprintf(fp,"%f ,", mail->accelerometerVal);
+            fprintf(fp,"%f ", mail->breakVal);
+            fprintf(fp,"\r\n");
+            fclose(fp); 
+            
+            // values sent to serial port
+            serial.printf("average speed: %f ,", mail->speedVal);
+            serial.printf("break value: %f ,", mail->breakVal);
+            serial.printf("acceleration: %f ,", mail->accelerometerVal);
+            serial.printf("age: %lu ms", age_us / 1000);
+            serial.printf("\r\n");
+            read++;
         }
-        CAR_MAIL_SEM.release();
-        Thread::wait(20000);  
     }
+    CAR_MAIL_SEM.release();
 }
 
 
 // Read the two turn indicator switches.
-// input semaphore used to protect values 
-// Repetition rate 0.5 Hz = 2 seconds
+// both flags are written at once, so readers never see half of a change
+// Repetition rate 0.5 Hz = 2 seconds (cooperative task)
 void getIndicators(void const *args){
-    while(true){
-        INPUT_SEM.wait();
-        leftLightState = leftIndicatorSwitch;
-        rightLightState = rightIndicatorSwitch;
-        INPUT_SEM.release();
-        Thread::wait(2000);
-    }
+    uint32_t lights = (leftIndicatorSwitch ? leftLightState.mask() : 0) |
+                      (rightIndicatorSwitch ? rightLightState.mask() : 0);
+    vehicleFlags.write(leftLightState.mask() | rightLightState.mask(), lights);
 }
 
 // -------------- Repetition rate 1 Hz ---------
 
 // Show the average speed value with a RC servo motor
-// average speed semaphore is used to hold this value constant
-// Repetition rate 1 Hz = 1 second
+// the servo is only moved when a new average speed was published
+// the age of the pedal sample behind the shown speed is recorded
+// Repetition rate 1 Hz = 1 second (the last stage of the ACTIVATION_CHAIN)
 void showAverageSpeed(){
-        AVR_SPEED_SEM.wait();
-        // scales the average speed to the max allowed speed
-        // servo value is between 0 and 1
-        servo = 1.0 - (averageSpeed / maxSpeed) ; 
-        AVR_SPEED_SEM.release();
+        static uint32_t shownVersion = 0;
+        Stamped<float> speed;
+        if(averageSpeed.read_if_changed(speed, shownVersion))
+        {
+            // scales the average speed to the max allowed speed
+            // servo value is between 0 and 1
+            servo = 1.0 - (speed.value / maxSpeed) ; 
+            servoAge.record(speed);
+        }
 }
 
+#ifdef ACTIVATION_CHAIN
+// step function of the servo stage of the activation chain
+void showAverageSpeedStage(void const *args)
+{
+    showAverageSpeed();
+}
+#endif
+
 
 // Read a single side light switch and set side lights accordingly
-// input semaphore used to hold value
 // Repetition rate 1 Hz = 1 second
 void readSideLight(){
-        INPUT_SEM.wait();
         int sideLightState = sideLightSwitch;
-        INPUT_SEM.release();
         sideLight = sideLightState; 
 }
 
 
 // Flash appropriate indicator LEDs at a rate of 1Hz
-// input semaphore used so value doesnt change
+// both indicator flags are read at once so they belong together
 // Repetition rate 1 Hz = 1 seconds
 void flashIndicator()
 {
-    INPUT_SEM.wait();
+    uint32_t lights = vehicleFlags.read();
+    bool left = lights & leftLightState.mask();
+    bool right = lights & rightLightState.mask();
     // only happens if a single light or no light is on
-    if(!(leftLightState && rightLightState))
+    if(!(left && right))
     { 
-        if(leftLightState)
+        if(left)
         {
             // ! used to flip value to create flashing
             leftIndicator = !leftIndicator;
             rightIndicator = 0;
         }            
-        if(rightLightState) 
+        if(right) 
         {
             leftIndicator = 0;
             // ! used to flip value to create flashing
             rightIndicator = !rightIndicator;
          }
      }
-     INPUT_SEM.release();
 }
 
 
-// single thread used to call multiple processes that 
+// single cooperative task used to call multiple processes that 
 // have a 1 Hz repetition rate
 void oneHertz(void const *args)
 {
-    while(true)
-    {
-        flashIndicator();
-        readSideLight();
-        showAverageSpeed();
-        Thread::wait(1000);
-    }    
+    flashIndicator();
+    readSideLight();
+#ifndef ACTIVATION_CHAIN
+    showAverageSpeed();
+#endif
 }
 
 
 // -------------- Repetition rate 2 Hz ---------
 
 // If both switches are switched on then flash both indicator LEDs at a rate of 2Hz (hazard mode).
-// input semaphore used so value doesnt change
+// both indicator flags are read at once so they belong together
 // Repetition rate 2 Hz = 0.5 seconds
 void flashHazard()
 {
-    INPUT_SEM.wait();
-    if(leftLightState && rightLightState)
+    uint32_t lights = vehicleFlags.read();
+    uint32_t both = leftLightState.mask() | rightLightState.mask();
+    if((lights & both) == both)
     {
         leftIndicator = !leftIndicator;
         rightIndicator = leftIndicator;
     }
-    INPUT_SEM.release();
 }
 
 
@@ -371,37 +418,224 @@ void flashHazard()
 // Shows values of LCD display
 //  - odometer values
 //  - average speed
-// average speed semaphone used to fix this value
+// the average speed is read once so both use the same value
+// the age of the pedal sample behind the shown speed is recorded
 // Repetition rate 2 Hz = 0.5 seconds 
 void updateOdometer(){
-        AVR_SPEED_SEM.wait(); 
+        Stamped<float> stamped = averageSpeed.get();
+        float speed = stamped.value;
         float time = 0.5;
-        odometerValue += averageSpeed / time ;
+        float distance = odometer.get() + speed / time ;
+        odometer.publish(distance);
         
          //show on MBED text display
         lcd->locate(0,0);
-        lcd->printf("odo : %.0f", odometerValue);
+        lcd->printf("odo : %.0f", distance);
 
         // show average speed   
         lcd->locate(1,0);
-        lcd->printf("speed : %.2f", averageSpeed);
-
-        AVR_SPEED_SEM.release(); 
+        lcd->printf("speed : %.2f", speed);
+        lcdAge.record(stamped);
 }
 
 
-// single thread used to call multiple processes that 
+// single cooperative task used to call multiple processes that 
 // have a 2 Hz repetition rate
 void twoHertz(void const *args)
 {
+    flashHazard();
+    updateOdometer();
+}
+
+
+// -------------- Scheduling ---------
+
+#ifdef TIME_TRIGGERED
+// static schedule: step function, release offset and repetition rate in ms
+// processes released at the same time run in table order
+const TTTask schedule[] = {
+    { readBreakAndAccel,   0,   100 },
+    { readEngine,          0,   500 },
+    { carSimulation,       0,    50 },
+    { getAverageSpeed,    50,   200 },
+    { getIndicators,     100,  2000 },
+    { speedOver70,       150,  2000 },
+    { oneHertz,          200,  1000 },
+    { twoHertz,          250,   500 },
+    { sendToMail,        300,  5000 },
+    { dumpContents,      350, 20000 },
+};
+#else
+// timing of the threads: repetition rate and worst case execution time budget in us
+typedef PeriodicTask<50000, 200>       carSimulationTiming;
+#ifdef ACTIVATION_CHAIN
+typedef PeriodicTask<50000, 100>       readBreakAndAccelTiming;  // sampled for every simulation step
+#else
+typedef PeriodicTask<100000, 100>      readBreakAndAccelTiming;
+#endif
+typedef PeriodicTask<200000, 50>       getAverageSpeedTiming;
+typedef PeriodicTask<500000, 50>       readEngineTiming;
+typedef PeriodicTask<500000, 20000>    cooperativeTiming;       // LCD update over I2C
+typedef PeriodicTask<5000000, 200>     sendToMailTiming;
+typedef PeriodicTask<20000000, 200000> dumpContentsTiming;      // csv file and serial port
+
+// rate monotonic priorities, the build fails if a thread can miss its deadline
+typedef RateMonotonic<TaskSet<carSimulationTiming, readBreakAndAccelTiming, getAverageSpeedTiming,
+                              readEngineTiming, cooperativeTiming, sendToMailTiming,
+                              dumpContentsTiming> > carPriorities;
+
+// checks every 50 ms that the threads keep to their timing
+TaskWatchdog watchdog(50);
+
+// a process, its repetition rate in ms and its worst case response time in us,
+// run by a thread of its own
+typedef struct {
+    const char *name;
+    void (*step)(void const *args);
+    uint32_t period;
+    uint32_t budget;
+    WatchedTask *watch;
+} periodic_t;
+
+WatchedTask carSimulationWatch;
+WatchedTask readBreakAndAccelWatch;
+WatchedTask readEngineWatch;
+WatchedTask getAverageSpeedWatch;
+WatchedTask sendToMailWatch;
+WatchedTask dumpContentsWatch;
+WatchedTask oneHertzWatch;
+WatchedTask twoHertzWatch;
+#ifdef ACTIVATION_CHAIN
+WatchedTask showAverageSpeedWatch;
+#endif
+
+const periodic_t carSimulationTask     = { "carSimulation", carSimulation,
+                                           carSimulationTiming::period_us / 1000,
+                                           carPriorities::ResponseTime<0>::value, &carSimulationWatch };
+const periodic_t readBreakAndAccelTask = { "readBreakAndAccel", readBreakAndAccel,
+                                           readBreakAndAccelTiming::period_us / 1000,
+                                           carPriorities::ResponseTime<1>::value, &readBreakAndAccelWatch };
+const periodic_t readEngineTask        = { "readEngine", readEngine,
+                                           readEngineTiming::period_us / 1000,
+                                           carPriorities::ResponseTime<3>::value, &readEngineWatch };
+const periodic_t getAverageSpeedTask   = { "getAverageSpeed", getAverageSpeed,
+                                           getAverageSpeedTiming::period_us / 1000,
+                                           carPriorities::ResponseTime<2>::value, &getAverageSpeedWatch };
+const periodic_t sendToMailTask        = { "sendToMail", sendToMail,
+                                           sendToMailTiming::period_us / 1000,
+                                           carPriorities::ResponseTime<5>::value, &sendToMailWatch };
+const periodic_t dumpContentsTask      = { "dumpContents", dumpContents,
+                                           dumpContentsTiming::period_us / 1000,
+                                           carPriorities::ResponseTime<6>::value, &dumpContentsWatch };
+
+void periodicThread(void const *args)
+{
+    const periodic_t *task = (const periodic_t *)args;
+    // every release has to complete within the response time found by the analysis
+    watchdog.add(*task->watch, task->name, task->period * 1000, task->budget);
+    // released at a fixed rate, late releases are counted as deadline misses
+    osThreadSetPeriod(Thread::gettid(), task->period, 0);
     while(true)
     {
-        flashHazard();
-        updateOdometer();
-        Thread::wait(500);
-    }    
+        watchdog.begin(*task->watch);
+        task->step(NULL);
+        watchdog.end(*task->watch);
+        Thread::wait_period();
+    }
 }
 
+// report the threads which overran their budget or stopped running
+void reportWatchdog()
+{
+    static uint32_t reported = 0;
+    if(watchdog.violations() == reported)
+    {
+        return;
+    }
+    reported = watchdog.violations();
+    
+    for(const WatchedTask *task = watchdog.tasks(); task != NULL; task = task->next)
+    {
+        if(task->overruns || task->missed)
+        {
+            serial.printf("%s: %lu overruns, %lu missed, max %lu us of %lu us, last at %lu ms\r\n",
+                          task->name, task->overruns, task->missed, task->max_exec_us,
+                          task->budget_us, task->last_violation_us / 1000);
+        }
+    }
+}
+#endif
+
+
+#ifdef RTOS_LOCK_STATS
+// print the contention statistics of a semaphore to the serial port
+// (a semaphore has no holder, so there is no hold time)
+void printLockStats(const char *name, const LockStats &stats)
+{
+    serial.printf("%s: taken %lu, contended %lu, timeouts %lu, wait %lu us (max %lu us), "
+                  "held max %lu us by thread %p\r\n",
+                  name, stats.acquisitions, stats.contended, stats.timeouts,
+                  stats.total_wait_us, stats.max_wait_us, stats.max_hold_us, stats.max_holder);
+}
+
+// report which semaphores stall the processes
+// CAR_MAIL_SEM is held by dumpContents across the file and serial output
+void reportLockStats()
+{
+    printLockStats("CAR_MAIL_SEM", CAR_MAIL_SEM.stats());
+}
+#endif
+
+
+#ifdef DATA_AGE_STATS
+// print the age histogram of the pedal samples used by an output
+void printAgeStats(const AgeMonitor &monitor)
+{
+    serial.printf("%s age: %lu samples, mean %lu us, max %lu us, stale %lu\r\n",
+                  monitor.name(), monitor.samples(), monitor.mean_age_us(),
+                  monitor.max_age_us(), monitor.stale());
+    for(uint32_t i = 0; i < AgeMonitor::buckets; i++)
+    {
+        if(monitor.count(i) == 0)
+        {
+            continue;
+        }
+        if(monitor.bucket_limit_us(i) != 0)
+        {
+            serial.printf("  < %lu ms: %lu\r\n", monitor.bucket_limit_us(i) / 1000, monitor.count(i));
+        }else
+        {
+            serial.printf("  older: %lu\r\n", monitor.count(i));
+        }
+    }
+}
+
+// report the pedal-to-servo, pedal-to-LCD and pedal-to-mail latencies
+void reportAgeStats()
+{
+    printAgeStats(servoAge);
+    printAgeStats(lcdAge);
+    printAgeStats(mailAge);
+}
+#endif
+
+
+#ifdef KERNEL_STATS
+// report the load of the kernel and how full the mail box got
+void reportKernelStats()
+{
+    osKernelStats stats;
+    osKernelGetStats(&stats);
+    serial.printf("kernel: switches %lu, svc calls %lu, isr requests %lu (max queued %u of %u), "
+                  "idle %lu of %lu ticks\r\n",
+                  stats.switches, stats.svc_calls, stats.isr_requests, stats.isr_queue_max,
+                  stats.isr_queue_size, stats.idle_ticks, stats.ticks);
+
+    uint32_t max_used;
+    uint32_t used = mail_box.usage(&max_used);
+    serial.printf("mail box: %lu used (max %lu of 100)\r\n", used, max_used);
+}
+#endif
 
 
 int main() {
@@ -421,19 +655,103 @@ int main() {
     fprintf(fp, "Average_Speed,Accelerometer_Value,Brake_Value\r\n");
     fclose(fp); 
     
+    // the servo and the LCD raise an alarm when they show an old speed
+    servoAge.set_alarm(staleAge_us, staleAlarm);
+    lcdAge.set_alarm(staleAge_us, staleAlarm);
+    
+#ifdef TIME_TRIGGERED
+    // every process is released by the time-triggered executive
+    static StaticTTExecutive<sizeof(schedule) / sizeof(schedule[0])> executive(schedule);
+    static StaticThread<> Executive_Thread(TTExecutive::thread, &executive);
+
+    // report jitter and overruns once per hyperperiod
+    while(true)
+    {
+        Thread::wait(executive.hyperperiod());
+        for(uint32_t i = 0; i < sizeof(schedule) / sizeof(schedule[0]); i++)
+        {
+            const TTStats *stats = executive.stats(i);
+            serial.printf("task %lu: runs %lu, overruns %lu, max jitter %lu us\r\n",
+                          i, stats->runs, stats->overruns, stats->max_jitter_us);
+        }
+        serial.printf("late frames: %lu\r\n", executive.frame_overruns());
+    }
+#else
     //Define the multy thread function
-    Thread Car_Simulation_Thread(carSimulation);                            
-    Thread Read_Brake_And_Accel_Thread(readBreakAndAccel);
-    Thread Read_Engine_Thread(readEngine);
-    Thread Get_Average_Speed_Thread(getAverageSpeed);
-    Thread Is_Over_70_Thread(speedOver70);
-    Thread Send_To_Mail_Thread(sendToMail);
-    Thread Dump_Contents_Thread(dumpContents);
-    Thread Get_Indicators_Thread(getIndicators);
-    Thread One_Hertz_Thread(oneHertz);
-    Thread Two_Hertz_Thread(twoHertz);
+    //the stacks are static so the linker checks they all fit in RAM
+#ifdef ACTIVATION_CHAIN
+    // a timer starts the pedal sampling, which runs the simulation step, every 4th step is averaged
+    // and every 5th average moves the servo, at the priority of the average as it takes no time
+    static ChainStage sampleStage(readBreakAndAccel);
+    static ChainStage simulationStage(carSimulation, NULL, 4);
+    static ChainStage averageStage(getAverageSpeed, NULL, 5);
+    static ChainStage servoStage(showAverageSpeedStage);
+    sampleStage.then(simulationStage).then(averageStage).then(servoStage);
+    sampleStage.watch(watchdog, readBreakAndAccelWatch, "readBreakAndAccel",
+                      readBreakAndAccelTiming::period_us, carPriorities::ResponseTime<1>::value);
+    simulationStage.watch(watchdog, carSimulationWatch, "carSimulation",
+                          carSimulationTiming::period_us, carPriorities::ResponseTime<0>::value);
+    averageStage.watch(watchdog, getAverageSpeedWatch, "getAverageSpeed",
+                       getAverageSpeedTiming::period_us, carPriorities::ResponseTime<2>::value);
+    servoStage.watch(watchdog, showAverageSpeedWatch, "showAverageSpeed",
+                     5 * getAverageSpeedTiming::period_us, carPriorities::ResponseTime<2>::value);
+    static StaticThread<> Car_Simulation_Thread(ChainStage::thread, &simulationStage,
+                                                carPriorities::Priority<0>::value);
+    static StaticThread<> Read_Brake_And_Accel_Thread(ChainStage::thread, &sampleStage,
+                                                      carPriorities::Priority<1>::value);
+    static StaticThread<> Get_Average_Speed_Thread(ChainStage::thread, &averageStage,
+                                                   carPriorities::Priority<2>::value);
+    static StaticThread<> Show_Speed_Thread(ChainStage::thread, &servoStage,
+                                            carPriorities::Priority<2>::value);
+    static RtosTimer Chain_Timer(ChainStage::trigger, osTimerPeriodic, &sampleStage);
+    Chain_Timer.start(carSimulationTiming::period_us / 1000);
+#else
+    static StaticThread<> Car_Simulation_Thread(periodicThread, (void *)&carSimulationTask,
+                                                carPriorities::Priority<0>::value);
+    static StaticThread<> Read_Brake_And_Accel_Thread(periodicThread, (void *)&readBreakAndAccelTask,
+                                                      carPriorities::Priority<1>::value);
+    static StaticThread<> Get_Average_Speed_Thread(periodicThread, (void *)&getAverageSpeedTask,
+                                                   carPriorities::Priority<2>::value);
+#endif
+    static StaticThread<> Read_Engine_Thread(periodicThread, (void *)&readEngineTask,
+                                             carPriorities::Priority<3>::value);
+    static StaticThread<> Send_To_Mail_Thread(periodicThread, (void *)&sendToMailTask,
+                                              carPriorities::Priority<5>::value);
+    static StaticThread<> Dump_Contents_Thread(periodicThread, (void *)&dumpContentsTask,
+                                               carPriorities::Priority<6>::value);
+
+    // the indicator switches are read before they are used
+    cooperative.add_periodic(getIndicators, 2000, 1);
+    cooperative.add_periodic(speedOver70, 2000);
+    int oneHertzTask = cooperative.add_periodic(oneHertz, 1000);
+    int twoHertzTask = cooperative.add_periodic(twoHertz, 500);
+    // the LCD update of twoHertz is the longest step of the cooperative thread
+    cooperative.watch(oneHertzTask, watchdog, oneHertzWatch, "oneHertz",
+                      carPriorities::ResponseTime<4>::value);
+    cooperative.watch(twoHertzTask, watchdog, twoHertzWatch, "twoHertz",
+                      carPriorities::ResponseTime<4>::value);
+    static StaticThread<> Cooperative_Thread(CoopScheduler::thread, &cooperative,
+                                             carPriorities::Priority<4>::value);
+    
+#ifdef HARDWARE_WATCHDOG
+    // reset when a thread has not run for two periods
+    watchdog.enable_hardware(1000);
+#endif
     
+    // main sleeps between reports so it does not share the lowest priority level with the threads
     while(true)
     {
+        Thread::wait(dumpContentsTiming::period_us / 1000);
+        reportWatchdog();
+#ifdef RTOS_LOCK_STATS
+        reportLockStats();
+#endif
+#ifdef KERNEL_STATS
+        reportKernelStats();
+#endif
+#ifdef DATA_AGE_STATS
+        reportAgeStats();
+#endif
     }
+#endif
 }
\ No newline at end of file
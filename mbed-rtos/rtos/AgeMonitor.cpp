@@ -0,0 +1,80 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "AgeMonitor.h"
+
+#include <string.h>
+
+namespace rtos {
+
+AgeMonitor::AgeMonitor(const char *name, uint32_t stale_us, uint32_t bucket_us) :
+    _name(name), _stale_us(stale_us), _bucket_us(bucket_us ? bucket_us : 1), _handler(NULL) {
+    reset();
+}
+
+uint32_t AgeMonitor::record(uint32_t capture_us, uint32_t seq) {
+    uint32_t age_us = us_ticker_read() - capture_us;
+
+    uint32_t bucket = 0;
+    uint32_t limit_us = _bucket_us;
+    while ((bucket < buckets - 1) && (age_us >= limit_us)) {
+        bucket++;
+        limit_us <<= 1;
+    }
+    _histogram[bucket]++;
+
+    _samples++;
+    _total_age_us += age_us;
+    if (age_us > _max_age_us) {
+        _max_age_us = age_us;
+    }
+    _last_seq = seq;
+
+    if ((_stale_us != 0) && (age_us > _stale_us)) {
+        _stale++;
+        if (_handler != NULL) {
+            _handler(*this, age_us, seq);
+        }
+    }
+    return age_us;
+}
+
+void AgeMonitor::set_alarm(uint32_t stale_us, age_alarm_handler_t handler) {
+    _stale_us = stale_us;
+    _handler = handler;
+}
+
+void AgeMonitor::reset() {
+    memset(_histogram, 0, sizeof(_histogram));
+    _samples = 0;
+    _stale = 0;
+    _max_age_us = 0;
+    _total_age_us = 0;
+    _last_seq = 0;
+}
+
+uint32_t AgeMonitor::bucket_limit_us(uint32_t bucket) const {
+    if (bucket >= buckets - 1)
+        return 0;
+    return _bucket_us << bucket;
+}
+
+}
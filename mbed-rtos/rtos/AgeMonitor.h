@@ -0,0 +1,186 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef AGE_MONITOR_H
+#define AGE_MONITOR_H
+
+#include <stdint.h>
+#include "us_ticker_api.h"
+
+namespace rtos {
+
+/** A value with the capture time and sequence number of the sample it was derived from.
+ A stage deriving a value from stamped inputs passes on the stamp of the oldest input it used,
+ so the stamp always tells how old the data behind a value is.
+  @tparam  T  data type of the value.
+*/
+template<typename T>
+struct Stamped {
+    T value;
+    uint32_t capture_us;        /* us_ticker time the source sample was captured */
+    uint32_t seq;               /* sequence number of the source sample */
+
+    /** Stamp the value as a sample captured now
+      @param   sample_seq  sequence number of the sample.
+    */
+    void capture(uint32_t sample_seq) {
+        capture_us = us_ticker_read();
+        seq = sample_seq;
+    }
+
+    /** Take over the stamp of an input
+      @param   input  stamped input the value is derived from.
+    */
+    template<typename U>
+    void derive(const Stamped<U> &input) {
+        capture_us = input.capture_us;
+        seq = input.seq;
+    }
+
+    /** Take over the stamp of an input if it is older than the current stamp
+      @param   input  stamped input the value is derived from.
+    */
+    template<typename U>
+    void derive_oldest(const Stamped<U> &input) {
+        if ((int32_t)(capture_us - input.capture_us) > 0) {
+            derive(input);
+        }
+    }
+};
+
+class AgeMonitor;
+
+/** Function called when a consumer sees a sample older than its staleness limit */
+typedef void (*age_alarm_handler_t)(AgeMonitor &monitor, uint32_t age_us, uint32_t seq);
+
+/** Histogram of the age of the samples seen by one consumer.
+ Bucket 0 counts ages below the bucket width, bucket i ages below width * 2^i and the last bucket
+ everything older. A monitor belongs to one consumer and must not be updated concurrently.
+*/
+class AgeMonitor {
+public:
+    /** Number of histogram buckets */
+    static const uint32_t buckets = 12;
+
+    /** Create an age monitor
+      @param   name       name of the consumer, for reports.
+      @param   stale_us   age above which the alarm handler is called, 0 for no alarm. (default: 0).
+      @param   bucket_us  width of the first histogram bucket. (default: 1000).
+    */
+    AgeMonitor(const char *name, uint32_t stale_us=0, uint32_t bucket_us=1000);
+
+    /** Record a sample used now by the consumer
+      @param   capture_us  us_ticker time the sample was captured.
+      @param   seq         sequence number of the sample.
+      @return  age of the sample in microseconds.
+    */
+    uint32_t record(uint32_t capture_us, uint32_t seq);
+
+    /** Record a stamped value used now by the consumer
+      @param   stamped  value carrying the stamp of its source sample.
+      @return  age of the sample in microseconds.
+    */
+    template<typename T>
+    uint32_t record(const Stamped<T> &stamped) {
+        return record(stamped.capture_us, stamped.seq);
+    }
+
+    /** Set the staleness limit and the function called when it is exceeded.
+      @param   stale_us  age above which the handler is called, 0 for no alarm.
+      @param   handler   function to call, or NULL to only count stale samples.
+    */
+    void set_alarm(uint32_t stale_us, age_alarm_handler_t handler);
+
+    /** Clear the histogram and the counters */
+    void reset();
+
+    /** Get the name of the consumer
+      @return  name given to the constructor.
+    */
+    const char *name() const {
+        return _name;
+    }
+
+    /** Get the upper age limit of a histogram bucket
+      @param   bucket  bucket index.
+      @return  ages in the bucket are below this many microseconds, 0 for the open last bucket.
+    */
+    uint32_t bucket_limit_us(uint32_t bucket) const;
+
+    /** Get the number of samples in a histogram bucket
+      @param   bucket  bucket index.
+      @return  number of samples, 0 for an invalid index.
+    */
+    uint32_t count(uint32_t bucket) const {
+        return (bucket < buckets) ? _histogram[bucket] : 0;
+    }
+
+    /** Get the number of recorded samples
+      @return  number of samples since the last reset.
+    */
+    uint32_t samples() const {
+        return _samples;
+    }
+
+    /** Get the number of samples older than the staleness limit
+      @return  number of stale samples since the last reset.
+    */
+    uint32_t stale() const {
+        return _stale;
+    }
+
+    /** Get the oldest recorded age
+      @return  maximum age in microseconds since the last reset.
+    */
+    uint32_t max_age_us() const {
+        return _max_age_us;
+    }
+
+    /** Get the mean recorded age
+      @return  mean age in microseconds since the last reset.
+    */
+    uint32_t mean_age_us() const {
+        return (_samples != 0) ? (uint32_t)(_total_age_us / _samples) : 0;
+    }
+
+    /** Get the sequence number of the last recorded sample
+      @return  sequence number.
+    */
+    uint32_t last_seq() const {
+        return _last_seq;
+    }
+
+private:
+    const char *_name;
+    uint32_t _stale_us;
+    uint32_t _bucket_us;
+    age_alarm_handler_t _handler;
+    uint32_t _histogram[buckets];
+    uint32_t _samples;
+    uint32_t _stale;
+    uint32_t _max_age_us;
+    uint64_t _total_age_us;
+    uint32_t _last_seq;
+};
+
+}
+
+#endif
@@ -0,0 +1,196 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef BIT_FLAG_H
+#define BIT_FLAG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cmsis.h"
+#include "rtos_atomic.h"
+#include "mbed_error.h"
+
+namespace rtos {
+
+/** A set of up to 32 boolean flags, each read and written without a lock.
+ On Cortex-M3 and above a FlagSet placed in the SRAM bit-band region (0x20000000 - 0x200FFFFF, on the
+ LPC1768 the AHB SRAM: section "AHBSRAM0" or "AHBSRAM1") accesses every flag through its bit-band
+ alias, so reading or writing one flag is a single load or store. Elsewhere a flag is written with
+ an exclusive access (or PRIMASK) read-modify-write of the whole word.
+
+ Several flags written together with write() and all flags read with read() are consistent.
+ A flag number of 32 or more is an error.
+*/
+class FlagSet {
+public:
+    /** Create a set of flags
+      @param   flags  initial value of the flags, bit n is flag n. (default: 0).
+    */
+    FlagSet(uint32_t flags=0) : _flags(flags), _alias(NULL) {
+#if (__CORTEX_M >= 0x03)
+        uintptr_t offset = (uintptr_t)&_flags - bit_band_base;
+        if (offset < bit_band_size) {
+            _alias = (volatile uint32_t*)(bit_band_alias + (offset << 5));
+        }
+#endif
+    }
+
+    /** Read one flag
+      @param   bit  number of the flag, 0 to 31.
+      @return  state of the flag.
+
+      @note You may call this function from ISR context.
+    */
+    bool get(uint32_t bit) const {
+        check(bit);
+        if (_alias != NULL)
+            return _alias[bit] != 0;
+        return (_flags >> bit) & 1;
+    }
+
+    /** Write one flag
+      @param   bit    number of the flag, 0 to 31.
+      @param   value  new state of the flag. (default: true).
+
+      @note You may call this function from ISR context.
+    */
+    void set(uint32_t bit, bool value=true) {
+        check(bit);
+        if (_alias != NULL) {
+            _alias[bit] = value;
+        } else {
+            write(1UL << bit, value ? (1UL << bit) : 0);
+        }
+    }
+
+    /** Clear one flag
+      @param   bit  number of the flag, 0 to 31.
+
+      @note You may call this function from ISR context.
+    */
+    void clear(uint32_t bit) {
+        set(bit, false);
+    }
+
+    /** Read all flags at once
+      @return  the flags, bit n is flag n.
+
+      @note You may call this function from ISR context.
+    */
+    uint32_t read() const {
+        return _flags;
+    }
+
+    /** Write several flags at once, the other flags keep their state
+      @param   mask   flags to write.
+      @param   flags  new state of the flags in mask.
+
+      @note You may call this function from ISR context.
+    */
+    void write(uint32_t mask, uint32_t flags) {
+        uint32_t old;
+        do {
+            old = _flags;
+        } while (!atomic_cas(&_flags, old, (old & ~mask) | (flags & mask)));
+    }
+
+    /** Check if single flags use the bit-band alias
+      @return  true if the set lies in the bit-band region.
+    */
+    bool bit_band() const {
+        return _alias != NULL;
+    }
+
+private:
+    /* not copyable, the alias of a copy would still point to the original flags */
+    FlagSet(const FlagSet &);
+    FlagSet &operator=(const FlagSet &);
+
+    static void check(uint32_t bit) {
+        // a larger bit would reach the flags of the next word through the alias
+        if (bit >= 32)
+            error("FlagSet has 32 flags\n");
+    }
+
+    static const uint32_t bit_band_base  = 0x20000000;
+    static const uint32_t bit_band_size  = 0x00100000;
+    static const uint32_t bit_band_alias = 0x22000000;
+
+    volatile uint32_t _flags;
+    volatile uint32_t *_alias;
+};
+
+/** A single flag of a FlagSet, used like a bool.
+ Example:
+ @code
+ FlagSet vehicle __attribute__((section("AHBSRAM0")));
+ BitFlag engineOn(vehicle, 0);
+
+ engineOn = engineSwitch.read();
+ if (engineOn) { ... }
+ @endcode
+*/
+class BitFlag {
+public:
+    /** Create a flag
+      @param   set  set holding the flag.
+      @param   bit  number of the flag in the set, 0 to 31.
+    */
+    BitFlag(FlagSet &set, uint32_t bit) : _set(set), _bit(bit) {
+    }
+
+    /** Mask of this flag for FlagSet::read and FlagSet::write
+      @return  the flag bit.
+    */
+    uint32_t mask() const {
+        return 1UL << _bit;
+    }
+
+    /** Write the flag
+      @param   value  new state of the flag.
+
+      @note You may call this function from ISR context.
+    */
+    BitFlag &operator=(bool value) {
+        _set.set(_bit, value);
+        return *this;
+    }
+
+    /** Copy the state of another flag */
+    BitFlag &operator=(const BitFlag &flag) {
+        return *this = (bool)flag;
+    }
+
+    /** Read the flag
+      @note You may call this function from ISR context.
+    */
+    operator bool() const {
+        return _set.get(_bit);
+    }
+
+private:
+    FlagSet &_set;
+    uint32_t _bit;
+};
+
+}
+
+#endif
@@ -0,0 +1,112 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "ChainStage.h"
+
+#include "TaskWatchdog.h"
+#include "rtos_atomic.h"
+#include "us_ticker_api.h"
+
+namespace rtos {
+
+ChainStage::ChainStage(void (*step)(void const *argument), void *argument, uint32_t decimation) :
+    _step(step), _argument(argument), _decimation((decimation != 0) ? decimation : 1),
+    _completions(0), _next(NULL), _watchdog(NULL), _watch(NULL), _activations(0), _activated_us(0),
+    _handled(0), _runs(0), _overruns(0), _max_latency_us(0), _tid(NULL) {
+}
+
+ChainStage &ChainStage::then(ChainStage &next) {
+    _next = &next;
+    return next;
+}
+
+void ChainStage::watch(TaskWatchdog &watchdog, WatchedTask &task, const char *name,
+                       uint32_t period_us, uint32_t budget_us) {
+    watchdog.add(task, name, period_us, budget_us);
+    _watch = &task;
+    _watchdog = &watchdog;
+}
+
+void ChainStage::activate() {
+    _activated_us = us_ticker_read();
+    atomic_add(&_activations, 1);
+    // before the thread runs the activation stays pending and is handled on its start
+    osThreadId tid = _tid;
+    if (tid != NULL) {
+        osSignalSet(tid, signal_flag);
+    }
+}
+
+void ChainStage::trigger(void const *argument) {
+    ((ChainStage*)argument)->activate();
+}
+
+uint32_t ChainStage::runs() {
+    return _runs;
+}
+
+uint32_t ChainStage::overruns() {
+    return _overruns;
+}
+
+uint32_t ChainStage::max_latency_us() {
+    return _max_latency_us;
+}
+
+void ChainStage::run() {
+    _tid = osThreadGetId();
+
+    while (true) {
+        while (_activations == _handled) {
+            osSignalWait(signal_flag, osWaitForever);
+        }
+
+        uint32_t activations = _activations;
+        uint32_t latency_us = us_ticker_read() - _activated_us;
+        if (activations - _handled > 1) {
+            _overruns += activations - _handled - 1;
+        }
+        _handled = activations;
+        if (latency_us > _max_latency_us) {
+            _max_latency_us = latency_us;
+        }
+
+        if (_watchdog != NULL) {
+            _watchdog->begin(*_watch);
+        }
+        _step(_argument);
+        if (_watchdog != NULL) {
+            _watchdog->end(*_watch);
+        }
+        _runs++;
+
+        if ((_next != NULL) && (++_completions >= _decimation)) {
+            _completions = 0;
+            _next->activate();
+        }
+    }
+}
+
+void ChainStage::thread(void const *argument) {
+    ((ChainStage*)argument)->run();
+}
+
+}
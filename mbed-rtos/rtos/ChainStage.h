@@ -0,0 +1,127 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef CHAIN_STAGE_H
+#define CHAIN_STAGE_H
+
+#include <stdint.h>
+#include "cmsis_os.h"
+#include "rtos_signals.h"
+
+namespace rtos {
+
+class TaskWatchdog;
+struct WatchedTask;
+
+/** A stage of an activation chain: a step function run by its own thread each time it is activated.
+ Stages are linked with then(); when a stage completes a step it activates the next stage, or only
+ every decimation-th time, so a chain such as sample -> compute -> filter runs as a pipeline
+ within one cycle instead of every stage waiting for a timer of its own. The first stage is
+ activated by a timer, an interrupt or another thread.
+
+ Activations arriving while a stage is still busy are merged into one run and counted as overruns.
+
+ A stage runs in the thread function ChainStage::thread, started with the stage as argument; the
+ priority of that thread is the priority of the stage.
+ Signal flag ChainStage::signal_flag of that thread is used by the stage.
+*/
+class ChainStage {
+public:
+    /** Signal flag of the stage thread set by an activation */
+    static const int32_t signal_flag = RTOS_SIGNAL_CHAIN_STAGE;
+
+    /** Create a stage.
+      @param   step        function called once per activation.
+      @param   argument    pointer that is passed to the step function. (default: NULL).
+      @param   decimation  the next stage is activated after every decimation-th step. (default: 1).
+    */
+    ChainStage(void (*step)(void const *argument), void *argument=NULL, uint32_t decimation=1);
+
+    /** Set the stage activated after the steps of this stage.
+      @param   next  stage to activate, it replaces the previous one.
+      @return  next, to link a chain in one expression.
+    */
+    ChainStage &then(ChainStage &next);
+
+    /** Supervise the steps of this stage with a watchdog, called before the stage thread starts.
+      @param   watchdog   watchdog checking the steps.
+      @param   task       storage for the record of the stage, valid while the watchdog runs.
+      @param   name       name of the stage, for reports.
+      @param   period_us  period of the activations of the stage.
+      @param   budget_us  time allowed from the start to the end of a step, including preemption.
+    */
+    void watch(TaskWatchdog &watchdog, WatchedTask &task, const char *name,
+               uint32_t period_us, uint32_t budget_us);
+
+    /** Activate this stage.
+
+      @note You may call this function from ISR context.
+    */
+    void activate();
+
+    /** Timer or interrupt function activating a stage
+      @param   argument  pointer to the ChainStage.
+    */
+    static void trigger(void const *argument);
+
+    /** Get the number of steps run
+      @return  number of steps.
+    */
+    uint32_t runs();
+
+    /** Get the number of activations merged because the stage was busy
+      @return  number of lost activations.
+    */
+    uint32_t overruns();
+
+    /** Get the largest delay from an activation to the start of its step
+      @return  delay in microseconds.
+    */
+    uint32_t max_latency_us();
+
+    /** Run the stage in the current thread, this function does not return. */
+    void run();
+
+    /** Thread function running a stage
+      @param   argument  pointer to the ChainStage.
+    */
+    static void thread(void const *argument);
+
+private:
+    void (*_step)(void const *argument);
+    void *_argument;
+    uint32_t _decimation;
+    uint32_t _completions;
+    ChainStage *_next;
+    TaskWatchdog *_watchdog;
+    WatchedTask *_watch;
+    volatile uint32_t _activations;
+    volatile uint32_t _activated_us;
+    uint32_t _handled;
+    uint32_t _runs;
+    uint32_t _overruns;
+    uint32_t _max_latency_us;
+    volatile osThreadId _tid;
+};
+
+}
+
+#endif
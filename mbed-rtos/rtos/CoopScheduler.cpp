@@ -0,0 +1,174 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "CoopScheduler.h"
+
+#include "TaskWatchdog.h"
+#include "cmsis.h"
+#include "us_ticker_api.h"
+#include "mbed_error.h"
+
+namespace rtos {
+
+CoopScheduler::CoopScheduler(CoopTask *tasks, uint32_t max_tasks) :
+    _tasks(tasks), _max_tasks(max_tasks), _count(0), _watchdog(NULL), _pending(0), _tid(NULL) {
+    if (_max_tasks > 32)
+        error("CoopScheduler supports at most 32 tasks\n");
+}
+
+int CoopScheduler::add(void (*step)(void const *argument), uint32_t period_us,
+                       uint8_t priority, void *argument) {
+    if ((step == NULL) || (_count >= _max_tasks))
+        return -1;
+
+    CoopTask &task = _tasks[_count];
+    task.step      = step;
+    task.argument  = argument;
+    task.period_us = period_us;
+    task.next_us   = 0;
+    task.runs      = 0;
+    task.overruns  = 0;
+    task.watch     = NULL;
+    task.priority  = priority;
+    return _count++;
+}
+
+int CoopScheduler::add_periodic(void (*step)(void const *argument), uint32_t period_ms,
+                                uint8_t priority, void *argument) {
+    if (period_ms == 0)
+        return -1;
+    return add(step, period_ms * 1000, priority, argument);
+}
+
+int CoopScheduler::add_event(void (*step)(void const *argument), uint8_t priority, void *argument) {
+    return add(step, 0, priority, argument);
+}
+
+osStatus CoopScheduler::signal(int task) {
+    if ((task < 0) || ((uint32_t)task >= _count) || (_tasks[task].period_us != 0))
+        return osErrorParameter;
+
+    uint32_t mask = 1UL << task;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (_pending & mask) {
+        _tasks[task].overruns++;
+    }
+    _pending |= mask;
+    __set_PRIMASK(primask);
+
+    if (_tid != NULL)
+        osSignalSet(_tid, signal_flag);
+    return osOK;
+}
+
+osStatus CoopScheduler::watch(int task, TaskWatchdog &watchdog, WatchedTask &record, const char *name,
+                              uint32_t budget_us) {
+    // an event driven task has no period to check
+    if ((task < 0) || ((uint32_t)task >= _count) || (_tasks[task].period_us == 0))
+        return osErrorParameter;
+
+    watchdog.add(record, name, _tasks[task].period_us, budget_us);
+    _watchdog = &watchdog;
+    _tasks[task].watch = &record;
+    return osOK;
+}
+
+uint32_t CoopScheduler::runs(int task) {
+    if ((task < 0) || ((uint32_t)task >= _count))
+        return 0;
+    return _tasks[task].runs;
+}
+
+uint32_t CoopScheduler::overruns(int task) {
+    if ((task < 0) || ((uint32_t)task >= _count))
+        return 0;
+    return _tasks[task].overruns;
+}
+
+void CoopScheduler::run() {
+    uint32_t now = us_ticker_read();
+    for (uint32_t i = 0; i < _count; i++) {
+        _tasks[i].next_us = now;
+    }
+    _tid = osThreadGetId();
+
+    while (true) {
+        int ready = -1;
+        bool periodic = false;
+        int32_t sleep_us = 0;
+
+        now = us_ticker_read();
+        for (uint32_t i = 0; i < _count; i++) {
+            CoopTask &task = _tasks[i];
+            bool released;
+            if (task.period_us != 0) {
+                // signed difference, so the 32 bit microsecond timer may wrap around
+                int32_t due_in = (int32_t)(task.next_us - now);
+                released = (due_in <= 0);
+                if (!released && (!periodic || due_in < sleep_us)) {
+                    sleep_us = due_in;
+                    periodic = true;
+                }
+            } else {
+                released = (_pending & (1UL << i)) != 0;
+            }
+            if (released && ((ready < 0) || (task.priority > _tasks[ready].priority))) {
+                ready = i;
+            }
+        }
+
+        if (ready < 0) {
+            // nothing to do until the next periodic release or a signal
+            uint32_t millisec = periodic ? (sleep_us + 999) / 1000 : osWaitForever;
+            osSignalWait(signal_flag, millisec);
+            continue;
+        }
+
+        CoopTask &task = _tasks[ready];
+        if (task.period_us != 0) {
+            task.next_us += task.period_us;
+            while ((int32_t)(task.next_us - now) <= 0) {
+                task.next_us += task.period_us;
+                task.overruns++;
+            }
+        } else {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            _pending &= ~(1UL << ready);
+            __set_PRIMASK(primask);
+        }
+        if (task.watch != NULL) {
+            _watchdog->begin(*task.watch);
+        }
+        task.step(task.argument);
+        if (task.watch != NULL) {
+            _watchdog->end(*task.watch);
+        }
+        task.runs++;
+    }
+}
+
+void CoopScheduler::thread(void const *argument) {
+    ((CoopScheduler*)argument)->run();
+}
+
+}
@@ -0,0 +1,158 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef COOP_SCHEDULER_H
+#define COOP_SCHEDULER_H
+
+#include <stdint.h>
+#include "cmsis_os.h"
+#include "rtos_signals.h"
+
+namespace rtos {
+
+class TaskWatchdog;
+struct WatchedTask;
+
+/** Entry of the task table of a CoopScheduler */
+struct CoopTask {
+    void (*step)(void const *argument);
+    void *argument;
+    uint32_t period_us;     /* 0 for an event driven task */
+    uint32_t next_us;       /* next release of a periodic task */
+    uint32_t runs;
+    uint32_t overruns;
+    WatchedTask *watch;     /* NULL if the steps are not supervised */
+    uint8_t priority;
+};
+
+/** The CoopScheduler class runs many small tasks cooperatively on a single thread.
+ A task is a step function which does a short piece of work and returns. State that has to survive
+ between two steps is kept in the task argument (a state machine), so a task needs no stack of its
+ own and costs sizeof(CoopTask) bytes instead of a thread control block plus a stack.
+
+ Periodic tasks are released every period, event driven tasks every time they are signaled.
+ Of the released tasks the one with the highest priority runs first; a step is never preempted
+ by another task of the same scheduler.
+ A periodic task counts an overrun for every release it missed, an event driven task for every
+ signal received while it was still pending.
+
+ The scheduler runs in the thread function CoopScheduler::thread, started with the scheduler as argument.
+ Signal flag CoopScheduler::signal_flag of that thread is used by the scheduler.
+*/
+class CoopScheduler {
+public:
+    /** Signal flag of the scheduler thread used to wake up the scheduler */
+    static const int32_t signal_flag = RTOS_SIGNAL_COOP_SCHEDULER;
+
+    /** Create a scheduler using the given task table.
+      @param   tasks      storage for the task table.
+      @param   max_tasks  number of entries of the task table (at most 32).
+    */
+    CoopScheduler(CoopTask *tasks, uint32_t max_tasks);
+
+    /** Add a periodic task, released once the scheduler starts and then every period.
+      @param   step       function called each time the task is released.
+      @param   period_ms  release period of the task in millisec.
+      @param   priority   priority of the task, higher values run first. (default: 0).
+      @param   argument   pointer that is passed to the step function. (default: NULL).
+      @return  task number, or -1 if the task table is full.
+    */
+    int add_periodic(void (*step)(void const *argument), uint32_t period_ms,
+                     uint8_t priority=0, void *argument=NULL);
+
+    /** Add an event driven task, released each time it is signaled.
+      @param   step       function called each time the task is released.
+      @param   priority   priority of the task, higher values run first. (default: 0).
+      @param   argument   pointer that is passed to the step function. (default: NULL).
+      @return  task number, or -1 if the task table is full.
+    */
+    int add_event(void (*step)(void const *argument), uint8_t priority=0, void *argument=NULL);
+
+    /** Release an event driven task.
+      @param   task  task number returned by add_event.
+      @return  status code that indicates the execution status of the function.
+
+      @note You may call this function from ISR context.
+    */
+    osStatus signal(int task);
+
+    /** Supervise the steps of a periodic task with a watchdog, all tasks of a scheduler use the same one.
+      @param   task       task number returned by add_periodic.
+      @param   watchdog   watchdog checking the steps.
+      @param   record     storage for the record of the task, valid while the watchdog runs.
+      @param   name       name of the task, for reports.
+      @param   budget_us  time allowed from the start to the end of a step, including preemption.
+      @return  status code that indicates the execution status of the function.
+    */
+    osStatus watch(int task, TaskWatchdog &watchdog, WatchedTask &record, const char *name,
+                   uint32_t budget_us);
+
+    /** Get the number of times a task ran
+      @param   task  task number.
+      @return  number of completed steps of the task.
+    */
+    uint32_t runs(int task);
+
+    /** Get the number of overruns of a task
+      @param   task  task number.
+      @return  number of missed releases of the task.
+    */
+    uint32_t overruns(int task);
+
+    /** Run the scheduler in the current thread, this function does not return. */
+    void run();
+
+    /** Thread function running a scheduler
+      @param   argument  pointer to the CoopScheduler.
+    */
+    static void thread(void const *argument);
+
+private:
+    int add(void (*step)(void const *argument), uint32_t period_us,
+            uint8_t priority, void *argument);
+
+    CoopTask *_tasks;
+    uint32_t _max_tasks;
+    uint32_t _count;
+    TaskWatchdog *_watchdog;
+    volatile uint32_t _pending;
+    osThreadId volatile _tid;
+};
+
+/** A CoopScheduler which carries its own task table.
+  @tparam  max_tasks  maximum number of tasks, at most 32.
+*/
+template<uint32_t max_tasks>
+class StaticCoopScheduler : public CoopScheduler {
+public:
+    StaticCoopScheduler() : CoopScheduler(_table, max_tasks) {
+    }
+
+private:
+    /* Event driven tasks are kept in a 32 bit mask */
+    typedef char max_tasks_check[(max_tasks > 0 && max_tasks <= 32) ? 1 : -1];
+
+    CoopTask _table[max_tasks];
+};
+
+}
+
+#endif
@@ -0,0 +1,107 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "EventFlags.h"
+
+#include "cmsis.h"
+#include "us_ticker_api.h"
+
+namespace rtos {
+
+EventFlags::EventFlags(uint32_t flags) : _flags(flags), _waiter(NULL) {
+}
+
+uint32_t EventFlags::set(uint32_t flags) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t result = (_flags |= flags);
+    osThreadId waiter = _waiter;
+    __set_PRIMASK(primask);
+
+    if (waiter != NULL)
+        osSignalSet(waiter, signal_flag);
+    return result;
+}
+
+uint32_t EventFlags::clear(uint32_t flags) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t result = _flags;
+    _flags = result & ~flags;
+    __set_PRIMASK(primask);
+    return result;
+}
+
+uint32_t EventFlags::get() {
+    return _flags;
+}
+
+uint32_t EventFlags::wait_any(uint32_t flags, uint32_t millisec, bool clear) {
+    return wait(flags, millisec, clear, false);
+}
+
+uint32_t EventFlags::wait_all(uint32_t flags, uint32_t millisec, bool clear) {
+    return wait(flags, millisec, clear, true);
+}
+
+uint32_t EventFlags::wait(uint32_t flags, uint32_t millisec, bool clear, bool all) {
+    osThreadId tid = osThreadGetId();
+    if ((flags == 0) || (tid == NULL))
+        return 0;
+
+    uint32_t start_us = us_ticker_read();
+    while (true) {
+        // the waiter is registered together with the test, so a set() after the test always signals
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        uint32_t current = _flags;
+        bool satisfied = all ? ((current & flags) == flags) : ((current & flags) != 0);
+        if (satisfied) {
+            if (clear) {
+                _flags = current & ~flags;
+            }
+            _waiter = NULL;
+        } else if ((_waiter != NULL) && (_waiter != tid)) {
+            // another thread is already waiting
+            __set_PRIMASK(primask);
+            return 0;
+        } else {
+            _waiter = tid;
+        }
+        __set_PRIMASK(primask);
+
+        if (satisfied)
+            return current;
+
+        uint32_t timeout = osWaitForever;
+        if (millisec != osWaitForever) {
+            uint32_t elapsed_ms = (us_ticker_read() - start_us) / 1000;
+            if (elapsed_ms >= millisec) {
+                _waiter = NULL;
+                return 0;
+            }
+            timeout = millisec - elapsed_ms;
+        }
+        osSignalWait(signal_flag, timeout);
+    }
+}
+
+}
@@ -0,0 +1,96 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef EVENT_FLAGS_H
+#define EVENT_FLAGS_H
+
+#include <stdint.h>
+#include "cmsis_os.h"
+#include "rtos_signals.h"
+
+namespace rtos {
+
+/** The EventFlags class lets one thread wait for a combination of events set by other threads or ISRs.
+ Unlike the signal flags of a Thread, the flags belong to the object, so the setting side does not
+ need to know the waiting thread, and one wait can combine events of several producers
+ (for example "pedals updated" OR "switch changed" OR "log flush requested").
+
+ Flags are kept until they are consumed by a wait or cleared. Only one thread may wait at a time;
+ signal flag EventFlags::signal_flag of the waiting thread is used to wake it up.
+*/
+class EventFlags {
+public:
+    /** Signal flag of the waiting thread set when flags change */
+    static const int32_t signal_flag = RTOS_SIGNAL_EVENT_FLAGS;
+
+    /** Create event flags.
+      @param   flags  initial value of the flags. (default: 0).
+    */
+    EventFlags(uint32_t flags=0);
+
+    /** Set flags and wake up the waiting thread.
+      @param   flags  flags to set.
+      @return  value of the flags after they were set.
+
+      @note You may call this function from ISR context.
+    */
+    uint32_t set(uint32_t flags);
+
+    /** Clear flags.
+      @param   flags  flags to clear. (default: all flags).
+      @return  value of the flags before they were cleared.
+
+      @note You may call this function from ISR context.
+    */
+    uint32_t clear(uint32_t flags=0xFFFFFFFF);
+
+    /** Get the current value of the flags.
+      @return  value of the flags.
+
+      @note You may call this function from ISR context.
+    */
+    uint32_t get();
+
+    /** Wait until any of the given flags is set.
+      @param   flags     flags to wait for.
+      @param   millisec  timeout value or 0 in case of no time-out. (default: osWaitForever).
+      @param   clear     clear the given flags once the wait is satisfied. (default: true).
+      @return  value of the flags before they were cleared, or 0 in case of a timeout or incorrect parameters.
+    */
+    uint32_t wait_any(uint32_t flags, uint32_t millisec=osWaitForever, bool clear=true);
+
+    /** Wait until all of the given flags are set.
+      @param   flags     flags to wait for.
+      @param   millisec  timeout value or 0 in case of no time-out. (default: osWaitForever).
+      @param   clear     clear the given flags once the wait is satisfied. (default: true).
+      @return  value of the flags before they were cleared, or 0 in case of a timeout or incorrect parameters.
+    */
+    uint32_t wait_all(uint32_t flags, uint32_t millisec=osWaitForever, bool clear=true);
+
+private:
+    uint32_t wait(uint32_t flags, uint32_t millisec, bool clear, bool all);
+
+    volatile uint32_t _flags;
+    osThreadId volatile _waiter;
+};
+
+}
+#endif
@@ -0,0 +1,129 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "EventQueue.h"
+
+#include "rtos_atomic.h"
+#include "mbed_error.h"
+
+namespace rtos {
+
+EventQueue::EventQueue(EventQueueSlot *slots, uint32_t size) :
+    _slots(NULL), _mask(0), _tail(0), _head(0), _dispatched(0), _overflows(0), _tid(NULL) {
+    init(slots, size);
+}
+
+EventQueue::EventQueue() :
+    _slots(NULL), _mask(0), _tail(0), _head(0), _dispatched(0), _overflows(0), _tid(NULL) {
+}
+
+void EventQueue::init(EventQueueSlot *slots, uint32_t size) {
+    if ((size == 0) || ((size & (size - 1)) != 0))
+        error("EventQueue size must be a power of 2\n");
+
+    _slots = slots;
+    _mask = size - 1;
+    for (uint32_t i = 0; i < size; i++) {
+        _slots[i].callback.clear();
+        _slots[i].sequence = i;
+    }
+}
+
+bool EventQueue::post(void (*func)(void *argument), void *argument) {
+    if (func == NULL)
+        return false;
+
+    ArgumentCall call = { func, argument };
+    return post(callback_t(call));
+}
+
+bool EventQueue::post(const callback_t &callback) {
+    if (!callback.attached())
+        return false;
+
+    EventQueueSlot *slot;
+    uint32_t position = _tail;
+    while (true) {
+        slot = &_slots[position & _mask];
+        int32_t difference = (int32_t)(slot->sequence - position);
+        if (difference == 0) {
+            // slot is free, reserve it
+            if (atomic_cas(&_tail, position, position + 1))
+                break;
+        } else if (difference < 0) {
+            // slot still holds an entry from the previous round
+            atomic_add(&_overflows, 1);
+            return false;
+        }
+        position = _tail;
+    }
+
+    slot->callback = callback;
+    __DMB();
+    slot->sequence = position + 1;
+
+    if (_tid != NULL)
+        osSignalSet(_tid, signal_flag);
+    return true;
+}
+
+uint32_t EventQueue::dispatch() {
+    uint32_t count = 0;
+    while (true) {
+        EventQueueSlot *slot = &_slots[_head & _mask];
+        // a slot reserved by a preempted post is not published yet, its post signals again
+        if (slot->sequence != _head + 1)
+            break;
+
+        callback_t callback(slot->callback);
+        slot->callback.clear();
+        __DMB();
+        slot->sequence = _head + _mask + 1;
+        _head++;
+
+        callback.call();
+        count++;
+    }
+    _dispatched += count;
+    return count;
+}
+
+uint32_t EventQueue::dispatched() {
+    return _dispatched;
+}
+
+uint32_t EventQueue::overflows() {
+    return _overflows;
+}
+
+void EventQueue::run() {
+    _tid = osThreadGetId();
+    while (true) {
+        dispatch();
+        osSignalWait(signal_flag, osWaitForever);
+    }
+}
+
+void EventQueue::thread(void const *argument) {
+    ((EventQueue*)argument)->run();
+}
+
+}
@@ -0,0 +1,175 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <stdint.h>
+#include "cmsis_os.h"
+#include "rtos_signals.h"
+#include "Callback.h"
+
+namespace rtos {
+
+/** Entry of the ring of an EventQueue */
+struct EventQueueSlot {
+    mbed::Callback<void()> callback;
+    volatile uint32_t sequence;     /* position the slot can be written or read at */
+};
+
+/** The EventQueue class defers work from interrupt handlers to a thread.
+ An ISR posts a function and its argument, a member function or a small function object,
+ which a worker thread calls later at the priority of that thread, so the ISR stays short and
+ the deferred work may call blocking functions. The call is copied into the slot, a function
+ object has to fit into an EventQueue::callback_t.
+
+ The queue is a fixed ring without locks: a post reserves a slot with an exclusive compare and
+ swap and publishes it with a sequence number, so ISRs of any priority and threads may post at
+ the same time without disabling interrupts and without allocating memory.
+ When the ring is full the post fails and counts an overflow.
+
+ The worker runs in the thread function EventQueue::thread, started with the queue as argument.
+ Signal flag EventQueue::signal_flag of that thread is used by the queue.
+*/
+class EventQueue {
+public:
+    /** Storage of a posted call */
+    typedef mbed::Callback<void()> callback_t;
+
+    /** Signal flag of the worker thread set when work is posted */
+    static const int32_t signal_flag = RTOS_SIGNAL_EVENT_QUEUE;
+
+    /** Create a queue using the given ring.
+      @param   slots  storage for the ring.
+      @param   size   number of slots of the ring, a power of 2.
+    */
+    EventQueue(EventQueueSlot *slots, uint32_t size);
+
+    /** Post a function to be called by the worker thread.
+      @param   func      function to call.
+      @param   argument  pointer that is passed to the function. (default: NULL).
+      @return  true if the function was queued, false if the queue is full.
+
+      @note You may call this function from ISR context.
+    */
+    bool post(void (*func)(void *argument), void *argument=NULL);
+
+    /** Post a call to be made by the worker thread.
+      @param   callback  call to make, copied into the queue.
+      @return  true if the call was queued, false if the queue is full or nothing is attached.
+
+      @note You may call this function from ISR context.
+    */
+    bool post(const callback_t &callback);
+
+    /** Post a member function to be called by the worker thread.
+      @param   object  object to call the member function on.
+      @param   member  member function to call.
+      @return  true if the call was queued, false if the queue is full.
+
+      @note You may call this function from ISR context.
+    */
+    template<typename T>
+    bool post(T *object, void (T::*member)()) {
+        return post(callback_t(object, member));
+    }
+
+    /** Post a copy of a function object to be called by the worker thread.
+      @param   function  function object with operator()(), at most the size of an EventQueue::callback_t.
+      @return  true if the call was queued, false if the queue is full.
+
+      @note You may call this function from ISR context.
+    */
+    template<typename F>
+    bool post(const F &function) {
+        return post(callback_t(function));
+    }
+
+    /** Call the queued functions in the current thread until the queue is empty.
+     Only one thread may dispatch a queue.
+      @return  number of functions called.
+    */
+    uint32_t dispatch();
+
+    /** Get the number of functions called so far
+      @return  number of dispatched functions.
+    */
+    uint32_t dispatched();
+
+    /** Get the number of failed posts
+      @return  number of posts rejected because the queue was full.
+    */
+    uint32_t overflows();
+
+    /** Run the worker in the current thread, this function does not return. */
+    void run();
+
+    /** Thread function running a worker
+      @param   argument  pointer to the EventQueue.
+    */
+    static void thread(void const *argument);
+
+protected:
+    /** Create a queue without a ring, which is set up by init() */
+    EventQueue();
+
+    void init(EventQueueSlot *slots, uint32_t size);
+
+private:
+    /* A function with an argument, stored in a callback_t */
+    struct ArgumentCall {
+        void (*func)(void *argument);
+        void *argument;
+
+        void operator()() {
+            func(argument);
+        }
+    };
+
+    EventQueueSlot *_slots;
+    uint32_t _mask;
+    volatile uint32_t _tail;
+    uint32_t _head;
+    uint32_t _dispatched;
+    volatile uint32_t _overflows;
+    osThreadId volatile _tid;
+};
+
+/** An EventQueue which carries its own ring.
+  @tparam  size  number of queued functions, a power of 2.
+*/
+template<uint32_t size>
+class StaticEventQueue : public EventQueue {
+public:
+    StaticEventQueue() {
+        // the slots are constructed after the EventQueue base class
+        init(_ring, size);
+    }
+
+private:
+    typedef char size_check[(size > 0 && (size & (size - 1)) == 0) ? 1 : -1];
+
+    EventQueueSlot _ring[size];
+};
+
+}
+
+#endif
@@ -0,0 +1,213 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "LockOrder.h"
+
+#ifdef RTOS_LOCK_ORDER
+
+#include <stdio.h>
+#include "cmsis.h"
+
+namespace rtos {
+
+/* thread holding objects, with the indexes of the objects in the order they were taken */
+struct LockOrderThread {
+    osThreadId tid;
+    uint8_t count;
+    uint8_t held[RTOS_LOCK_ORDER_MAX_HELD];
+};
+
+static const void *lock_table[RTOS_LOCK_ORDER_MAX_LOCKS];
+static uint32_t lock_count;
+static uint32_t lock_after[RTOS_LOCK_ORDER_MAX_LOCKS];     /* bit b set: b was taken while holding this lock */
+static osThreadId lock_holder[RTOS_LOCK_ORDER_MAX_LOCKS];
+static LockOrderThread thread_table[RTOS_LOCK_ORDER_MAX_THREADS];
+static uint32_t dropped_count;
+static lock_order_handler_t report_handler;
+
+static void default_handler(LockOrderViolation violation, const void *held, const void *wanted) {
+    if (violation == LockOrderCycle) {
+        printf("lock order: %p taken while holding %p, also taken in the opposite order\r\n", wanted, held);
+    } else {
+        printf("priority inversion: waiting for %p held by lower priority thread %p\r\n", wanted, held);
+    }
+}
+
+static void report(LockOrderViolation violation, const void *held, const void *wanted) {
+    lock_order_handler_t handler = report_handler ? report_handler : default_handler;
+    handler(violation, held, wanted);
+}
+
+/* index of an object, added to the table on first use; must be called with interrupts disabled */
+static int lock_index(const void *lock) {
+    for (uint32_t i = 0; i < lock_count; i++) {
+        if (lock_table[i] == lock)
+            return i;
+    }
+    if (lock_count >= RTOS_LOCK_ORDER_MAX_LOCKS) {
+        dropped_count++;
+        return -1;
+    }
+    lock_table[lock_count] = lock;
+    return lock_count++;
+}
+
+/* entry of a thread, added on first use if create is set; must be called with interrupts disabled */
+static LockOrderThread *thread_entry(osThreadId tid, bool create) {
+    LockOrderThread *free_entry = NULL;
+    for (uint32_t i = 0; i < RTOS_LOCK_ORDER_MAX_THREADS; i++) {
+        if (thread_table[i].tid == tid)
+            return &thread_table[i];
+        if ((free_entry == NULL) && (thread_table[i].count == 0))
+            free_entry = &thread_table[i];
+    }
+    if (!create)
+        return NULL;
+    if (free_entry == NULL) {
+        dropped_count++;
+        return NULL;
+    }
+    free_entry->tid = tid;
+    return free_entry;
+}
+
+/* true if lock to can be reached from lock from in the graph */
+static bool reachable(int from, int to) {
+    uint32_t visited = 1UL << from;
+    uint32_t frontier = lock_after[from];
+    while (frontier & ~visited) {
+        frontier &= ~visited;
+        if (frontier & (1UL << to))
+            return true;
+        visited |= frontier;
+        uint32_t next = 0;
+        for (int i = 0; i < (int)lock_count; i++) {
+            if (frontier & (1UL << i)) {
+                next |= lock_after[i];
+            }
+        }
+        frontier = next;
+    }
+    return false;
+}
+
+void LockOrder::set_handler(lock_order_handler_t handler) {
+    report_handler = handler;
+}
+
+void LockOrder::acquiring(const void *lock) {
+    const void *cycle_from = NULL;
+    // an SVC with the interrupts masked escalates to a HardFault
+    osThreadId tid = osThreadGetId();
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    int index = lock_index(lock);
+    LockOrderThread *thread = thread_entry(tid, false);
+    if ((index >= 0) && (thread != NULL)) {
+        for (uint32_t i = 0; i < thread->count; i++) {
+            int held = thread->held[i];
+            if ((held == index) || (lock_after[held] & (1UL << index)))
+                continue;
+            // a new edge held -> index closes a cycle if held can already be reached from index
+            if ((cycle_from == NULL) && reachable(index, held)) {
+                cycle_from = lock_table[held];
+            }
+            lock_after[held] |= 1UL << index;
+        }
+    }
+    __set_PRIMASK(primask);
+
+    if (cycle_from != NULL) {
+        report(LockOrderCycle, cycle_from, lock);
+    }
+}
+
+void LockOrder::blocking(const void *lock) {
+    osThreadId holder = NULL;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    int index = lock_index(lock);
+    if (index >= 0) {
+        holder = lock_holder[index];
+    }
+    __set_PRIMASK(primask);
+
+    if ((holder != NULL) && (osThreadGetPriority(holder) < osThreadGetPriority(osThreadGetId()))) {
+        report(LockOrderInversion, holder, lock);
+    }
+}
+
+void LockOrder::acquired(const void *lock) {
+    osThreadId tid = osThreadGetId();
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    int index = lock_index(lock);
+    LockOrderThread *thread = thread_entry(tid, true);
+    if ((index >= 0) && (thread != NULL)) {
+        if (thread->count < RTOS_LOCK_ORDER_MAX_HELD) {
+            thread->held[thread->count++] = index;
+        } else {
+            dropped_count++;
+        }
+        lock_holder[index] = tid;
+    }
+    __set_PRIMASK(primask);
+}
+
+void LockOrder::released(const void *lock) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    int index = lock_index(lock);
+    if (index >= 0) {
+        // the holder is looked up, a lock semaphore may still be released by another thread
+        LockOrderThread *thread = (lock_holder[index] != NULL) ? thread_entry(lock_holder[index], false) : NULL;
+        if (thread != NULL) {
+            for (int i = thread->count - 1; i >= 0; i--) {
+                if (thread->held[i] == index) {
+                    for (; i < thread->count - 1; i++) {
+                        thread->held[i] = thread->held[i + 1];
+                    }
+                    thread->count--;
+                    break;
+                }
+            }
+            bool still_held = false;
+            for (uint32_t i = 0; i < thread->count; i++) {
+                still_held |= (thread->held[i] == index);
+            }
+            if (!still_held) {
+                lock_holder[index] = NULL;
+            }
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+uint32_t LockOrder::dropped() {
+    return dropped_count;
+}
+
+}
+
+#endif
@@ -0,0 +1,105 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LOCK_ORDER_H
+#define LOCK_ORDER_H
+
+#include <stdint.h>
+#include "cmsis_os.h"
+
+/* Maximum number of Mutex and lock Semaphore objects tracked */
+#ifndef RTOS_LOCK_ORDER_MAX_LOCKS
+#define RTOS_LOCK_ORDER_MAX_LOCKS   32
+#endif
+
+/* Maximum number of threads holding objects at the same time */
+#ifndef RTOS_LOCK_ORDER_MAX_THREADS
+#define RTOS_LOCK_ORDER_MAX_THREADS 16
+#endif
+
+/* Maximum number of objects held by one thread at the same time */
+#ifndef RTOS_LOCK_ORDER_MAX_HELD
+#define RTOS_LOCK_ORDER_MAX_HELD    8
+#endif
+
+namespace rtos {
+
+/** Kind of problem found by the lock order checker */
+enum LockOrderViolation {
+    LockOrderCycle,         /* two objects are taken in both orders, the threads can deadlock */
+    LockOrderInversion      /* a thread blocks on an object held by a thread of lower priority */
+};
+
+/** Function called for every problem found by the lock order checker
+  @param   violation  kind of problem.
+  @param   held       LockOrderCycle: object held while taking wanted; LockOrderInversion: holder thread id.
+  @param   wanted     object being taken.
+*/
+typedef void (*lock_order_handler_t)(LockOrderViolation violation, const void *held, const void *wanted);
+
+/** Debug checker of the order in which threads take Mutex objects and Semaphore objects created
+ as locks with Semaphore(count, true). It is only active if RTOS_LOCK_ORDER is defined for the
+ whole build. Other semaphores signal between threads, they are not held like a lock and are not
+ tracked.
+
+ Every time a thread takes an object while holding others, an edge from each held object to the
+ new one is added to a graph of all objects. An edge which closes a cycle is reported at once,
+ when the order first becomes possible, not only once the threads deadlock. A thread which has to
+ wait for an object held by a thread of lower priority is reported as a priority inversion.
+
+ Reports are made in the thread that takes the object, by default with printf.
+*/
+class LockOrder {
+public:
+    /** Set the function called for every problem found
+      @param   handler  function to call, or NULL for the default report with printf.
+    */
+    static void set_handler(lock_order_handler_t handler);
+
+    /** Record that the current thread is about to take an object
+      @param   lock  the object.
+    */
+    static void acquiring(const void *lock);
+
+    /** Record that the current thread has to wait for an object
+      @param   lock  the object.
+    */
+    static void blocking(const void *lock);
+
+    /** Record that the current thread has taken an object
+      @param   lock  the object.
+    */
+    static void acquired(const void *lock);
+
+    /** Record that an object is released
+      @param   lock  the object.
+    */
+    static void released(const void *lock);
+
+    /** Get the number of objects or threads which could not be tracked because a table was full
+      @return  number of untracked acquisitions.
+    */
+    static uint32_t dropped();
+};
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "LockStats.h"
+
+#include <string.h>
+#include "cmsis.h"
+#include "us_ticker_api.h"
+
+namespace rtos {
+
+/* The statistics of a Semaphore are updated by all threads holding one of its tokens,
+ and by interrupt handlers taking one, so every update masks the interrupts. */
+
+void lock_stats_reset(LockStats &stats) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memset(&stats, 0, sizeof(stats));
+    __set_PRIMASK(primask);
+}
+
+void lock_stats_acquired(LockStats &stats, bool contended, uint32_t wait_us) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    stats.acquisitions++;
+    if (contended) {
+        stats.contended++;
+        stats.total_wait_us += wait_us;
+        if (wait_us > stats.max_wait_us) {
+            stats.max_wait_us = wait_us;
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+void lock_stats_timeout(LockStats &stats) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    stats.timeouts++;
+    __set_PRIMASK(primask);
+}
+
+void lock_stats_locked(LockStats &stats) {
+    uint32_t now_us = us_ticker_read();
+    // an SVC with the interrupts masked escalates to a HardFault
+    osThreadId tid = osThreadGetId();
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (stats.depth++ == 0) {
+        stats.holder = tid;
+        stats.acquired_us = now_us;
+    }
+    __set_PRIMASK(primask);
+}
+
+void lock_stats_unlocked(LockStats &stats) {
+    uint32_t now_us = us_ticker_read();
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if ((stats.depth != 0) && (--stats.depth == 0)) {
+        uint32_t hold_us = now_us - stats.acquired_us;
+        if (hold_us > stats.max_hold_us) {
+            stats.max_hold_us = hold_us;
+            stats.max_holder = stats.holder;
+        }
+        stats.holder = NULL;
+    }
+    __set_PRIMASK(primask);
+}
+
+}
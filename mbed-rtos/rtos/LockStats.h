@@ -0,0 +1,83 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LOCK_STATS_H
+#define LOCK_STATS_H
+
+#include <stdint.h>
+#include "cmsis_os.h"
+
+namespace rtos {
+
+/** Contention statistics of a Mutex or Semaphore.
+ They are only recorded if RTOS_LOCK_STATS is defined for the whole build, otherwise Mutex and
+ Semaphore carry no statistics and no overhead.
+
+ An acquisition is contended if the object was not available at once and the thread had to wait.
+ Hold times are recorded for a Mutex, covering its outermost lock, and for a Semaphore created as a
+ lock (see Semaphore::Semaphore(int32_t, bool)). A counting or signalling Semaphore has no owner and
+ may be released by another thread, so its max_hold_us and max_holder stay 0.
+*/
+struct LockStats {
+    uint32_t acquisitions;
+    uint32_t contended;         /* acquisitions which had to wait */
+    uint32_t timeouts;          /* waits which ended without the object */
+    uint32_t total_wait_us;     /* time spent waiting by all contended acquisitions */
+    uint32_t max_wait_us;
+    uint32_t max_hold_us;       /* Mutex and lock Semaphore only */
+    osThreadId max_holder;      /* thread which held the object for max_hold_us */
+
+    /* state of the current lock of a Mutex or lock Semaphore */
+    osThreadId holder;
+    uint32_t acquired_us;
+    uint32_t depth;
+};
+
+/** Clear statistics
+  @param   stats  statistics to clear.
+*/
+void lock_stats_reset(LockStats &stats);
+
+/** Record an acquisition, called by the thread which acquired the object
+  @param   stats      statistics of the object.
+  @param   contended  true if the thread had to wait.
+  @param   wait_us    time the thread waited.
+*/
+void lock_stats_acquired(LockStats &stats, bool contended, uint32_t wait_us);
+
+/** Record a wait which ended without the object
+  @param   stats  statistics of the object.
+*/
+void lock_stats_timeout(LockStats &stats);
+
+/** Start the hold time of a Mutex or lock Semaphore, called by the thread which locked it
+  @param   stats  statistics of the object.
+*/
+void lock_stats_locked(LockStats &stats);
+
+/** End the hold time of a Mutex or lock Semaphore, called by its holder before it is unlocked
+  @param   stats  statistics of the object.
+*/
+void lock_stats_unlocked(LockStats &stats);
+
+}
+
+#endif
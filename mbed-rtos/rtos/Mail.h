@@ -93,12 +93,22 @@ public:
         return osMailFree(_mail_id, (void*)mptr);
     }
 
+    /** Get the number of allocated memory blocks.
+      @param   max_used  receives the high-water mark, or NULL. (default: NULL).
+      @return  number of allocated memory blocks.
+
+      @note You may call this function from ISR context.
+    */
+    uint32_t usage(uint32_t *max_used=NULL) {
+        return osMailGetUsage(_mail_id, max_used);
+    }
+
 private:
     osMailQId    _mail_id;
     osMailQDef_t _mail_def;
 #ifdef CMSIS_OS_RTX
     uint32_t     _mail_q[4+(queue_sz)];
-    uint32_t     _mail_m[3+((sizeof(T)+3)/4)*(queue_sz)];
+    uint32_t     _mail_m[4+((sizeof(T)+3)/4)*(queue_sz)];
     void        *_mail_p[2];
 #endif
 };
@@ -0,0 +1,294 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include <stdint.h>
+#include <new>
+
+#include "cmsis_os.h"
+
+namespace rtos {
+
+template<typename T, uint32_t queue_sz> class MailBox;
+
+/** Owner of a mail of a MailBox.
+ The mail is destroyed and returned to its MailBox when the handle goes out of scope, unless it
+ was sent before. A handle cannot be copied, so a mail always has exactly one owner; the
+ ownership moves between handles only explicitly with transfer() or swap().
+  @tparam  T  data type of the mail.
+*/
+template<typename T>
+class MailHandle {
+public:
+    /** Create an empty handle */
+    MailHandle() : _queue(NULL), _mail(NULL) {
+    }
+
+    ~MailHandle() {
+        reset();
+    }
+
+    /** Check if the handle owns a mail
+      @return  true if the handle owns a mail.
+    */
+    bool valid() const {
+        return _mail != NULL;
+    }
+
+    /** Get the mail
+      @return  pointer to the mail or NULL if the handle is empty.
+    */
+    T *get() const {
+        return _mail;
+    }
+
+    T &operator*() const {
+        return *_mail;
+    }
+
+    T *operator->() const {
+        return _mail;
+    }
+
+    /** Destroy the mail and return it to its MailBox, the handle becomes empty. */
+    void reset() {
+        if (_mail != NULL) {
+            _mail->~T();
+            osMailFree(_queue, (void*)_mail);
+            _mail = NULL;
+        }
+    }
+
+    /** Free the own mail and take over the mail of another handle, which becomes empty
+      @param   other  handle giving up its mail.
+    */
+    void transfer(MailHandle &other) {
+        if (this != &other) {
+            assign(other._queue, other._mail);
+            other._mail = NULL;
+        }
+    }
+
+    /** Exchange the mails of two handles
+      @param   other  handle to exchange the mail with.
+    */
+    void swap(MailHandle &other) {
+        osMailQId queue = _queue;
+        T *mail = _mail;
+        _queue = other._queue;
+        _mail = other._mail;
+        other._queue = queue;
+        other._mail = mail;
+    }
+
+private:
+    template<typename U, uint32_t queue_sz> friend class MailBox;
+
+    /* not copyable, a copy would either share or steal the mail */
+    MailHandle(const MailHandle &);
+    MailHandle &operator=(const MailHandle &);
+
+    void assign(osMailQId queue, T *mail) {
+        reset();
+        _queue = queue;
+        _mail = mail;
+    }
+
+    osMailQId _queue;
+    T *_mail;
+};
+
+/** The MailBox class sends typed mails between threads without copying them.
+ A mail is constructed in place in the memory block of the queue and is owned by a MailHandle,
+ which sends it or frees it again; the receiver gets a MailHandle which frees it when done.
+ Handles are passed by reference, as they cannot be copied:
+ @code
+ MailHandle<mail_t> mail;
+ if (mail_box.emplace(mail)) {
+     mail->value = 1;
+     mail_box.send(mail);
+ }
+ @endcode
+ Unlike Mail, the queue memory is not cleared on construction, only the control block is marked unused.
+  @tparam  T         data type of a single message element.
+  @tparam  queue_sz  maximum number of messages in queue.
+*/
+template<typename T, uint32_t queue_sz>
+class MailBox {
+public:
+    typedef MailHandle<T> Handle;
+
+    /** Create and Initialise a MailBox. */
+    MailBox() {
+    #ifdef CMSIS_OS_RTX
+        // the kernel initialises both areas, it only requires an unused control block
+        _mail_q[0] = 0;
+        _mail_p[0] = _mail_q;
+        _mail_p[1] = _mail_m;
+
+        _mail_def.pool = _mail_p;
+        _mail_def.queue_sz = queue_sz;
+        _mail_def.item_sz = sizeof(T);
+    #endif
+        _mail_id = osMailCreate(&_mail_def, NULL);
+    }
+
+    /** Allocate a mail and default construct it
+      @param   mail      handle receiving the mail, a mail it owned before is freed.
+      @param   millisec  timeout value or 0 in case of no time-out. (default: 0).
+      @return  true if a mail was allocated, false in case of no memory available.
+    */
+    bool emplace(Handle &mail, uint32_t millisec=0) {
+        void *block = alloc(mail, millisec);
+        mail.assign(_mail_id, block ? new (block) T() : NULL);
+        return mail.valid();
+    }
+
+    /** Allocate a mail and copy construct it
+      @param   mail      handle receiving the mail, a mail it owned before is freed.
+      @param   value     value of the mail.
+      @param   millisec  timeout value or 0 in case of no time-out. (default: 0).
+      @return  true if a mail was allocated, false in case of no memory available.
+    */
+    bool emplace_copy(Handle &mail, const T &value, uint32_t millisec=0) {
+        void *block = alloc(mail, millisec);
+        mail.assign(_mail_id, block ? new (block) T(value) : NULL);
+        return mail.valid();
+    }
+
+    /** Allocate a mail and construct it from one constructor argument
+      @param   mail      handle receiving the mail, a mail it owned before is freed.
+      @param   millisec  timeout value or 0 in case of no time-out.
+      @param   a1        constructor argument.
+      @return  true if a mail was allocated, false in case of no memory available.
+    */
+    template<typename A1>
+    bool emplace_with(Handle &mail, uint32_t millisec, const A1 &a1) {
+        void *block = alloc(mail, millisec);
+        mail.assign(_mail_id, block ? new (block) T(a1) : NULL);
+        return mail.valid();
+    }
+
+    /** Allocate a mail and construct it from two constructor arguments
+      @param   mail      handle receiving the mail, a mail it owned before is freed.
+      @param   millisec  timeout value or 0 in case of no time-out.
+      @param   a1        first constructor argument.
+      @param   a2        second constructor argument.
+      @return  true if a mail was allocated, false in case of no memory available.
+    */
+    template<typename A1, typename A2>
+    bool emplace_with(Handle &mail, uint32_t millisec, const A1 &a1, const A2 &a2) {
+        void *block = alloc(mail, millisec);
+        mail.assign(_mail_id, block ? new (block) T(a1, a2) : NULL);
+        return mail.valid();
+    }
+
+    /** Allocate a mail and construct it from three constructor arguments
+      @param   mail      handle receiving the mail, a mail it owned before is freed.
+      @param   millisec  timeout value or 0 in case of no time-out.
+      @param   a1        first constructor argument.
+      @param   a2        second constructor argument.
+      @param   a3        third constructor argument.
+      @return  true if a mail was allocated, false in case of no memory available.
+    */
+    template<typename A1, typename A2, typename A3>
+    bool emplace_with(Handle &mail, uint32_t millisec, const A1 &a1, const A2 &a2, const A3 &a3) {
+        void *block = alloc(mail, millisec);
+        mail.assign(_mail_id, block ? new (block) T(a1, a2, a3) : NULL);
+        return mail.valid();
+    }
+
+    /** Put a mail in the queue, the handle becomes empty once the mail is queued.
+      @param   mail  handle of a mail of this MailBox.
+      @return  status code that indicates the execution status of the function; on an error
+               the handle still owns the mail.
+    */
+    osStatus send(Handle &mail) {
+        if ((mail._mail == NULL) || (mail._queue != _mail_id))
+            return osErrorParameter;
+        osStatus status = osMailPut(_mail_id, (void*)mail._mail);
+        if (status == osOK)
+            mail._mail = NULL;
+        return status;
+    }
+
+    /** Get a mail from the queue.
+      @param   mail      handle receiving the mail, a mail it owned before is freed.
+      @param   millisec  timeout value or 0 in case of no time-out. (default: osWaitForever).
+      @return  true if a mail was received, false in case of a timeout.
+    */
+    bool receive(Handle &mail, uint32_t millisec=osWaitForever) {
+        mail.reset();
+        osEvent evt = osMailGet(_mail_id, millisec);
+        mail.assign(_mail_id, (evt.status == osEventMail) ? (T*)evt.value.p : NULL);
+        return mail.valid();
+    }
+
+    /** Get several mails from the queue.
+     Only the first mail is waited for, the others are taken while the queue is not empty.
+      @param   mails     handles receiving the mails, mails they owned before are freed.
+      @param   count     number of handles.
+      @param   millisec  timeout value for the first mail or 0 in case of no time-out. (default: osWaitForever).
+      @return  number of mails received.
+    */
+    uint32_t receive(Handle *mails, uint32_t count, uint32_t millisec=osWaitForever) {
+        uint32_t received = 0;
+        while (received < count) {
+            mails[received].reset();
+            osEvent evt = osMailGet(_mail_id, (received == 0) ? millisec : 0);
+            if (evt.status != osEventMail)
+                break;
+            mails[received++].assign(_mail_id, (T*)evt.value.p);
+        }
+        return received;
+    }
+
+    /** Get the number of allocated mails, sent or not.
+      @param   max_used  receives the high-water mark, or NULL. (default: NULL).
+      @return  number of allocated mails.
+
+      @note You may call this function from ISR context.
+    */
+    uint32_t usage(uint32_t *max_used=NULL) {
+        return osMailGetUsage(_mail_id, max_used);
+    }
+
+private:
+    /* Free the mail of the handle first, so that it can be allocated again */
+    void *alloc(Handle &mail, uint32_t millisec) {
+        mail.reset();
+        return osMailAlloc(_mail_id, millisec);
+    }
+
+    osMailQId    _mail_id;
+    osMailQDef_t _mail_def;
+#ifdef CMSIS_OS_RTX
+    uint32_t     _mail_q[4+(queue_sz)];
+    uint32_t     _mail_m[4+((sizeof(T)+3)/4)*(queue_sz)];
+    void        *_mail_p[2];
+#endif
+};
+
+}
+
+#endif
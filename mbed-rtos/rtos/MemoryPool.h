@@ -70,11 +70,21 @@ public:
         return osPoolFree(_pool_id, (void*)block);
     }
 
+    /** Get the number of allocated memory blocks.
+      @param   max_used  receives the high-water mark, or NULL. (default: NULL).
+      @return  number of allocated memory blocks.
+
+      @note You may call this function from ISR context.
+    */
+    uint32_t usage(uint32_t *max_used=NULL) {
+        return osPoolGetUsage(_pool_id, max_used);
+    }
+
 private:
     osPoolId    _pool_id;
     osPoolDef_t _pool_def;
 #ifdef CMSIS_OS_RTX
-    uint32_t    _pool_m[3+((sizeof(T)+3)/4)*(pool_sz)];
+    uint32_t    _pool_m[4+((sizeof(T)+3)/4)*(pool_sz)];
 #endif
 };
 
@@ -23,10 +23,15 @@
 
 #include <string.h>
 #include "mbed_error.h"
+#include "Thread.h"
+#include "us_ticker_api.h"
 
 namespace rtos {
 
 Mutex::Mutex() {
+#ifdef RTOS_LOCK_STATS
+    lock_stats_reset(_stats);
+#endif
 #ifdef CMSIS_OS_RTX
     memset(_mutex_data, 0, sizeof(_mutex_data));
     _osMutexDef.mutex = _mutex_data;
@@ -38,14 +43,85 @@ Mutex::Mutex() {
 }
 
 osStatus Mutex::lock(uint32_t millisec) {
+#if defined(RTOS_LOCK_STATS) || defined(RTOS_LOCK_ORDER)
+#ifdef RTOS_LOCK_ORDER
+    LockOrder::acquiring(this);
+#endif
+    // an available mutex is taken at once, only a contended lock is timed
+    osStatus status = osMutexWait(_osMutexId, 0);
+    bool contended = (status == osErrorResource) && (millisec != 0);
+#ifdef RTOS_LOCK_STATS
+    uint32_t wait_us = 0;
+#endif
+    if (contended) {
+#ifdef RTOS_LOCK_ORDER
+        LockOrder::blocking(this);
+#endif
+#ifdef RTOS_LOCK_STATS
+        uint32_t start_us = us_ticker_read();
+        status = osMutexWait(_osMutexId, millisec);
+        wait_us = us_ticker_read() - start_us;
+#else
+        status = osMutexWait(_osMutexId, millisec);
+#endif
+    }
+#ifdef RTOS_LOCK_STATS
+    if (status == osOK) {
+        lock_stats_acquired(_stats, contended, wait_us);
+        lock_stats_locked(_stats);
+    } else if (contended) {
+        lock_stats_timeout(_stats);
+    }
+#endif
+#ifdef RTOS_LOCK_ORDER
+    if (status == osOK) {
+        LockOrder::acquired(this);
+    }
+#endif
+    return status;
+#else
     return osMutexWait(_osMutexId, millisec);
+#endif
+}
+
+osStatus Mutex::lock_us(uint32_t microsec) {
+    uint32_t end_us = us_ticker_read() + microsec;
+
+    // a wait of n ticks may end up to one tick early, so leave a tick for the fine wait
+    if (microsec >= 2000) {
+        osStatus status = lock(microsec / 1000 - 1);
+        if (status != osErrorTimeoutResource)
+            return status;
+    }
+
+    while (true) {
+        osStatus status = lock(0);
+        if (status != osErrorResource)
+            return status;
+        int32_t remaining_us = (int32_t)(end_us - us_ticker_read());
+        if (remaining_us <= 0)
+            return (microsec != 0) ? osErrorTimeoutResource : osErrorResource;
+        Thread::wait_us(((uint32_t)remaining_us < Thread::wait_us_slice) ? remaining_us : Thread::wait_us_slice);
+    }
 }
 
 bool Mutex::trylock() {
+#if defined(RTOS_LOCK_STATS) || defined(RTOS_LOCK_ORDER)
+    return (lock(0) == osOK);
+#else
     return (osMutexWait(_osMutexId, 0) == osOK);
+#endif
 }
 
 osStatus Mutex::unlock() {
+#ifdef RTOS_LOCK_STATS
+    if (osThreadGetId() == _stats.holder) {
+        lock_stats_unlocked(_stats);
+    }
+#endif
+#ifdef RTOS_LOCK_ORDER
+    LockOrder::released(this);
+#endif
     return osMutexRelease(_osMutexId);
 }
 
@@ -24,6 +24,12 @@
 
 #include <stdint.h>
 #include "cmsis_os.h"
+#ifdef RTOS_LOCK_STATS
+#include "LockStats.h"
+#endif
+#ifdef RTOS_LOCK_ORDER
+#include "LockOrder.h"
+#endif
 
 namespace rtos {
 
@@ -41,6 +47,15 @@ public:
      */
     osStatus lock(uint32_t millisec=osWaitForever);
 
+    /** Wait until a Mutex becomes available, with a timeout in microsec.
+     Whole ticks are waited in the kernel like lock(), the last tick by trying the mutex between
+     sleeps of Thread::wait_us, so an unlock in the last tick is seen up to Thread::wait_us_slice
+     late. The wait never ends before the timeout. Not from ISR context.
+      @param   microsec  timeout value, up to 2^31 microsec.
+      @return  status code that indicates the execution status of the function.
+     */
+    osStatus lock_us(uint32_t microsec);
+
     /** Try to lock the mutex, and return immediately
       @return  true if the mutex was acquired, false otherwise.
      */
@@ -51,10 +66,27 @@ public:
      */
     osStatus unlock();
 
+#ifdef RTOS_LOCK_STATS
+    /** Get the contention statistics, recorded with RTOS_LOCK_STATS defined
+      @return  statistics since creation or the last reset_stats.
+    */
+    const LockStats &stats() const {
+        return _stats;
+    }
+
+    /** Clear the contention statistics */
+    void reset_stats() {
+        lock_stats_reset(_stats);
+    }
+#endif
+
     ~Mutex();
 
 private:
     osMutexId _osMutexId;
+#ifdef RTOS_LOCK_STATS
+    LockStats _stats;
+#endif
     osMutexDef_t _osMutexDef;
 #ifdef CMSIS_OS_RTX
 #ifdef __MBED_CMSIS_RTOS_CA9
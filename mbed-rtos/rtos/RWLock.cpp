@@ -0,0 +1,110 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "RWLock.h"
+
+#include "cmsis.h"
+#include "us_ticker_api.h"
+
+namespace rtos {
+
+RWLock::RWLock() : _drained(0), _readers(0), _writer_waiting(false) {
+}
+
+osStatus RWLock::read_lock(uint32_t millisec) {
+    // a reader only passes the writer mutex, so it waits behind an active or waiting writer
+    osStatus status = _writer.lock(millisec);
+    if (status != osOK)
+        return status;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    _readers++;
+    __set_PRIMASK(primask);
+
+    return _writer.unlock();
+}
+
+osStatus RWLock::read_unlock() {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (_readers == 0) {
+        __set_PRIMASK(primask);
+        return osErrorResource;
+    }
+    bool wake = (--_readers == 0) && _writer_waiting;
+    if (wake) {
+        _writer_waiting = false;
+    }
+    __set_PRIMASK(primask);
+
+    if (wake) {
+        _drained.release();
+    }
+    return osOK;
+}
+
+osStatus RWLock::write_lock(uint32_t millisec) {
+    uint32_t start_us = us_ticker_read();
+    osStatus status = _writer.lock(millisec);
+    if (status != osOK)
+        return status;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    bool drained = (_readers == 0);
+    _writer_waiting = !drained;
+    __set_PRIMASK(primask);
+    if (drained)
+        return osOK;
+
+    uint32_t timeout = millisec;
+    if (millisec != osWaitForever) {
+        uint32_t elapsed_ms = (us_ticker_read() - start_us) / 1000;
+        timeout = (elapsed_ms < millisec) ? (millisec - elapsed_ms) : 0;
+    }
+    if (_drained.wait(timeout) > 0)
+        return osOK;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    bool waiting = _writer_waiting;
+    _writer_waiting = false;
+    __set_PRIMASK(primask);
+
+    if (!waiting) {
+        // the last reader left just after the timeout and is about to release _drained
+        _drained.wait(osWaitForever);
+        return osOK;
+    }
+    _writer.unlock();
+    return (millisec != 0) ? osErrorTimeoutResource : osErrorResource;
+}
+
+osStatus RWLock::write_unlock() {
+    return _writer.unlock();
+}
+
+uint32_t RWLock::readers() {
+    return _readers;
+}
+
+}
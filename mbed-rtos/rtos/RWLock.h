@@ -0,0 +1,84 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef RWLOCK_H
+#define RWLOCK_H
+
+#include <stdint.h>
+#include "cmsis_os.h"
+#include "Mutex.h"
+#include "Semaphore.h"
+
+namespace rtos {
+
+/** The RWLock class lets many threads read shared data at the same time, while a writer has
+ exclusive access.
+
+ Writers are preferred: once a writer waits, new readers wait behind it, so frequent readers
+ cannot starve a periodic writer. The active or waiting writer owns an internal Mutex which new
+ readers and writers block on, so the kernel raises its priority to that of the highest
+ waiting thread (priority inheritance). Readers which are already reading are not raised, the
+ writer waits until the last of them leaves.
+
+ The lock is not recursive: a thread must not take it again, for reading or writing, while holding it.
+*/
+class RWLock {
+public:
+    /** Create and Initialize a RWLock object */
+    RWLock();
+
+    /** Wait until the lock can be taken for reading
+      @param   millisec  timeout value or 0 in case of no time-out. (default: osWaitForever)
+      @return  status code that indicates the execution status of the function.
+    */
+    osStatus read_lock(uint32_t millisec=osWaitForever);
+
+    /** Release the lock taken with read_lock
+      @return  status code that indicates the execution status of the function.
+    */
+    osStatus read_unlock();
+
+    /** Wait until the lock can be taken for writing
+      @param   millisec  timeout value or 0 in case of no time-out. (default: osWaitForever)
+      @return  status code that indicates the execution status of the function.
+    */
+    osStatus write_lock(uint32_t millisec=osWaitForever);
+
+    /** Release the lock taken with write_lock
+      @return  status code that indicates the execution status of the function.
+    */
+    osStatus write_unlock();
+
+    /** Get the number of threads reading
+      @return  number of threads holding the lock for reading.
+    */
+    uint32_t readers();
+
+private:
+    Mutex _writer;              /* held by the active or waiting writer */
+    Semaphore _drained;         /* released by the last reader to a waiting writer */
+    volatile uint32_t _readers;
+    volatile bool _writer_waiting;
+};
+
+}
+
+#endif
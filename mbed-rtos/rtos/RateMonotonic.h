@@ -0,0 +1,203 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef RATE_MONOTONIC_H
+#define RATE_MONOTONIC_H
+
+#include <stdint.h>
+#include "cmsis_os.h"
+
+namespace rtos {
+
+/** Timing description of a periodic thread, all times in microseconds.
+  @tparam  period    release period.
+  @tparam  wcet      worst case execution time budget of one release.
+  @tparam  deadline  relative deadline, at most the period. (default: period).
+*/
+template<uint32_t period, uint32_t wcet, uint32_t deadline = period>
+struct PeriodicTask {
+    static const uint32_t period_us   = period;
+    static const uint32_t wcet_us     = wcet;
+    static const uint32_t deadline_us = deadline;
+
+private:
+    typedef char timing_check[(wcet > 0 && wcet <= deadline && deadline <= period) ? 1 : -1];
+};
+
+/** Unused entry of a TaskSet */
+struct NoTask {
+    static const uint32_t period_us   = 0;
+    static const uint32_t wcet_us     = 0;
+    static const uint32_t deadline_us = 0;
+};
+
+/** A set of up to 12 PeriodicTask types */
+template<class T0,          class T1  = NoTask, class T2  = NoTask, class T3  = NoTask,
+         class T4 = NoTask, class T5  = NoTask, class T6  = NoTask, class T7  = NoTask,
+         class T8 = NoTask, class T9  = NoTask, class T10 = NoTask, class T11 = NoTask>
+struct TaskSet {
+    static const int max_tasks = 12;
+    typedef T0 task0; typedef T1 task1; typedef T2  task2;  typedef T3  task3;
+    typedef T4 task4; typedef T5 task5; typedef T6  task6;  typedef T7  task7;
+    typedef T8 task8; typedef T9 task9; typedef T10 task10; typedef T11 task11;
+};
+
+namespace rm {
+
+template<class Set, int i> struct TaskAt;
+template<class Set> struct TaskAt<Set, 0>  { typedef typename Set::task0  type; };
+template<class Set> struct TaskAt<Set, 1>  { typedef typename Set::task1  type; };
+template<class Set> struct TaskAt<Set, 2>  { typedef typename Set::task2  type; };
+template<class Set> struct TaskAt<Set, 3>  { typedef typename Set::task3  type; };
+template<class Set> struct TaskAt<Set, 4>  { typedef typename Set::task4  type; };
+template<class Set> struct TaskAt<Set, 5>  { typedef typename Set::task5  type; };
+template<class Set> struct TaskAt<Set, 6>  { typedef typename Set::task6  type; };
+template<class Set> struct TaskAt<Set, 7>  { typedef typename Set::task7  type; };
+template<class Set> struct TaskAt<Set, 8>  { typedef typename Set::task8  type; };
+template<class Set> struct TaskAt<Set, 9>  { typedef typename Set::task9  type; };
+template<class Set> struct TaskAt<Set, 10> { typedef typename Set::task10 type; };
+template<class Set> struct TaskAt<Set, 11> { typedef typename Set::task11 type; };
+
+template<class Set, int i>
+struct Period {
+    static const uint32_t value = TaskAt<Set, i>::type::period_us;
+};
+
+/* true if no task before task j has the same period as task j */
+template<class Set, int j, int k = 0, bool end = (k >= j)>
+struct FirstOfPeriod {
+    static const bool value = (Period<Set, k>::value != Period<Set, j>::value) &&
+                              FirstOfPeriod<Set, j, k + 1>::value;
+};
+template<class Set, int j, int k>
+struct FirstOfPeriod<Set, j, k, true> {
+    static const bool value = true;
+};
+
+/* number of distinct periods shorter than the period of task i */
+template<class Set, int i, int j = 0, bool end = (j >= Set::max_tasks)>
+struct Rank {
+    static const int value = ((Period<Set, j>::value != 0) &&
+                              (Period<Set, j>::value < Period<Set, i>::value) &&
+                              FirstOfPeriod<Set, j>::value ? 1 : 0) + Rank<Set, i, j + 1>::value;
+};
+template<class Set, int i, int j>
+struct Rank<Set, i, j, true> {
+    static const int value = 0;
+};
+
+/* priority of task i: one level per rank, the longest periods share the lowest level */
+template<class Set, int i, osPriority lowest, osPriority highest>
+struct Level {
+    static const int rank = Rank<Set, i>::value;
+    static const int value = (rank < (highest - lowest)) ? (highest - rank) : lowest;
+};
+
+/* processor demand of the tasks at the level of task i or above, within a window of R us */
+template<class Set, int i, osPriority lowest, osPriority highest, uint32_t R,
+         int j = 0, bool end = (j >= Set::max_tasks)>
+struct Interference {
+    typedef typename TaskAt<Set, j>::type task;
+    static const uint32_t period = task::period_us ? task::period_us : 1;
+    static const bool interferes = (j != i) && (task::period_us != 0) &&
+        (Level<Set, j, lowest, highest>::value >= Level<Set, i, lowest, highest>::value);
+    static const uint32_t value = (interferes ? ((R + period - 1) / period) * task::wcet_us : 0) +
+                                  Interference<Set, i, lowest, highest, R, j + 1>::value;
+};
+template<class Set, int i, osPriority lowest, osPriority highest, uint32_t R, int j>
+struct Interference<Set, i, lowest, highest, R, j, true> {
+    static const uint32_t value = 0;
+};
+
+/* fixed point iteration R = C + interference(R), stopped once it converges or misses the deadline */
+template<class Set, int i, osPriority lowest, osPriority highest, uint32_t R,
+         uint32_t next = TaskAt<Set, i>::type::wcet_us + Interference<Set, i, lowest, highest, R>::value,
+         bool done = (next == R) || (next > TaskAt<Set, i>::type::deadline_us)>
+struct ResponseTime {
+    static const uint32_t value = ResponseTime<Set, i, lowest, highest, next>::value;
+};
+template<class Set, int i, osPriority lowest, osPriority highest, uint32_t R, uint32_t next>
+struct ResponseTime<Set, i, lowest, highest, R, next, true> {
+    static const uint32_t value = next;
+};
+
+template<class Set, int i, osPriority lowest, osPriority highest,
+         bool used = (Period<Set, i>::value != 0)>
+struct Schedulable {
+    typedef typename TaskAt<Set, i>::type task;
+    static const uint32_t response_us = ResponseTime<Set, i, lowest, highest, task::wcet_us>::value;
+    static const bool value = (response_us <= task::deadline_us);
+};
+template<class Set, int i, osPriority lowest, osPriority highest>
+struct Schedulable<Set, i, lowest, highest, false> {
+    static const uint32_t response_us = 0;
+    static const bool value = true;
+};
+
+template<class Set, osPriority lowest, osPriority highest, int i = 0, bool end = (i >= Set::max_tasks)>
+struct AllSchedulable {
+    static const bool value = Schedulable<Set, i, lowest, highest>::value &&
+                              AllSchedulable<Set, lowest, highest, i + 1>::value;
+};
+template<class Set, osPriority lowest, osPriority highest, int i>
+struct AllSchedulable<Set, lowest, highest, i, true> {
+    static const bool value = true;
+};
+
+}
+
+/** Rate monotonic priority assignment of a TaskSet, checked at compile time.
+ Tasks with shorter periods get higher priorities; tasks with equal periods share a priority.
+ With more distinct periods than priority levels in [lowest, highest] the longest periods share level lowest.
+
+ The worst case response time of every task is computed with response time analysis, where all
+ tasks at the same priority count as interference (round robin). The program does not compile
+ if a response time exceeds its deadline.
+  @tparam  Set      TaskSet describing the threads.
+  @tparam  lowest   lowest priority to assign. (default: osPriorityNormal).
+  @tparam  highest  highest priority to assign. (default: osPriorityRealtime).
+*/
+template<class Set, osPriority lowest = osPriorityNormal, osPriority highest = osPriorityRealtime>
+class RateMonotonic {
+public:
+    /** Priority of task i of the set */
+    template<int i>
+    struct Priority {
+        static const osPriority value = (osPriority)rm::Level<Set, i, lowest, highest>::value;
+    };
+
+    /** Worst case response time of task i of the set in microseconds */
+    template<int i>
+    struct ResponseTime {
+        static const uint32_t value = rm::Schedulable<Set, i, lowest, highest>::response_us;
+    };
+
+    /** true if every task meets its deadline */
+    static const bool schedulable = rm::AllSchedulable<Set, lowest, highest>::value;
+
+private:
+    typedef char priority_range_check[(lowest <= highest) ? 1 : -1];
+    typedef char schedulability_check[schedulable ? 1 : -1];
+};
+
+}
+
+#endif
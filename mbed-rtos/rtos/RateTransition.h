@@ -0,0 +1,134 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef RATE_TRANSITION_H
+#define RATE_TRANSITION_H
+
+#include <stdint.h>
+#include "cmsis.h"
+
+namespace rtos {
+
+/** Lock-free rate transition of a value from one periodic process to others running at other rates.
+ The writer publishes a complete value at the end of its frame and every reader latches the latest
+ value at the start of its frame, then uses that snapshot for the whole frame. All fields of a
+ snapshot therefore come from one instant, whatever the rates:
+  - fast to slow (hold): the slow reader keeps one value for its frame while the writer moves on.
+  - slow to fast (sample): the fast reader sees the last complete value until the next one is published.
+
+ Each reader owns a buffer which the writer never touches, so neither side ever waits or copies a
+ value more than once; readers + 2 buffers are used.
+  @tparam  T        data type of the value, copied on publish.
+  @tparam  readers  number of reader processes, each with its own index. (default: 1).
+*/
+template<typename T, uint32_t readers = 1>
+class RateTransition {
+public:
+    /** Create a rate transition, holding a default constructed value */
+    RateTransition() : _state(0) {
+        _buffer[0] = T();
+        for (uint32_t i = 0; i < readers; i++) {
+            _held[i] = 0;
+            _seen[i] = 0;
+        }
+    }
+
+    /** Publish a new value, only one process may write.
+      @param   value  value copied to the readers.
+
+      @note You may call this function from ISR context.
+    */
+    void publish(const T &value) {
+        uint32_t next = free_buffer();
+        _buffer[next] = value;
+        __DMB();
+        _state = ((_state & ~index_mask) + (1 << index_bits)) | next;
+        __DMB();
+    }
+
+    /** Latch the latest published value for a reader.
+      @param   reader  index of the calling reader, less than readers. (default: 0).
+      @return  true if the value changed since the last update of this reader.
+    */
+    bool update(uint32_t reader = 0) {
+        uint32_t state;
+        do {
+            state = _state;
+            // the writer skips held buffers, but may have reused this one before it was held
+            _held[reader] = state & index_mask;
+            __DMB();
+        } while (state != _state);
+
+        bool changed = (state != _seen[reader]);
+        _seen[reader] = state;
+        return changed;
+    }
+
+    /** Get the value latched by a reader.
+      @param   reader  index of the calling reader, less than readers. (default: 0).
+      @return  snapshot taken by the last update of this reader, valid until its next update.
+    */
+    const T &value(uint32_t reader = 0) const {
+        return _buffer[_held[reader]];
+    }
+
+    /** Get the number of published values
+      @return  number of publishes so far, wrapping at 2^24.
+
+      @note You may call this function from ISR context.
+    */
+    uint32_t published() const {
+        return _state >> index_bits;
+    }
+
+private:
+    static const uint32_t buffers = readers + 2;
+    static const uint32_t index_bits = 8;
+    static const uint32_t index_mask = (1 << index_bits) - 1;
+
+    /* a buffer which is neither the latest value nor held by a reader */
+    uint32_t free_buffer() {
+        uint32_t latest = _state & index_mask;
+        for (uint32_t b = 0; b < buffers; b++) {
+            if (b == latest)
+                continue;
+            bool held = false;
+            for (uint32_t i = 0; i < readers; i++) {
+                if (_held[i] == b)
+                    held = true;
+            }
+            if (!held)
+                return b;
+        }
+        return latest;
+    }
+
+    T _buffer[buffers];
+    volatile uint32_t _state;               /* publish count and index of the latest buffer */
+    volatile uint32_t _held[readers];       /* buffer latched by each reader */
+    uint32_t _seen[readers];                /* state at the last update of each reader */
+
+    typedef char readers_check[(readers >= 1 && buffers <= index_mask + 1) ? 1 : -1];
+};
+
+}
+
+#endif
@@ -29,6 +29,10 @@
 namespace rtos {
 
 RtosTimer::RtosTimer(void (*periodic_task)(void const *argument), os_timer_type type, void *argument) {
+    constructor(periodic_task, type, argument);
+}
+
+void RtosTimer::constructor(void (*periodic_task)(void const *argument), os_timer_type type, void *argument) {
 #ifdef CMSIS_OS_RTX
     _timer.ptimer = periodic_task;
 
@@ -38,6 +42,10 @@ RtosTimer::RtosTimer(void (*periodic_task)(void const *argument), os_timer_type
     _timer_id = osTimerCreate(&_timer, type, argument);
 }
 
+void RtosTimer::call_task(void const *argument) {
+    ((RtosTimer*)argument)->_task.call();
+}
+
 osStatus RtosTimer::start(uint32_t millisec) {
     return osTimerStart(_timer_id, millisec);
 }
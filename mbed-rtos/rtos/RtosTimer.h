@@ -24,6 +24,7 @@
 
 #include <stdint.h>
 #include "cmsis_os.h"
+#include "Callback.h"
 
 namespace rtos {
 
@@ -36,6 +37,9 @@ namespace rtos {
 */
 class RtosTimer {
 public:
+    /** Storage of a function object called by a timer */
+    typedef mbed::Callback<void()> callback_t;
+
     /** Create and Start timer.
       @param   task      name of the timer call back function.
       @param   type      osTimerOnce for one-shot or osTimerPeriodic for periodic behaviour. (default: osTimerPeriodic)
@@ -45,6 +49,17 @@ public:
           os_timer_type type=osTimerPeriodic,
           void *argument=NULL);
 
+    /** Create timer calling a function object.
+     A copy of the function object is kept inside the RtosTimer, so several timers may run the
+     same call back function, each with its own state.
+      @param   task      function object with operator()(), at most the size of a RtosTimer::callback_t.
+      @param   type      osTimerOnce for one-shot or osTimerPeriodic for periodic behaviour. (default: osTimerPeriodic)
+    */
+    template<typename F>
+    RtosTimer(const F &task, os_timer_type type=osTimerPeriodic) : _task(task) {
+        constructor(RtosTimer::call_task, type, this);
+    }
+
     /** Stop the timer.
       @return  status code that indicates the execution status of the function.
     */
@@ -59,6 +74,11 @@ public:
     ~RtosTimer();
 
 private:
+    void constructor(void (*task)(void const *argument), os_timer_type type, void *argument);
+
+    static void call_task(void const *argument);
+
+    callback_t _task;
     osTimerId _timer_id;
     osTimerDef_t _timer;
 #ifdef CMSIS_OS_RTX
@@ -22,10 +22,26 @@
 #include "Semaphore.h"
 
 #include <string.h>
+#include "Thread.h"
+#include "us_ticker_api.h"
 
 namespace rtos {
 
 Semaphore::Semaphore(int32_t count) {
+    constructor(count, false);
+}
+
+Semaphore::Semaphore(int32_t count, bool lock) {
+    constructor(count, lock);
+}
+
+void Semaphore::constructor(int32_t count, bool lock) {
+#if defined(RTOS_LOCK_STATS) || defined(RTOS_LOCK_ORDER)
+    _lock = lock;
+#endif
+#ifdef RTOS_LOCK_STATS
+    lock_stats_reset(_stats);
+#endif
 #ifdef CMSIS_OS_RTX
     memset(_semaphore_data, 0, sizeof(_semaphore_data));
     _osSemaphoreDef.semaphore = _semaphore_data;
@@ -34,10 +50,85 @@ Semaphore::Semaphore(int32_t count) {
 }
 
 int32_t Semaphore::wait(uint32_t millisec) {
+#if defined(RTOS_LOCK_STATS) || defined(RTOS_LOCK_ORDER)
+#ifdef RTOS_LOCK_ORDER
+    if (_lock) {
+        LockOrder::acquiring(this);
+    }
+#endif
+    // an available token is taken at once, only a contended wait is timed
+    int32_t tokens = osSemaphoreWait(_osSemaphoreId, 0);
+    bool contended = (tokens == 0) && (millisec != 0);
+#ifdef RTOS_LOCK_STATS
+    uint32_t wait_us = 0;
+#endif
+    if (contended) {
+#ifdef RTOS_LOCK_ORDER
+        if (_lock) {
+            LockOrder::blocking(this);
+        }
+#endif
+#ifdef RTOS_LOCK_STATS
+        uint32_t start_us = us_ticker_read();
+        tokens = osSemaphoreWait(_osSemaphoreId, millisec);
+        wait_us = us_ticker_read() - start_us;
+#else
+        tokens = osSemaphoreWait(_osSemaphoreId, millisec);
+#endif
+    }
+#ifdef RTOS_LOCK_STATS
+    if (tokens > 0) {
+        lock_stats_acquired(_stats, contended, wait_us);
+        if (_lock) {
+            lock_stats_locked(_stats);
+        }
+    } else if (contended) {
+        lock_stats_timeout(_stats);
+    }
+#endif
+#ifdef RTOS_LOCK_ORDER
+    if (_lock && (tokens > 0)) {
+        LockOrder::acquired(this);
+    }
+#endif
+    return tokens;
+#else
     return osSemaphoreWait(_osSemaphoreId, millisec);
+#endif
+}
+
+int32_t Semaphore::wait_us(uint32_t microsec) {
+    uint32_t end_us = us_ticker_read() + microsec;
+
+    // a wait of n ticks may end up to one tick early, so leave a tick for the fine wait
+    if (microsec >= 2000) {
+        int32_t tokens = wait(microsec / 1000 - 1);
+        if (tokens != 0)
+            return tokens;
+    }
+
+    while (true) {
+        int32_t tokens = wait(0);
+        if (tokens != 0)
+            return tokens;
+        int32_t remaining_us = (int32_t)(end_us - us_ticker_read());
+        if (remaining_us <= 0)
+            return 0;
+        Thread::wait_us(((uint32_t)remaining_us < Thread::wait_us_slice) ? remaining_us : Thread::wait_us_slice);
+    }
 }
 
 osStatus Semaphore::release(void) {
+#ifdef RTOS_LOCK_STATS
+    if (_lock) {
+        lock_stats_unlocked(_stats);
+    }
+#endif
+#ifdef RTOS_LOCK_ORDER
+    if (_lock) {
+        LockOrder::released(this);
+    }
+#endif
     return osSemaphoreRelease(_osSemaphoreId);
 }
 
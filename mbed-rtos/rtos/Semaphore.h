@@ -24,6 +24,12 @@
 
 #include <stdint.h>
 #include "cmsis_os.h"
+#ifdef RTOS_LOCK_STATS
+#include "LockStats.h"
+#endif
+#ifdef RTOS_LOCK_ORDER
+#include "LockOrder.h"
+#endif
 
 namespace rtos {
 
@@ -35,21 +41,61 @@ public:
     */
     Semaphore(int32_t count);
 
+    /** Create and Initialize a Semaphore object, which may be used as a lock.
+      @param count number of available resources; maximum index value is (count-1).
+      @param lock  true if the Semaphore is a binary lock: created with count 1 and released by the
+                   thread which took it. Only such semaphores are checked by LockOrder and have
+                   their hold time recorded by RTOS_LOCK_STATS, a Semaphore used for signalling
+                   between threads would add false edges to the graph and has no holder.
+    */
+    Semaphore(int32_t count, bool lock);
+
     /** Wait until a Semaphore resource becomes available.
       @param   millisec  timeout value or 0 in case of no time-out. (default: osWaitForever).
       @return  number of available tokens, or -1 in case of incorrect parameters
     */
     int32_t wait(uint32_t millisec=osWaitForever);
 
+    /** Wait until a Semaphore resource becomes available, with a timeout in microsec.
+     Whole ticks are waited in the kernel like wait(), the last tick by taking a token between
+     sleeps of Thread::wait_us, so a release in the last tick is seen up to Thread::wait_us_slice
+     late. The wait never ends before the timeout. Not from ISR context.
+      @param   microsec  timeout value, up to 2^31 microsec.
+      @return  number of available tokens, 0 in case of a timeout, or -1 in case of incorrect parameters
+    */
+    int32_t wait_us(uint32_t microsec);
+
     /** Release a Semaphore resource that was obtain with Semaphore::wait.
       @return  status code that indicates the execution status of the function.
     */
     osStatus release(void);
 
+#ifdef RTOS_LOCK_STATS
+    /** Get the contention statistics, recorded with RTOS_LOCK_STATS defined
+      @return  statistics since creation or the last reset_stats.
+    */
+    const LockStats &stats() const {
+        return _stats;
+    }
+
+    /** Clear the contention statistics */
+    void reset_stats() {
+        lock_stats_reset(_stats);
+    }
+#endif
+
     ~Semaphore();
 
 private:
+    void constructor(int32_t count, bool lock);
+
     osSemaphoreId _osSemaphoreId;
+#if defined(RTOS_LOCK_STATS) || defined(RTOS_LOCK_ORDER)
+    bool _lock;
+#endif
+#ifdef RTOS_LOCK_STATS
+    LockStats _stats;
+#endif
     osSemaphoreDef_t _osSemaphoreDef;
 #ifdef CMSIS_OS_RTX
     uint32_t _semaphore_data[2];
@@ -0,0 +1,145 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "TTExecutive.h"
+
+#include <string.h>
+
+#include "RtosTimer.h"
+#include "us_ticker_api.h"
+#include "mbed_error.h"
+
+namespace rtos {
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+TTExecutive::TTExecutive(const TTTask *table, TTStats *stats, uint32_t count) :
+    _table(table), _stats(stats), _count(count), _minor_ms(0), _hyper_ms(1),
+    _frame_overruns(0), _ticks(0), _tid(NULL) {
+    for (uint32_t i = 0; i < _count; i++) {
+        const TTTask &task = _table[i];
+        if ((task.step == NULL) || (task.period_ms == 0) || (task.offset_ms >= task.period_ms))
+            error("Invalid time-triggered schedule table\n");
+
+        _minor_ms = gcd(gcd(_minor_ms, task.period_ms), task.offset_ms);
+        _hyper_ms = _hyper_ms / gcd(_hyper_ms, task.period_ms) * task.period_ms;
+    }
+}
+
+uint32_t TTExecutive::minor_frame() {
+    return _minor_ms;
+}
+
+uint32_t TTExecutive::hyperperiod() {
+    return _hyper_ms;
+}
+
+bool TTExecutive::released(uint32_t task, uint32_t time_ms) {
+    if (task >= _count)
+        return false;
+    return (time_ms % _table[task].period_ms) == _table[task].offset_ms;
+}
+
+const TTStats *TTExecutive::stats(uint32_t task) {
+    if (task >= _count)
+        return NULL;
+    return &_stats[task];
+}
+
+uint32_t TTExecutive::frame_overruns() {
+    return _frame_overruns;
+}
+
+void TTExecutive::tick(void const *argument) {
+    TTExecutive *executive = (TTExecutive*)argument;
+    executive->_ticks++;
+    osSignalSet(executive->_tid, signal_flag);
+}
+
+void TTExecutive::dispatch(uint32_t time_ms, uint32_t release_us) {
+    uint32_t minor_us = _minor_ms * 1000;
+
+    for (uint32_t i = 0; i < _count; i++) {
+        if (!released(i, time_ms))
+            continue;
+
+        TTStats &stats = _stats[i];
+        uint32_t jitter_us = us_ticker_read() - release_us;
+        if (jitter_us > stats.max_jitter_us) {
+            stats.max_jitter_us = jitter_us;
+        }
+        _table[i].step(NULL);
+        stats.runs++;
+        if ((us_ticker_read() - release_us) > minor_us) {
+            stats.overruns++;
+        }
+    }
+}
+
+void TTExecutive::run() {
+    if (_count == 0)
+        error("Empty time-triggered schedule table\n");
+
+    memset(_stats, 0, _count * sizeof(TTStats));
+    _frame_overruns = 0;
+    _tid = osThreadGetId();
+
+    uint32_t minor_us = _minor_ms * 1000;
+    uint32_t time_ms = 0;
+    uint32_t frame = 0;
+
+    RtosTimer timer(TTExecutive::tick, osTimerPeriodic, this);
+    uint32_t release_us = us_ticker_read();
+    timer.start(_minor_ms);
+
+    while (true) {
+        dispatch(time_ms, release_us);
+
+        // a frame already released started late; while catching up after a long frame
+        // every frame is checked once, so each late frame counts once
+        frame++;
+        if ((int32_t)(_ticks - frame) >= 0) {
+            _frame_overruns++;
+        }
+        while ((int32_t)(_ticks - frame) < 0) {
+            osSignalWait(signal_flag, osWaitForever);
+        }
+
+        release_us += minor_us;
+        time_ms += _minor_ms;
+        if (time_ms >= _hyper_ms) {
+            time_ms = 0;
+        }
+    }
+}
+
+void TTExecutive::thread(void const *argument) {
+    ((TTExecutive*)argument)->run();
+}
+
+}
@@ -0,0 +1,143 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef TT_EXECUTIVE_H
+#define TT_EXECUTIVE_H
+
+#include <stdint.h>
+#include "cmsis_os.h"
+#include "rtos_signals.h"
+
+namespace rtos {
+
+/** Entry of the static schedule table of a TTExecutive */
+struct TTTask {
+    void (*step)(void const *argument);
+    uint32_t offset_ms;     /* release offset within the period */
+    uint32_t period_ms;
+};
+
+/** Run time statistics of a TTTask */
+struct TTStats {
+    uint32_t runs;
+    uint32_t overruns;      /* steps which ended after the start of the next minor frame */
+    uint32_t max_jitter_us; /* largest delay from release to start of a step */
+};
+
+/** The TTExecutive class runs a static, time-triggered schedule.
+ Time is divided in minor frames, the greatest common divisor of all periods and offsets.
+ A periodic timer releases one minor frame after the other; in each frame the executive calls the
+ step function of every task whose offset is reached within its period, in table order.
+ The dispatch sequence therefore repeats exactly every hyperperiod, the least common multiple of
+ all periods.
+
+ The executive runs in the thread function TTExecutive::thread, started with the executive as argument.
+ Signal flag TTExecutive::signal_flag of that thread is used by the executive.
+*/
+class TTExecutive {
+public:
+    /** Signal flag of the executive thread set by the minor frame timer */
+    static const int32_t signal_flag = RTOS_SIGNAL_TT_EXECUTIVE;
+
+    /** Create an executive for a schedule table.
+      @param   table  schedule table, every offset must be smaller than its period.
+      @param   stats  storage for the statistics of every table entry.
+      @param   count  number of entries of the table.
+    */
+    TTExecutive(const TTTask *table, TTStats *stats, uint32_t count);
+
+    /** Get the length of a minor frame
+      @return  minor frame in millisec.
+    */
+    uint32_t minor_frame();
+
+    /** Get the length of the hyperperiod
+      @return  hyperperiod in millisec.
+    */
+    uint32_t hyperperiod();
+
+    /** Check if a table entry is released at a given time
+      @param   task     index of the table entry.
+      @param   time_ms  time since the start of the schedule in millisec.
+      @return  true if the task is released at that time.
+    */
+    bool released(uint32_t task, uint32_t time_ms);
+
+    /** Get the statistics of a table entry
+      @param   task  index of the table entry.
+      @return  statistics of the entry, NULL in case of incorrect parameters.
+    */
+    const TTStats *stats(uint32_t task);
+
+    /** Get the number of minor frames which started late
+      @return  number of minor frames released while the previous frame was still running,
+               each late frame is counted once.
+    */
+    uint32_t frame_overruns();
+
+    /** Dispatch one minor frame: call, in table order, the step of every task released at time_ms.
+     run() calls it once per minor frame, a test can call it to drive the schedule in virtual time.
+      @param   time_ms     start of the frame within the hyperperiod in millisec.
+      @param   release_us  us_ticker time at which the frame was released, for the statistics.
+    */
+    void dispatch(uint32_t time_ms, uint32_t release_us);
+
+    /** Run the schedule in the current thread, this function does not return.
+     The minor frame timer only releases the frames, the steps run in this thread. */
+    void run();
+
+    /** Thread function running an executive
+      @param   argument  pointer to the TTExecutive.
+    */
+    static void thread(void const *argument);
+
+private:
+    static void tick(void const *argument);
+
+    const TTTask *_table;
+    TTStats *_stats;
+    uint32_t _count;
+    uint32_t _minor_ms;
+    uint32_t _hyper_ms;
+    uint32_t _frame_overruns;
+    volatile uint32_t _ticks;
+    osThreadId _tid;
+};
+
+/** A TTExecutive which carries the statistics of its table.
+  @tparam  count  number of entries of the schedule table.
+*/
+template<uint32_t count>
+class StaticTTExecutive : public TTExecutive {
+public:
+    /** Create an executive for a schedule table.
+      @param   table  schedule table.
+    */
+    StaticTTExecutive(const TTTask (&table)[count]) : TTExecutive(table, _table_stats, count) {
+    }
+
+private:
+    TTStats _table_stats[count];
+};
+
+}
+
+#endif
@@ -0,0 +1,202 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "TaskWatchdog.h"
+
+#include "cmsis.h"
+#include "us_ticker_api.h"
+
+namespace rtos {
+
+/* WatchedTask::reported bits */
+#define REPORTED_OVERRUN    0x01
+#define REPORTED_MISSED     0x02
+
+static void feed_hardware() {
+#if defined(TARGET_LPC1768)
+    // the feed sequence must not be interrupted by another WDT access
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    LPC_WDT->WDFEED = 0xAA;
+    LPC_WDT->WDFEED = 0x55;
+    __set_PRIMASK(primask);
+#endif
+}
+
+TaskWatchdog::TaskWatchdog(uint32_t check_ms) :
+    _timer(TaskWatchdog::tick, osTimerPeriodic, this), _check_ms(check_ms), _tasks(NULL),
+    _handler(NULL), _violations(0), _started(false), _hardware(false) {
+}
+
+void TaskWatchdog::add(WatchedTask &task, const char *name, uint32_t period_us, uint32_t budget_us) {
+    task.name = name;
+    task.period_us = period_us;
+    task.budget_us = budget_us;
+    task.cycles = 0;
+    task.overruns = 0;
+    task.missed = 0;
+    task.max_exec_us = 0;
+    task.last_violation_us = 0;
+    task.start_us = us_ticker_read();
+    task.running = false;
+    task.reported = 0;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    task.next = _tasks;
+    _tasks = &task;
+    __set_PRIMASK(primask);
+
+    start();
+}
+
+void TaskWatchdog::begin(WatchedTask &task) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    task.start_us = us_ticker_read();
+    task.running = true;
+    task.reported = 0;
+    __set_PRIMASK(primask);
+}
+
+void TaskWatchdog::end(WatchedTask &task) {
+    uint32_t now_us = us_ticker_read();
+    bool overrun = false;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t exec_us = now_us - task.start_us;
+    task.running = false;
+    task.cycles++;
+    if (exec_us > task.max_exec_us) {
+        task.max_exec_us = exec_us;
+    }
+    if (exec_us > task.budget_us) {
+        overrun = record(task, WatchdogOverrun, now_us);
+    }
+    __set_PRIMASK(primask);
+
+    if (overrun) {
+        notify(task, WatchdogOverrun);
+    }
+}
+
+void TaskWatchdog::set_handler(watchdog_handler_t handler) {
+    _handler = handler;
+}
+
+bool TaskWatchdog::enable_hardware(uint32_t timeout_ms) {
+#if defined(TARGET_LPC1768)
+    LPC_WDT->WDCLKSEL = 0;              // internal RC oscillator, the counter runs at 1 MHz
+    LPC_WDT->WDTC = timeout_ms * 1000;
+    LPC_WDT->WDMOD = 0x03;              // enable, reset on timeout
+    feed_hardware();
+    _hardware = true;
+    start();
+    return true;
+#else
+    (void)timeout_ms;
+    return false;
+#endif
+}
+
+uint32_t TaskWatchdog::violations() {
+    return _violations;
+}
+
+const WatchedTask *TaskWatchdog::tasks() {
+    return _tasks;
+}
+
+void TaskWatchdog::tick(void const *argument) {
+    ((TaskWatchdog*)argument)->check();
+}
+
+void TaskWatchdog::check() {
+    bool healthy = true;
+
+    for (WatchedTask *task = _tasks; task != NULL; task = task->next) {
+        bool overrun = false;
+        bool missed = false;
+
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        uint32_t now_us = us_ticker_read();
+        uint32_t since_us = now_us - task->start_us;
+        if (task->running && (since_us > task->budget_us)) {
+            overrun = record(*task, WatchdogOverrun, now_us);
+        }
+        if (since_us > 2 * task->period_us) {
+            missed = record(*task, WatchdogMissed, now_us);
+            healthy = false;
+        }
+        __set_PRIMASK(primask);
+
+        if (overrun) {
+            notify(*task, WatchdogOverrun);
+        }
+        if (missed) {
+            notify(*task, WatchdogMissed);
+        }
+    }
+
+    if (_hardware && healthy) {
+        feed_hardware();
+    }
+}
+
+void TaskWatchdog::start() {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    bool first = !_started;
+    _started = true;
+    __set_PRIMASK(primask);
+
+    if (first) {
+        _timer.start(_check_ms);
+    }
+}
+
+/* count a violation once per cycle, called with interrupts disabled */
+bool TaskWatchdog::record(WatchedTask &task, WatchdogViolation violation, uint32_t now_us) {
+    uint8_t bit = (violation == WatchdogOverrun) ? REPORTED_OVERRUN : REPORTED_MISSED;
+    if (task.reported & bit)
+        return false;
+
+    task.reported |= bit;
+    if (violation == WatchdogOverrun) {
+        task.overruns++;
+    } else {
+        task.missed++;
+    }
+    task.last_violation_us = now_us;
+    _violations++;
+    return true;
+}
+
+void TaskWatchdog::notify(WatchedTask &task, WatchdogViolation violation) {
+    watchdog_handler_t handler = _handler;
+    if (handler != NULL) {
+        handler(task, violation);
+    }
+}
+
+}
@@ -0,0 +1,131 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef TASK_WATCHDOG_H
+#define TASK_WATCHDOG_H
+
+#include <stdint.h>
+#include "cmsis_os.h"
+#include "RtosTimer.h"
+
+namespace rtos {
+
+/** Kind of timing violation detected by a TaskWatchdog */
+enum WatchdogViolation {
+    WatchdogOverrun,        /**< a cycle ran longer than the execution budget */
+    WatchdogMissed          /**< no cycle started for two periods */
+};
+
+/** Budget and violation record of a periodic task supervised by a TaskWatchdog */
+struct WatchedTask {
+    const char *name;
+    uint32_t period_us;
+    uint32_t budget_us;         /* time allowed from the start to the end of a cycle */
+    uint32_t cycles;
+    uint32_t overruns;          /* cycles which ran longer than the budget */
+    uint32_t missed;            /* times no cycle started for two periods */
+    uint32_t max_exec_us;
+    uint32_t last_violation_us; /* us_ticker time of the last violation */
+
+    /* state of the current cycle */
+    volatile uint32_t start_us;
+    volatile bool running;
+    uint8_t reported;           /* violations of the current cycle already counted */
+    WatchedTask *next;
+};
+
+/** Function called on a timing violation, from the watchdog timer or from the task itself */
+typedef void (*watchdog_handler_t)(WatchedTask &task, WatchdogViolation violation);
+
+/** The TaskWatchdog class checks that periodic tasks keep to their period and execution budget.
+ A task registers itself with add, then brackets every cycle with begin and end. An overrun is
+ detected by end, or while the task is still running by a check of the watchdog timer, so the
+ detection latency is at most one check period. A task which starts no cycle for two periods, for
+ example because it hangs or is starved, counts as missed.
+
+ Optionally the watchdog drives the hardware watchdog: it is fed on every check, except while a
+ task is missed, so a hung task resets the microcontroller.
+*/
+class TaskWatchdog {
+public:
+    /** Create a watchdog, its timer starts with the first task or with the hardware watchdog.
+      @param   check_ms  period of the watchdog timer in millisec.
+    */
+    TaskWatchdog(uint32_t check_ms);
+
+    /** Supervise a task, usually called by the task before its first cycle.
+      @param   task       storage for the record of the task, valid while the watchdog runs.
+      @param   name       name of the task, for reports.
+      @param   period_us  period of the task.
+      @param   budget_us  time allowed from begin to end of a cycle, including preemption.
+    */
+    void add(WatchedTask &task, const char *name, uint32_t period_us, uint32_t budget_us);
+
+    /** Check in at the start of a cycle
+      @param   task  record of the calling task.
+    */
+    void begin(WatchedTask &task);
+
+    /** Check in at the end of a cycle
+      @param   task  record of the calling task.
+    */
+    void end(WatchedTask &task);
+
+    /** Set the function called on every violation.
+      @param   handler  function to call, or NULL to only count violations.
+    */
+    void set_handler(watchdog_handler_t handler);
+
+    /** Start the hardware watchdog, which can not be stopped again.
+      @param   timeout_ms  time without a feed until the microcontroller is reset, more than the check period.
+      @return  true if the target has a supported hardware watchdog.
+    */
+    bool enable_hardware(uint32_t timeout_ms);
+
+    /** Get the total number of violations
+      @return  number of violations of all tasks.
+    */
+    uint32_t violations();
+
+    /** Get the supervised tasks
+      @return  first task, the others are linked with WatchedTask::next.
+    */
+    const WatchedTask *tasks();
+
+private:
+    static void tick(void const *argument);
+    void check();
+    void start();
+    bool record(WatchedTask &task, WatchdogViolation violation, uint32_t now_us);
+    void notify(WatchedTask &task, WatchdogViolation violation);
+
+    RtosTimer _timer;
+    uint32_t _check_ms;
+    WatchedTask *_tasks;
+    watchdog_handler_t _handler;
+    volatile uint32_t _violations;
+    bool _started;
+    bool _hardware;
+};
+
+}
+
+#endif
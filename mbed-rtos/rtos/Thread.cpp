@@ -23,11 +23,39 @@
 
 #include "mbed_error.h"
 #include "rtos_idle.h"
+#include "TimerEvent.h"
 
 namespace rtos {
 
+/* Remaining time below which Thread::wait_us polls instead of sleeping */
+#define WAIT_US_POLL    50
+
+/* us_ticker event that wakes up a thread sleeping in Thread::wait_us */
+class WakeupEvent : public mbed::TimerEvent {
+public:
+    WakeupEvent(osThreadId tid) : _tid(tid) {
+    }
+
+    void at(timestamp_t timestamp) {
+        insert(timestamp);
+    }
+
+protected:
+    virtual void handler() {
+        osSignalSet(_tid, Thread::wait_us_flag);
+    }
+
+private:
+    osThreadId _tid;
+};
+
 Thread::Thread(void (*task)(void const *argument), void *argument,
         osPriority priority, uint32_t stack_size, unsigned char *stack_pointer) {
+    constructor(task, argument, priority, stack_size, stack_pointer);
+}
+
+void Thread::constructor(void (*task)(void const *argument), void *argument,
+        osPriority priority, uint32_t stack_size, unsigned char *stack_pointer) {
 #ifdef CMSIS_OS_RTX
     _thread_def.pthread = task;
     _thread_def.tpriority = priority;
@@ -50,6 +78,10 @@ Thread::Thread(void (*task)(void const *argument), void *argument,
     _tid = osThreadCreate(&_thread_def, argument);
 }
 
+void Thread::call_task(void const *argument) {
+    ((Thread*)argument)->_task.call();
+}
+
 osStatus Thread::terminate() {
     return osThreadTerminate(_tid);
 }
@@ -70,6 +102,14 @@ int32_t Thread::signal_clr(int32_t signals) {
     return osSignalClear(_tid, signals);
 }
 
+osStatus Thread::set_period(uint32_t period_ms, uint32_t deadline_ms) {
+    return osThreadSetPeriod(_tid, period_ms, deadline_ms);
+}
+
+uint32_t Thread::deadline_misses() {
+    return osThreadGetDeadlineMisses(_tid);
+}
+
 Thread::State Thread::get_state() {
 #ifndef __MBED_CMSIS_RTOS_CA9
     return ((State)_thread_def.tcb.state);
@@ -90,7 +130,7 @@ uint32_t Thread::stack_size() {
 
 uint32_t Thread::free_stack() {
 #ifndef __MBED_CMSIS_RTOS_CA9
-    uint32_t bottom = (uint32_t)_thread_def.tcb.stack;
+    uint32_t bottom = (uint32_t)(uintptr_t)_thread_def.tcb.stack;
     return _thread_def.tcb.tsk_stack - bottom;
 #else
     return 0;
@@ -99,7 +139,7 @@ uint32_t Thread::free_stack() {
 
 uint32_t Thread::used_stack() {
 #ifndef __MBED_CMSIS_RTOS_CA9
-    uint32_t top = (uint32_t)_thread_def.tcb.stack + _thread_def.tcb.priv_stack;
+    uint32_t top = (uint32_t)(uintptr_t)_thread_def.tcb.stack + _thread_def.tcb.priv_stack;
     return top - _thread_def.tcb.tsk_stack;
 #else
     return 0;
@@ -125,10 +165,38 @@ osStatus Thread::wait(uint32_t millisec) {
     return osDelay(millisec);
 }
 
+osStatus Thread::wait_us(uint32_t microsec) {
+    uint32_t end_us = us_ticker_read() + microsec;
+
+    // a delay of n ticks may end up to one tick early, so leave a tick for the fine wait
+    if (microsec >= 2000) {
+        osStatus status = osDelay(microsec / 1000 - 1);
+        if (status != osEventTimeout)
+            return status;
+    }
+
+    int32_t remaining_us = (int32_t)(end_us - us_ticker_read());
+    if (remaining_us > WAIT_US_POLL) {
+        osThreadId tid = osThreadGetId();
+        osSignalClear(tid, wait_us_flag);
+        WakeupEvent wakeup(tid);
+        // wake up a bit early, the rest is polled; the timeout only covers a missed compare
+        wakeup.at(end_us - WAIT_US_POLL / 2);
+        osSignalWait(wait_us_flag, remaining_us / 1000 + 2);
+    }
+
+    while ((int32_t)(end_us - us_ticker_read()) > 0);
+    return osEventTimeout;
+}
+
 osStatus Thread::yield() {
     return osThreadYield();
 }
 
+osStatus Thread::wait_period() {
+    return osThreadWaitPeriod();
+}
+
 osThreadId Thread::gettid() {
     return osThreadGetId();
 }
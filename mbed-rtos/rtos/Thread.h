@@ -24,12 +24,23 @@
 
 #include <stdint.h>
 #include "cmsis_os.h"
+#include "rtos_signals.h"
+#include "Callback.h"
 
 namespace rtos {
 
 /** The Thread class allow defining, creating, and controlling thread functions in the system. */
 class Thread {
 public:
+    /** Storage of a function object run by a thread */
+    typedef mbed::Callback<void()> callback_t;
+
+    /** Signal flag of the current thread used by Thread::wait_us */
+    static const int32_t wait_us_flag = RTOS_SIGNAL_WAIT_US;
+
+    /** Sleep between two attempts in the last tick of Semaphore::wait_us and Mutex::lock_us, in microsec */
+    static const uint32_t wait_us_slice = 200;
+
     /** Create a new thread, and start it executing the specified function.
       @param   task           function to be executed by this thread.
       @param   argument       pointer that is passed to the thread function as start argument. (default: NULL).
@@ -42,6 +53,22 @@ public:
            uint32_t stack_size=DEFAULT_STACK_SIZE,
            unsigned char *stack_pointer=NULL);
 
+    /** Create a new thread, and start it calling a function object.
+     A copy of the function object is kept inside the Thread, so its state belongs to this
+     thread and the same task can run in several threads, each with its own state.
+      @param   task           function object with operator()(), at most the size of a Thread::callback_t.
+      @param   priority       initial priority of the thread function. (default: osPriorityNormal).
+      @param   stack_size      stack size (in bytes) requirements for the thread function. (default: DEFAULT_STACK_SIZE).
+      @param   stack_pointer  pointer to the stack area to be used by this thread (default: NULL).
+    */
+    template<typename F>
+    Thread(const F &task,
+           osPriority priority=osPriorityNormal,
+           uint32_t stack_size=DEFAULT_STACK_SIZE,
+           unsigned char *stack_pointer=NULL) : _task(task) {
+        constructor(Thread::call_task, this, priority, stack_size, stack_pointer);
+    }
+
     /** Terminate execution of a thread and remove it from Active Threads
       @return  status code that indicates the execution status of the function.
     */
@@ -70,6 +97,18 @@ public:
     */
     int32_t signal_clr(int32_t signals);
 
+    /** Set the release period and relative deadline of this Thread, the current release starts now.
+      @param   period_ms    release period in millisec, 0 removes the period (max 60000).
+      @param   deadline_ms  deadline relative to each release in millisec, 0 for the period. (default: 0).
+      @return  status code that indicates the execution status of the function.
+    */
+    osStatus set_period(uint32_t period_ms, uint32_t deadline_ms=0);
+
+    /** Get the number of deadlines this Thread missed
+      @return  number of releases completed after their deadline or skipped.
+    */
+    uint32_t deadline_misses();
+
     /** State of the Thread */
     enum State {
         Inactive,           /**< Not created or terminated */
@@ -122,11 +161,37 @@ public:
     */
     static osStatus wait(uint32_t millisec);
 
+    /** Wait for a specified time period in microsec.
+     Whole ticks are waited with osDelay, the rest with a us_ticker interrupt, and the last
+     microseconds by polling the us_ticker, so the thread never wakes up early.
+     Signal flag Thread::wait_us_flag of the current thread is used for the us_ticker wake up.
+
+     Limits:
+     - the thread polls for up to 50 us (WAIT_US_POLL) before the end, and for the whole
+       delay if it is that short; lower priority threads do not run meanwhile.
+     - the thread wakes up late by the interrupt and scheduling latency, and by higher
+       priority threads that are ready at the end of the delay.
+     - delays up to 2^31 us, the range of the 32-bit us_ticker.
+     - Semaphore::wait_us and Mutex::lock_us have microsecond timeouts built on this sleep;
+       the timeouts of Queue, Mail and signal waits, RtosTimer and osDelay stay in whole
+       ticks of 1 ms.
+     - not from ISR context.
+      @param   microsec  time delay value
+      @return  status code that indicates the execution status of the function.
+    */
+    static osStatus wait_us(uint32_t microsec);
+
     /** Pass control to next thread that is in state READY.
       @return  status code that indicates the execution status of the function.
     */
     static osStatus yield();
 
+    /** Complete the current release of the current RUNNING thread and wait for its next release.
+     With OS_EDF enabled threads of the same priority run in order of their deadlines.
+      @return  status code that indicates the execution status of the function.
+    */
+    static osStatus wait_period();
+
     /** Get the thread id of the current running thread.
       @return  thread ID for reference by other functions or NULL in case of error.
     */
@@ -140,10 +205,66 @@ public:
     virtual ~Thread();
 
 private:
+    void constructor(void (*task)(void const *argument), void *argument,
+                     osPriority priority, uint32_t stack_size, unsigned char *stack_pointer);
+
+    static void call_task(void const *argument);
+
+    callback_t _task;
     osThreadId _tid;
     osThreadDef_t _thread_def;
     bool _dynamic_stack;
 };
 
+/** Stack memory of a StaticThread.
+ It is a separate base class so that the stack exists before the Thread base class starts running on it.
+  @tparam  stack_sz  stack size (in bytes) of the thread.
+*/
+template<uint32_t stack_sz>
+class StaticThreadStack {
+protected:
+    uint32_t _stack[stack_sz / sizeof(uint32_t)];
+};
+
+/** A Thread which carries its own stack instead of allocating it from the heap.
+ The thread control block is already part of every Thread, so a StaticThread defined with static
+ storage duration (global or function-local static) has all of its memory placed in .bss: the
+ number of threads and their stack sizes are then limited by RAM and checked by the linker.
+  @tparam  stack_sz  stack size (in bytes) of the thread, a multiple of 8. (default: DEFAULT_STACK_SIZE).
+*/
+template<uint32_t stack_sz = DEFAULT_STACK_SIZE>
+class StaticThread : private StaticThreadStack<stack_sz>, public Thread {
+public:
+    /** Create a new thread on the embedded stack, and start it executing the specified function.
+      @param   task           function to be executed by this thread.
+      @param   argument       pointer that is passed to the thread function as start argument. (default: NULL).
+      @param   priority       initial priority of the thread function. (default: osPriorityNormal).
+    */
+    StaticThread(void (*task)(void const *argument), void *argument=NULL,
+                 osPriority priority=osPriorityNormal)
+        : Thread(task, argument, priority, stack_sz, (unsigned char*)this->_stack) {
+    }
+
+    /** Create a new thread on the embedded stack, and start it calling a function object.
+      @param   task           function object with operator()(), copied into the thread.
+      @param   priority       initial priority of the thread function. (default: osPriorityNormal).
+    */
+    template<typename F>
+    StaticThread(const F &task, osPriority priority=osPriorityNormal)
+        : Thread(task, priority, stack_sz, (unsigned char*)this->_stack) {
+    }
+
+    /** Get the RAM used by a thread of this type
+      @return  size in bytes of the thread control block, the stack and the object itself.
+    */
+    static uint32_t ram_size() {
+        return sizeof(StaticThread<stack_sz>);
+    }
+
+private:
+    /* The stack has to hold at least the initial exception frame and be 8 byte aligned */
+    typedef char stack_size_check[(stack_sz >= 128 && (stack_sz % 8) == 0) ? 1 : -1];
+};
+
 }
 #endif
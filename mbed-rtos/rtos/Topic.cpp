@@ -0,0 +1,93 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "Topic.h"
+
+#include "us_ticker_api.h"
+
+namespace rtos {
+
+TopicBase::TopicBase() : _seq(0), _subscribers(NULL) {
+}
+
+void TopicBase::end_write() {
+    __DMB();
+    _seq++;
+
+    for (TopicSubscription *subscription = _subscribers; subscription != NULL; subscription = subscription->next) {
+        osSignalSet(subscription->tid, subscription->signal);
+    }
+}
+
+void TopicBase::subscribe(TopicSubscription &subscription, int32_t signal, uint32_t min_interval_ms) {
+    subscription.tid = osThreadGetId();
+    subscription.signal = signal;
+    subscription.min_interval_us = min_interval_ms * 1000;
+    subscription.version = version();
+    subscription.last_us = us_ticker_read() - subscription.min_interval_us;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    subscription.next = _subscribers;
+    _subscribers = &subscription;
+    __set_PRIMASK(primask);
+}
+
+void TopicBase::unsubscribe(TopicSubscription &subscription) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    for (TopicSubscription **link = &_subscribers; *link != NULL; link = &(*link)->next) {
+        if (*link == &subscription) {
+            *link = subscription.next;
+            break;
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+bool TopicBase::wait_changed(TopicSubscription &subscription, uint32_t millisec) {
+    uint32_t start_us = us_ticker_read();
+
+    // rate limit: no change is returned before the interval since the last one has passed
+    int32_t hold_us = (int32_t)(subscription.last_us + subscription.min_interval_us - start_us);
+    if (hold_us > 0) {
+        uint32_t hold_ms = ((uint32_t)hold_us + 999) / 1000;
+        if ((millisec != osWaitForever) && (hold_ms > millisec))
+            return false;
+        osDelay(hold_ms);
+    }
+
+    while (!changed_since(subscription.version)) {
+        uint32_t timeout = osWaitForever;
+        if (millisec != osWaitForever) {
+            uint32_t elapsed_ms = (us_ticker_read() - start_us) / 1000;
+            if (elapsed_ms >= millisec)
+                return false;
+            timeout = millisec - elapsed_ms;
+        }
+        // the signal may be left over from an older publish, so test the version again
+        osSignalWait(subscription.signal, timeout);
+    }
+    subscription.last_us = us_ticker_read();
+    return true;
+}
+
+}
@@ -0,0 +1,186 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef TOPIC_H
+#define TOPIC_H
+
+#include <stdint.h>
+#include "cmsis.h"
+#include "cmsis_os.h"
+
+namespace rtos {
+
+/** Subscription of a thread to a Topic */
+struct TopicSubscription {
+    osThreadId tid;                 /* thread woken up on a publish */
+    int32_t signal;                 /* signal flag set in that thread */
+    uint32_t min_interval_us;       /* least time between two changes seen by the thread, 0 for none */
+    uint32_t version;               /* last version seen by the thread */
+    uint32_t last_us;               /* time the last version was seen */
+    TopicSubscription *next;
+};
+
+/** Version counting and subscriber list of a Topic, independent of the value type */
+class TopicBase {
+public:
+    /** Get the version of the latest value
+      @return  number of publishes so far.
+
+      @note You may call this function from ISR context.
+    */
+    uint32_t version() {
+        return _seq >> 1;
+    }
+
+    /** Check if a value newer than a known version was published
+      @param   version  version the caller has seen.
+      @return  true if a newer value exists.
+
+      @note You may call this function from ISR context.
+    */
+    bool changed_since(uint32_t version) {
+        return (_seq >> 1) != version;
+    }
+
+    /** Subscribe the current thread, it is signaled on every publish.
+      @param   subscription     storage for the subscription, valid until unsubscribe.
+      @param   signal           signal flag set in the current thread on a publish.
+      @param   min_interval_ms  least time between two changes returned by wait, 0 for none. (default: 0).
+    */
+    void subscribe(TopicSubscription &subscription, int32_t signal, uint32_t min_interval_ms=0);
+
+    /** Remove a subscription.
+      @param   subscription  subscription added with subscribe.
+    */
+    void unsubscribe(TopicSubscription &subscription);
+
+protected:
+    TopicBase();
+
+    /* write side of the two buffer sequence lock, see Topic */
+    void begin_write() {
+        _seq++;
+        __DMB();
+    }
+    void end_write();
+
+    /* wait until the version differs from the subscription, honouring the rate limit */
+    bool wait_changed(TopicSubscription &subscription, uint32_t millisec);
+
+    volatile uint32_t _seq;
+    TopicSubscription *_subscribers;
+};
+
+/** The Topic class publishes the latest value of a signal, for example the average speed.
+ Readers always get the latest complete value without locks and without blocking the producer:
+ the topic keeps two buffers, a publish writes the buffer not read by the current version, and a
+ read is repeated only if the producer published twice while it was copying. An interrupted
+ publish never makes a reader wait, so readers may have a higher priority than the producer.
+
+ Every publish increments the version. A consumer may poll cheaply with changed_since, read only
+ changed values with read_if_changed, or subscribe its thread and sleep in wait until a new value
+ is published, at most once per min_interval_ms.
+
+ A topic has one producer; publish must not be called from two threads concurrently.
+  @tparam  T  data type of the value, trivially copyable.
+*/
+template<typename T>
+class Topic : public TopicBase {
+public:
+    /** Create a topic.
+      @param   value  initial value, version 0.
+    */
+    Topic(const T &value = T()) {
+        _value[0] = value;
+        _value[1] = value;
+    }
+
+    /** Publish a new value and signal the subscribers.
+      @param   value  new value.
+
+      @note You may call this function from ISR context.
+    */
+    void publish(const T &value) {
+        begin_write();
+        _value[((_seq + 1) >> 1) & 1] = value;
+        end_write();
+    }
+
+    /** Read the latest value
+      @param   value  receives the value.
+      @return  version of the value.
+
+      @note You may call this function from ISR context.
+    */
+    uint32_t read(T &value) {
+        while (true) {
+            uint32_t seq = _seq;
+            uint32_t version = seq >> 1;
+            __DMB();
+            value = _value[version & 1];
+            __DMB();
+            // the buffer is written again once version + 2 is started
+            if ((_seq - seq) < (3 - (seq & 1)))
+                return version;
+        }
+    }
+
+    /** Read the latest value
+      @return  the value.
+    */
+    T get() {
+        T value;
+        read(value);
+        return value;
+    }
+
+    /** Read the latest value if it is newer than a known version
+      @param   value    receives the value if it changed.
+      @param   version  version the caller has seen, updated if the value changed.
+      @return  true if the value changed.
+    */
+    bool read_if_changed(T &value, uint32_t &version) {
+        if (!changed_since(version))
+            return false;
+        version = read(value);
+        return true;
+    }
+
+    /** Wait until a new value is published for a subscription of the current thread.
+      @param   subscription  subscription of the current thread.
+      @param   value         receives the value.
+      @param   millisec      timeout value or 0 in case of no time-out. (default: osWaitForever).
+      @return  true if a new value was read, false in case of a timeout.
+    */
+    bool wait(TopicSubscription &subscription, T &value, uint32_t millisec=osWaitForever) {
+        if (!wait_changed(subscription, millisec))
+            return false;
+        subscription.version = read(value);
+        return true;
+    }
+
+private:
+    T _value[2];
+};
+
+}
+
+#endif
@@ -0,0 +1,153 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef VALUE_QUEUE_H
+#define VALUE_QUEUE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "cmsis.h"
+#include "cmsis_os.h"
+#include "us_ticker_api.h"
+#include "Semaphore.h"
+
+namespace rtos {
+
+/** The ValueQueue class sends small values between threads and interrupt service routines.
+ Unlike Queue, which carries pointers, the values are copied into a ring inside the queue,
+ so a sample of a few words needs no MemoryPool allocation and no free on the receiving side.
+ T has to be trivially copyable (a plain struct), values are copied with memcpy.
+  @tparam  T         data type of a single message element, at most ValueQueue::max_value_size bytes.
+  @tparam  queue_sz  maximum number of messages in queue.
+*/
+template<typename T, uint32_t queue_sz>
+class ValueQueue {
+public:
+    /** Largest value that can be queued, it is copied with interrupts disabled */
+    static const uint32_t max_value_size = 32;
+
+    /** Create and initialise a ValueQueue. */
+    ValueQueue() : _head(0), _tail(0), _count(0), _put_waiters(0), _items(0), _spaces(0) {
+    }
+
+    /** Put a value in the queue.
+      @param   value     value to copy into the queue.
+      @param   millisec  timeout value or 0 in case of no time-out. (default: 0).
+      @return  status code that indicates the execution status of the function.
+
+      @note You may call this function from ISR context if the millisec parameter is set to 0.
+    */
+    osStatus put(const T &value, uint32_t millisec=0) {
+        bool isr = __get_IPSR() != 0;
+        if (isr && (millisec != 0))
+            return osErrorParameter;
+
+        uint32_t start_us = us_ticker_read();
+        while (true) {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            if (_count < queue_sz) {
+                memcpy(&_ring[_tail], &value, sizeof(T));
+                _tail = (_tail + 1) % queue_sz;
+                _count++;
+                __set_PRIMASK(primask);
+                _items.release();
+                return osOK;
+            }
+            if (millisec != 0) {
+                _put_waiters++;
+            }
+            __set_PRIMASK(primask);
+
+            if (millisec == 0)
+                return osErrorResource;
+
+            uint32_t timeout = osWaitForever;
+            if (millisec != osWaitForever) {
+                uint32_t elapsed_ms = (us_ticker_read() - start_us) / 1000;
+                timeout = (elapsed_ms < millisec) ? (millisec - elapsed_ms) : 0;
+            }
+            // a slot freed by get may still be taken by an ISR first, so test again after the wait
+            int32_t tokens = (timeout != 0) ? _spaces.wait(timeout) : 0;
+
+            primask = __get_PRIMASK();
+            __disable_irq();
+            _put_waiters--;
+            __set_PRIMASK(primask);
+
+            if (tokens <= 0)
+                return osEventTimeout;
+        }
+    }
+
+    /** Get a value or wait for a value from the queue.
+      @param   value     receives the value.
+      @param   millisec  timeout value or 0 in case of no time-out. (default: osWaitForever).
+      @return  osOK when a value was received, osEventTimeout otherwise.
+    */
+    osStatus get(T &value, uint32_t millisec=osWaitForever) {
+        // every queued value holds a token, so the ring is never empty after a successful wait
+        if (_items.wait(millisec) <= 0)
+            return osEventTimeout;
+
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        memcpy(&value, &_ring[_head], sizeof(T));
+        _head = (_head + 1) % queue_sz;
+        _count--;
+        bool wake = _put_waiters != 0;
+        __set_PRIMASK(primask);
+
+        if (wake) {
+            _spaces.release();
+        }
+        return osOK;
+    }
+
+    /** Get the number of queued values
+      @return  number of values in the queue.
+    */
+    uint32_t count() {
+        return _count;
+    }
+
+private:
+    typedef char value_size_check[(sizeof(T) <= max_value_size) ? 1 : -1];
+    typedef char queue_size_check[(queue_sz > 0) ? 1 : -1];
+
+    /* one queue slot, word aligned */
+    struct Slot {
+        uint32_t data[(sizeof(T) + 3) / 4];
+    };
+
+    Slot _ring[queue_sz];
+    uint32_t _head;
+    uint32_t _tail;
+    volatile uint32_t _count;
+    volatile uint32_t _put_waiters;
+    Semaphore _items;
+    Semaphore _spaces;
+};
+
+}
+
+#endif
@@ -26,9 +26,23 @@
 #include "Mutex.h"
 #include "RtosTimer.h"
 #include "Semaphore.h"
+#include "RWLock.h"
 #include "Mail.h"
+#include "MailBox.h"
 #include "MemoryPool.h"
 #include "Queue.h"
+#include "ValueQueue.h"
+#include "CoopScheduler.h"
+#include "TTExecutive.h"
+#include "ChainStage.h"
+#include "TaskWatchdog.h"
+#include "RateMonotonic.h"
+#include "EventFlags.h"
+#include "EventQueue.h"
+#include "Topic.h"
+#include "RateTransition.h"
+#include "AgeMonitor.h"
+#include "BitFlag.h"
 
 using namespace rtos;
 
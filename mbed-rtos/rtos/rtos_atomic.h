@@ -0,0 +1,87 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef RTOS_ATOMIC_H
+#define RTOS_ATOMIC_H
+
+#include <stdint.h>
+#include "cmsis.h"
+
+namespace rtos {
+
+/** Atomically replace a value if it still holds the expected value.
+  @param   ptr       value to update.
+  @param   expected  value ptr has to hold.
+  @param   desired   new value.
+  @return  true if ptr held expected and was replaced.
+
+  @note You may call this function from ISR context.
+*/
+inline bool atomic_cas(volatile uint32_t *ptr, uint32_t expected, uint32_t desired) {
+#if (__CORTEX_M >= 0x03)
+    do {
+        if (__LDREXW(ptr) != expected) {
+            __CLREX();
+            return false;
+        }
+    } while (__STREXW(desired, ptr) != 0);
+    __DMB();
+    return true;
+#else
+    bool swapped = false;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (*ptr == expected) {
+        *ptr = desired;
+        swapped = true;
+    }
+    __set_PRIMASK(primask);
+    return swapped;
+#endif
+}
+
+/** Atomically add to a value.
+  @param   ptr    value to update.
+  @param   delta  amount to add.
+  @return  new value.
+
+  @note You may call this function from ISR context.
+*/
+inline uint32_t atomic_add(volatile uint32_t *ptr, uint32_t delta) {
+#if (__CORTEX_M >= 0x03)
+    uint32_t value;
+    do {
+        value = __LDREXW(ptr) + delta;
+    } while (__STREXW(value, ptr) != 0);
+    __DMB();
+    return value;
+#else
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t value = (*ptr += delta);
+    __set_PRIMASK(primask);
+    return value;
+#endif
+}
+
+}
+
+#endif
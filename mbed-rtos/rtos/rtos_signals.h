@@ -0,0 +1,36 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef RTOS_SIGNALS_H
+#define RTOS_SIGNALS_H
+
+/* Signal flags reserved by the rtos classes. Each class uses its flag on the thread it
+ runs on or wakes up, so a thread that uses one of these classes must not use the same
+ flag itself; the flags 0x0001 - 0x03FF are left to the application. */
+
+#define RTOS_SIGNAL_CHAIN_STAGE     0x0400  /* ChainStage::signal_flag */
+#define RTOS_SIGNAL_WAIT_US         0x0800  /* Thread::wait_us_flag */
+#define RTOS_SIGNAL_EVENT_QUEUE     0x1000  /* EventQueue::signal_flag */
+#define RTOS_SIGNAL_EVENT_FLAGS     0x2000  /* EventFlags::signal_flag */
+#define RTOS_SIGNAL_TT_EXECUTIVE    0x4000  /* TTExecutive::signal_flag */
+#define RTOS_SIGNAL_COOP_SCHEDULER  0x8000  /* CoopScheduler::signal_flag */
+
+#endif
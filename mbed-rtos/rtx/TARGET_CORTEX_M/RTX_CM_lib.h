@@ -48,7 +48,7 @@
  *      Definitions
  *---------------------------------------------------------------------------*/
 
-#define _declare_box(pool,size,cnt)  uint32_t pool[(((size)+3)/4)*(cnt) + 3]
+#define _declare_box(pool,size,cnt)  uint32_t pool[(((size)+3)/4)*(cnt) + 4]
 #define _declare_box8(pool,size,cnt) uint64_t pool[(((size)+7)/8)*(cnt) + 2]
 
 #define OS_TCB_SIZE     48
@@ -94,6 +94,8 @@ uint16_t const os_maxtaskrun = OS_TASK_CNT;
 uint32_t const os_rrobin     = (OS_ROBIN << 16) | OS_ROBINTOUT;
 uint32_t const os_trv        = OS_TRV;
 uint8_t  const os_flags      = OS_RUNPRIV;
+uint8_t  const os_edf        = OS_EDF;
+uint8_t  const os_stkguard   = OS_STKGUARD;
 
 /* Export following defines to uVision debugger. */
 __USED uint32_t const os_clockrate = OS_TICK;
@@ -142,6 +144,15 @@ osMessageQId osMessageQId_osTimerMessageQ;
  void rt_stk_check  (void) {;}
 #endif
 
+#if OS_STKGUARD == 0
+ void rt_stk_guard  (void) {;}
+#else
+ void MemManage_Handler (void) {
+   /* The running thread (os_tsk.run) has written into its stack guard. */
+   os_error (1);                      /* OS_ERR_STK_OVF */
+ }
+#endif
+
 
 /*----------------------------------------------------------------------------
  *      Standard Library multithreading interface
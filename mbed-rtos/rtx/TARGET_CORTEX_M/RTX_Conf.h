@@ -40,7 +40,7 @@
 
 /* Definitions */
 #define BOX_ALIGN_8                   0x80000000
-#define _declare_box(pool,size,cnt)   U32 pool[(((size)+3)/4)*(cnt) + 3]
+#define _declare_box(pool,size,cnt)   U32 pool[(((size)+3)/4)*(cnt) + 4]
 #define _declare_box8(pool,size,cnt)  U64 pool[(((size)+7)/8)*(cnt) + 2]
 #define _init_box8(pool,size,bsize)   _init_box (pool,size,(bsize) | BOX_ALIGN_8)
 
@@ -54,6 +54,8 @@ extern U16 const os_maxtaskrun;
 extern U32 const os_trv;
 extern U8  const os_flags;
 extern U32 const os_rrobin;
+extern U8  const os_edf;
+extern U8  const os_stkguard;
 extern U32 const os_clockrate;
 extern U32 const os_timernum;
 extern U16 const idle_task_stack_size;
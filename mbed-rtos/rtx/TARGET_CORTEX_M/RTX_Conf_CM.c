@@ -47,13 +47,15 @@
 //   <o>Number of concurrent running threads <0-250>
 //   <i> Defines max. number of threads that will run at the same time.
 //       counting "main", but not counting "osTimerThread"
+//   <i> Each entry only costs a pointer in 'os_active_TCB', the thread
+//   <i> control blocks and stacks are owned by the Thread objects.
 //   <i> Default: 6
 #ifndef OS_TASKCNT
 #  if   defined(TARGET_LPC1768) || defined(TARGET_LPC2368)   || defined(TARGET_LPC4088) || defined(TARGET_LPC4088_DM) || defined(TARGET_LPC4330) || defined(TARGET_LPC4337) || defined(TARGET_LPC1347) || defined(TARGET_K64F) || defined(TARGET_STM32F401RE)\
    || defined(TARGET_STM32F410RB) || defined(TARGET_KL46Z) || defined(TARGET_KL43Z)  || defined(TARGET_STM32F407) || defined(TARGET_F407VG)  || defined(TARGET_STM32F303VC) || defined(TARGET_LPC1549) || defined(TARGET_LPC11U68) \
    || defined(TARGET_STM32F411RE) || defined(TARGET_STM32F405RG) || defined(TARGET_K22F) || defined(TARGET_STM32F429ZI) || defined(TARGET_STM32F401VC) || defined(TARGET_MAX32610) || defined(TARGET_MAX32600) || defined(TARGET_TEENSY3_1) \
    || defined(TARGET_STM32L152RE) || defined(TARGET_STM32F446RE) || defined(TARGET_STM32F446VE) || defined(TARGET_STM32L476VG) || defined(TARGET_STM32L476RG) || defined(TARGET_STM32F469NI) || defined(TARGET_STM32F746NG) || defined(TARGET_STM32F746ZG) || defined(TARGET_STM32L152RC)
-#    define OS_TASKCNT         14
+#    define OS_TASKCNT         32
 #  elif defined(TARGET_LPC11U24) || defined(TARGET_STM32F303RE) || defined(TARGET_STM32F303K8) || defined(TARGET_LPC11U35_401)  || defined(TARGET_LPC11U35_501) || defined(TARGET_LPCCAPPUCCINO) || defined(TARGET_LPC1114) \
    || defined(TARGET_LPC812)   || defined(TARGET_KL25Z)         || defined(TARGET_KL26Z)         || defined(TARGET_KL05Z)        || defined(TARGET_STM32F100RB)  || defined(TARGET_STM32F051R8) \
    || defined(TARGET_STM32F103RB) || defined(TARGET_LPC824) || defined(TARGET_STM32F302R8) || defined(TARGET_STM32F334R8) || defined(TARGET_STM32F334C8) \
@@ -97,11 +99,24 @@
  #define OS_TIMERSTKSZ  WORDS_STACK_SIZE
 #endif
 
+// <q>Guard thread stacks with the MPU
+// <i> Makes the lowest 32 bytes of the stack of the running thread read-only,
+// <i> so a stack overflow faults at the writing instruction (MemManage fault).
+// <i> The guard is moved on each task switch and replaces the stack check.
+// <i> Needs privileged threads, the default memory map of the MPU only applies to them.
+#ifndef OS_STKGUARD
+ #define OS_STKGUARD    0
+#endif
+
 // <q>Check for stack overflow
 // <i> Includes the stack checking code for stack overflow.
 // <i> Note that additional code reduces the Kernel performance.
 #ifndef OS_STKCHECK
- #define OS_STKCHECK    1
+ #if OS_STKGUARD
+  #define OS_STKCHECK   0
+ #else
+  #define OS_STKCHECK   1
+ #endif
 #endif
 
 // <o>Processor mode for thread execution
@@ -112,6 +127,10 @@
  #define OS_RUNPRIV     1
 #endif
 
+#if OS_STKGUARD && !OS_RUNPRIV
+ #error "OS_STKGUARD needs OS_RUNPRIV, unprivileged threads fault outside the MPU regions"
+#endif
+
 // </h>
 // <h>SysTick Timer Configuration
 // ==============================
@@ -242,6 +261,14 @@
 
 // </e>
 
+// <q>Earliest Deadline First scheduling
+// <i> Threads of the same priority which have a period set with
+// <i> osThreadSetPeriod run in order of their absolute deadlines.
+// <i> Deadline misses are counted whether this is enabled or not.
+#ifndef OS_EDF
+ #define OS_EDF         0
+#endif
+
 // <e>User Timers
 // ==============
 //   <i> Enables user Timers
@@ -123,10 +123,17 @@ __asm void SVC_Handler (void) {
         IMPORT  SVC_Count
         IMPORT  SVC_Table
         IMPORT  rt_stk_check
+        IMPORT  rt_stk_guard
 
         MRS     R0,PSP                  ; Read PSP
         LDR     R1,[R0,#24]             ; Read Saved PC from Stack
         LDRB    R1,[R1,#-2]             ; Load SVC Number
+
+        LDR     R2,=__cpp(&os_stat.svc_calls)
+        LDR     R3,[R2]
+        ADD     R3,R3,#1                ; os_stat.svc_calls++
+        STR     R3,[R2]
+
         CBNZ    R1,SVC_User
 
         LDM     R0,{R0-R3,R12}          ; Read R0-R3,R12 from stack
@@ -149,6 +156,10 @@ __asm void SVC_Handler (void) {
         POP     {R2,R3}
 
 SVC_Next
+        PUSH    {R2,R3}
+        BL      rt_stk_guard            ; Guard the Stack of os_tsk.new
+        POP     {R2,R3}
+
         STR     R2,[R3]                 ; os_tsk.run = os_tsk.new
 
         LDR     R12,[R2,#TCB_TSTACK]    ; os_tsk.new->tsk_stack
@@ -202,6 +213,7 @@ Sys_Switch
 
         PUSH    {R2,R3}
         BL      rt_stk_check            ; Check for Stack overflow
+        BL      rt_stk_guard            ; Guard the Stack of os_tsk.new
         POP     {R2,R3}
 
         STR     R2,[R3]                 ; os_tsk.run = os_tsk.new
@@ -305,6 +305,23 @@ typedef struct  {
   } def;                               ///< event definition
 } osEvent;
 
+/// Kernel statistics, all counters wrap around.
+/// The idle time is sampled by the kernel itself: every SysTick which interrupts the idle
+/// thread counts one tick, and a tickless sleep counts its length when the scheduler resumes.
+/// A thread which runs between two ticks without being interrupted is not seen, so the idle
+/// time is an estimate for short threads.
+/// rtos_attach_idle_hook is not used, so the idle hook remains free for the application.
+/// \note RTX extension: counted from reset.
+typedef struct  {
+  uint32_t               switches;     ///< number of thread switches
+  uint32_t              svc_calls;     ///< number of service calls from threads, RTX and user SVC functions
+  uint32_t           isr_requests;     ///< number of service requests posted by ISRs
+  uint32_t             idle_ticks;     ///< system ticks spent in the idle thread
+  uint32_t                  ticks;     ///< system ticks since the kernel started
+  uint16_t          isr_queue_max;     ///< high-water mark of the ISR request queue
+  uint16_t         isr_queue_size;     ///< size of the ISR request queue (OS_FIFOSZ)
+} osKernelStats;
+
 
 //  ==== Kernel Control Functions ====
 
@@ -323,6 +340,12 @@ osStatus osKernelStart (void);
 /// \return 0 RTOS is not started, 1 RTOS is started.
 int32_t osKernelRunning(void);
 
+/// Get a snapshot of the kernel statistics.
+/// \param[out]    stats         statistics of the kernel.
+/// \return status code that indicates the execution status of the function.
+/// \note RTX extension: may be called from Interrupt Service Routines.
+osStatus osKernelGetStats (osKernelStats *stats);
+
 
 //  ==== Thread Management ====
 
@@ -385,6 +408,25 @@ osStatus osThreadSetPriority (osThreadId thread_id, osPriority priority);
 /// \note MUST REMAIN UNCHANGED: \b osThreadGetPriority shall be consistent in every CMSIS-RTOS.
 osPriority osThreadGetPriority (osThreadId thread_id);
 
+/// Set release period and relative deadline of an active thread, the current release starts now.
+/// \param[in]     thread_id     thread ID obtained by \ref osThreadCreate or \ref osThreadGetId.
+/// \param[in]     period        release period in millisec, 0 removes the period (max 60000).
+/// \param[in]     deadline      deadline relative to each release in millisec, 0 for the period.
+/// \return status code that indicates the execution status of the function.
+/// \note RTX extension: with OS_EDF threads of the same priority run in deadline order.
+osStatus osThreadSetPeriod (osThreadId thread_id, uint32_t period, uint32_t deadline);
+
+/// Complete the current release of the running thread and wait for its next release.
+/// \return status code that indicates the execution status of the function.
+/// \note RTX extension: a release completed after its deadline counts as a deadline miss.
+osStatus osThreadWaitPeriod (void);
+
+/// Get the number of deadlines missed by an active thread.
+/// \param[in]     thread_id     thread ID obtained by \ref osThreadCreate or \ref osThreadGetId.
+/// \return number of missed deadlines.
+/// \note RTX extension.
+uint32_t osThreadGetDeadlineMisses (osThreadId thread_id);
+
 
 //  ==== Generic Wait Functions ====
 
@@ -601,7 +643,7 @@ osStatus osSemaphoreDelete (osSemaphoreId semaphore_id);
 extern osPoolDef_t os_pool_def_##name
 #else                            // define the object
 #define osPoolDef(name, no, type)   \
-uint32_t os_pool_m_##name[3+((sizeof(type)+3)/4)*(no)]; \
+uint32_t os_pool_m_##name[4+((sizeof(type)+3)/4)*(no)]; \
 osPoolDef_t os_pool_def_##name = \
 { (no), sizeof(type), (os_pool_m_##name) }
 #endif
@@ -638,6 +680,13 @@ void *osPoolCAlloc (osPoolId pool_id);
 /// \note MUST REMAIN UNCHANGED: \b osPoolFree shall be consistent in every CMSIS-RTOS.
 osStatus osPoolFree (osPoolId pool_id, void *block);
 
+/// Get the number of allocated blocks of a memory pool.
+/// \param[in]     pool_id       memory pool ID obtain referenced with \ref osPoolCreate.
+/// \param[out]    max_used      high-water mark of the allocated blocks, or NULL.
+/// \return number of allocated blocks.
+/// \note RTX extension: may be called from Interrupt Service Routines.
+uint32_t osPoolGetUsage (osPoolId pool_id, uint32_t *max_used);
+
 #endif   // Memory Pool Management available
 
 
@@ -709,7 +758,7 @@ extern osMailQDef_t os_mailQ_def_##name
 #else                            // define the object
 #define osMailQDef(name, queue_sz, type) \
 uint32_t os_mailQ_q_##name[4+(queue_sz)]; \
-uint32_t os_mailQ_m_##name[3+((sizeof(type)+3)/4)*(queue_sz)]; \
+uint32_t os_mailQ_m_##name[4+((sizeof(type)+3)/4)*(queue_sz)]; \
 void *   os_mailQ_p_##name[2] = { (os_mailQ_q_##name), os_mailQ_m_##name }; \
 osMailQDef_t os_mailQ_def_##name =  \
 { (queue_sz), sizeof(type), (os_mailQ_p_##name) }
@@ -764,6 +813,13 @@ os_InRegs osEvent osMailGet (osMailQId queue_id, uint32_t millisec);
 /// \note MUST REMAIN UNCHANGED: \b osMailFree shall be consistent in every CMSIS-RTOS.
 osStatus osMailFree (osMailQId queue_id, void *mail);
 
+/// Get the number of allocated memory blocks of a mail queue.
+/// \param[in]     queue_id      mail queue ID obtained with \ref osMailCreate.
+/// \param[out]    max_used      high-water mark of the allocated blocks, or NULL.
+/// \return number of allocated blocks.
+/// \note RTX extension: may be called from Interrupt Service Routines.
+uint32_t osMailGetUsage (osMailQId queue_id, uint32_t *max_used);
+
 #endif  // Mail Queues available
 
 
@@ -46,6 +46,13 @@ typedef struct OS_TCB {
 
   /* Task entry point used for uVision debugger                              */
   FUNCP  ptask;                   /* Task entry address                      */
+
+  /* Periodic release and deadline, used by EDF scheduling (OS_EDF)          */
+  U32    period;                  /* Release period in ticks, 0=none         */
+  U32    rel_deadline;            /* Deadline relative to the release        */
+  U32    release;                 /* Time of the current release             */
+  U32    deadline;                /* Absolute deadline of current release    */
+  U32    dl_miss;                 /* Number of missed deadlines              */
 } *P_TCB;
 
 #endif
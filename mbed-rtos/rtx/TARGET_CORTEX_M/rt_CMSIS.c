@@ -146,6 +146,7 @@ typedef uint32_t __attribute__((vector_size(16))) ret128;
 
 #define RET_pointer    __r0
 #define RET_int32_t    __r0
+#define RET_uint32_t   __r0
 #define RET_osStatus   __r0
 #define RET_osPriority __r0
 #define RET_osEvent    {(osStatus)__r0, {(uint32_t)__r1}, {(void *)__r2}}
@@ -515,6 +516,21 @@ int32_t osKernelRunning(void) {
   }
 }
 
+/// Get a snapshot of the kernel statistics
+osStatus osKernelGetStats (osKernelStats *stats) {
+  if (stats == NULL) return osErrorParameter;
+
+  stats->switches       = os_stat.switches;
+  stats->svc_calls      = os_stat.svc_calls;
+  stats->isr_requests   = os_stat.isr_requests;
+  stats->idle_ticks     = os_stat.idle_ticks;
+  stats->ticks          = os_time;
+  stats->isr_queue_max  = (uint16_t)os_stat.psq_max;
+  stats->isr_queue_size = os_psq->size;
+
+  return osOK;
+}
+
 
 // ==== Thread Management ====
 
@@ -527,6 +543,9 @@ SVC_1_1(svcThreadTerminate,   osStatus,   osThreadId,                  RET_osSta
 SVC_0_1(svcThreadYield,       osStatus,                                RET_osStatus)
 SVC_2_1(svcThreadSetPriority, osStatus,   osThreadId,      osPriority, RET_osStatus)
 SVC_1_1(svcThreadGetPriority, osPriority, osThreadId,                  RET_osPriority)
+SVC_3_1(svcThreadSetPeriod,   osStatus,   osThreadId, uint32_t, uint32_t, RET_osStatus)
+SVC_0_1(svcThreadWaitPeriod,  osStatus,                                RET_osStatus)
+SVC_1_1(svcThreadGetDeadlineMisses, uint32_t, osThreadId,              RET_uint32_t)
 
 // Thread Service Calls
 extern OS_TID rt_get_TID (void);
@@ -554,6 +573,11 @@ osThreadId svcThreadCreate (osThreadDef_t *thread_def, void *argument) {
   task_context->priv_stack = thread_def->stacksize;
   /* Find a free entry in 'os_active_TCB' table. */
   OS_TID tsk = rt_get_TID ();
+  if (tsk == 0) {
+    /* All 'os_active_TCB' entries are in use (see OS_TASKCNT). */
+    sysThreadError(osErrorNoMemory);
+    return NULL;
+  }
   os_active_TCB[tsk-1] = task_context;
   task_context->task_id = tsk;
   /* Pass parameter 'argv' to 'rt_init_context' */
@@ -634,6 +658,43 @@ osPriority svcThreadGetPriority (osThreadId thread_id) {
   return (osPriority)(ptcb->prio - 1 + osPriorityIdle);
 }
 
+/// Set release period and relative deadline of an active thread
+osStatus svcThreadSetPeriod (osThreadId thread_id, uint32_t period, uint32_t deadline) {
+  P_TCB    ptcb;
+  uint32_t period_ticks, deadline_ticks;
+
+  ptcb = rt_tid2ptcb(thread_id);                // Get TCB pointer
+  if (ptcb == NULL) return osErrorParameter;
+
+  if (deadline == 0) deadline = period;
+  if ((deadline > period) || (period > 60000)) return osErrorValue;
+
+  period_ticks   = (period != 0) ? rt_ms2tick(period) : 0;
+  deadline_ticks = (period != 0) ? rt_ms2tick(deadline) : 0;
+  rt_period_set(ptcb, period_ticks, deadline_ticks);
+
+  return osOK;
+}
+
+/// Wait for the next periodic release of the running thread
+osStatus svcThreadWaitPeriod (void) {
+  if (os_tsk.run->period == 0) return osErrorResource;
+
+  rt_period_wait();                             // Wait for next release
+
+  return osOK;
+}
+
+/// Get number of missed deadlines of an active thread
+uint32_t svcThreadGetDeadlineMisses (osThreadId thread_id) {
+  P_TCB ptcb;
+
+  ptcb = rt_tid2ptcb(thread_id);                // Get TCB pointer
+  if (ptcb == NULL) return 0;
+
+  return ptcb->dl_miss;
+}
+
 
 // Thread Public API
 
@@ -678,6 +739,24 @@ osPriority osThreadGetPriority (osThreadId thread_id) {
   return __svcThreadGetPriority(thread_id);
 }
 
+/// Set release period and relative deadline of an active thread
+osStatus osThreadSetPeriod (osThreadId thread_id, uint32_t period, uint32_t deadline) {
+  if (__get_IPSR() != 0) return osErrorISR;     // Not allowed in ISR
+  return __svcThreadSetPeriod(thread_id, period, deadline);
+}
+
+/// Wait for the next periodic release of the running thread
+osStatus osThreadWaitPeriod (void) {
+  if (__get_IPSR() != 0) return osErrorISR;     // Not allowed in ISR
+  return __svcThreadWaitPeriod();
+}
+
+/// Get number of missed deadlines of an active thread
+uint32_t osThreadGetDeadlineMisses (osThreadId thread_id) {
+  if (__get_IPSR() != 0) return 0;              // Not allowed in ISR
+  return __svcThreadGetDeadlineMisses(thread_id);
+}
+
 /// INTERNAL - Not Public
 /// Auto Terminate Thread on exit (used implicitly when thread exists)
 __NO_RETURN void osThreadExit (void) {
@@ -1259,6 +1338,54 @@ osStatus svcMutexDelete (osMutexId mutex_id) {
 }
 
 
+// Mutex Fast Path
+
+#if (__CORTEX_M >= 0x03)
+/// Lock a free Mutex in thread mode without a service call
+/// \return __FALSE if the Mutex is owned and the kernel has to handle the request
+static __INLINE BOOL fastMutexWait (P_MUCB p_MCB) {
+  P_TCB run  = os_tsk.run;
+  U8    prio = run->prio;
+
+  do {
+    if (__LDREXW((volatile uint32_t *)&p_MCB->owner) != 0) {
+      __CLREX();
+      return __FALSE;                           // Owned, maybe by this thread
+    }
+  } while (__STREXW((uint32_t)run, (volatile uint32_t *)&p_MCB->owner) != 0);
+  __DMB();
+
+  // A thread which waits in between sees the new owner and blocks
+  p_MCB->prio  = prio;
+  p_MCB->level = 1;
+  return __TRUE;
+}
+
+/// Release a Mutex in thread mode without a service call
+/// \return __FALSE if a thread waits or the priority was raised and the kernel has to handle the request
+static __INLINE BOOL fastMutexRelease (P_MUCB p_MCB) {
+  P_TCB run = os_tsk.run;
+
+  if ((p_MCB->owner != run) || (p_MCB->level != 1) || (run->prio != p_MCB->prio)) {
+    return __FALSE;
+  }
+
+  p_MCB->level = 0;
+  __DMB();
+  // Any exception between LDREX and STREX makes the STREX fail
+  __LDREXW((volatile uint32_t *)&p_MCB->owner);
+  __DMB();
+  if ((p_MCB->p_lnk != NULL) || (run->prio != p_MCB->prio) ||
+      (__STREXW(0, (volatile uint32_t *)&p_MCB->owner) != 0)) {
+    __CLREX();
+    p_MCB->level = 1;
+    return __FALSE;
+  }
+  return __TRUE;
+}
+#endif
+
+
 // Mutex Public API
 
 /// Create and Initialize a Mutex object
@@ -1274,13 +1401,29 @@ osMutexId osMutexCreate (osMutexDef_t *mutex_def) {
 
 /// Wait until a Mutex becomes available
 osStatus osMutexWait (osMutexId mutex_id, uint32_t millisec) {
+  P_MUCB mut;
+
   if (__get_IPSR() != 0) return osErrorISR;     // Not allowed in ISR
+#if (__CORTEX_M >= 0x03)
+  mut = rt_id2obj(mutex_id);
+  if (os_running && (mut != NULL) && (mut->cb_type == MUCB) && fastMutexWait(mut)) {
+    return osOK;                                // Uncontended
+  }
+#endif
   return __svcMutexWait(mutex_id, millisec);
 }
 
 /// Release a Mutex that was obtained with osMutexWait
 osStatus osMutexRelease (osMutexId mutex_id) {
+  P_MUCB mut;
+
   if (__get_IPSR() != 0) return osErrorISR;     // Not allowed in ISR
+#if (__CORTEX_M >= 0x03)
+  mut = rt_id2obj(mutex_id);
+  if (os_running && (mut != NULL) && (mut->cb_type == MUCB) && fastMutexRelease(mut)) {
+    return osOK;                                // Uncontended
+  }
+#endif
   return __svcMutexRelease(mutex_id);
 }
 
@@ -1398,6 +1541,43 @@ static __INLINE osStatus isrSemaphoreRelease (osSemaphoreId semaphore_id) {
 }
 
 
+// Semaphore Fast Path
+
+#if (__CORTEX_M >= 0x03)
+/// Take an available token in thread mode without a service call
+/// \return number of tokens before the call, 0 if the kernel has to handle the request
+static __INLINE int32_t fastSemaphoreWait (P_SCB p_SCB) {
+  U16 tokens;
+
+  do {
+    tokens = __LDREXH((volatile uint16_t *)&p_SCB->tokens);
+    if (tokens == 0) {
+      __CLREX();
+      return 0;
+    }
+  } while (__STREXH(tokens - 1, (volatile uint16_t *)&p_SCB->tokens) != 0);
+  return tokens;
+}
+
+/// Return a token in thread mode without a service call
+/// \return __FALSE if a thread waits or the count is at its limit and the kernel has to handle the request
+static __INLINE BOOL fastSemaphoreRelease (P_SCB p_SCB) {
+  U16 tokens;
+
+  do {
+    // Any exception between LDREX and STREX makes the STREX fail
+    tokens = __LDREXH((volatile uint16_t *)&p_SCB->tokens);
+    __DMB();
+    if ((p_SCB->p_lnk != NULL) || (tokens == osFeature_Semaphore)) {
+      __CLREX();
+      return __FALSE;
+    }
+  } while (__STREXH(tokens + 1, (volatile uint16_t *)&p_SCB->tokens) != 0);
+  return __TRUE;
+}
+#endif
+
+
 // Semaphore Public API
 
 /// Create and Initialize a Semaphore object
@@ -1413,7 +1593,19 @@ osSemaphoreId osSemaphoreCreate (osSemaphoreDef_t *semaphore_def, int32_t count)
 
 /// Wait until a Semaphore becomes available
 int32_t osSemaphoreWait (osSemaphoreId semaphore_id, uint32_t millisec) {
+#if (__CORTEX_M >= 0x03)
+  P_SCB   sem;
+  int32_t tokens;
+#endif
+
   if (__get_IPSR() != 0) return -1;             // Not allowed in ISR
+#if (__CORTEX_M >= 0x03)
+  sem = rt_id2obj(semaphore_id);
+  if (os_running && (sem != NULL) && (sem->cb_type == SCB)) {
+    tokens = fastSemaphoreWait(sem);
+    if (tokens != 0) return tokens;             // Token was available
+  }
+#endif
   return __svcSemaphoreWait(semaphore_id, millisec);
 }
 
@@ -1422,6 +1614,12 @@ osStatus osSemaphoreRelease (osSemaphoreId semaphore_id) {
   if (__get_IPSR() != 0) {                      // in ISR
     return   isrSemaphoreRelease(semaphore_id);
   } else {                                      // in Thread
+#if (__CORTEX_M >= 0x03)
+    P_SCB sem = rt_id2obj(semaphore_id);
+    if (os_running && (sem != NULL) && (sem->cb_type == SCB) && fastSemaphoreRelease(sem)) {
+      return osOK;                              // No thread waiting
+    }
+#endif
     return __svcSemaphoreRelease(semaphore_id);
   }
 }
@@ -1542,6 +1740,18 @@ osStatus osPoolFree (osPoolId pool_id, void *block) {
   }
 }
 
+/// Get the number of allocated blocks of a memory pool
+uint32_t osPoolGetUsage (osPoolId pool_id, uint32_t *max_used) {
+  uint32_t usage;
+
+  usage = (pool_id != NULL) ? ((P_BM)pool_id)->usage : 0;
+  if (max_used != NULL) {
+    *max_used = usage >> 16;
+  }
+
+  return usage & 0xFFFF;
+}
+
 
 // ==== Message Queue Management Functions ====
 
@@ -1857,6 +2067,15 @@ osStatus osMailFree (osMailQId queue_id, void *mail) {
   }
 }
 
+/// Get the number of allocated memory blocks of a mail queue
+uint32_t osMailGetUsage (osMailQId queue_id, uint32_t *max_used) {
+  void *pool;
+
+  pool = (queue_id != NULL) ? *(((void **)queue_id) + 1) : NULL;
+
+  return osPoolGetUsage(pool, max_used);
+}
+
 /// Put a mail to a queue
 osStatus osMailPut (osMailQId queue_id, void *mail) {
   if (queue_id == NULL) return osErrorParameter;
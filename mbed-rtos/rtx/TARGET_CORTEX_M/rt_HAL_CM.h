@@ -81,8 +81,6 @@ __attribute__((always_inline)) static inline U32 __disable_irq(void)
   return(result & 1);
 }
 
-#endif
-
 __attribute__(( always_inline)) static inline U8 __clz(U32 value)
 {
   U8 result;
@@ -91,6 +89,8 @@ __attribute__(( always_inline)) static inline U8 __clz(U32 value)
   return(result);
 }
 
+#endif
+
 #elif defined (__ICCARM__)      /* IAR Compiler */
 
 #undef  __USE_EXCLUSIVE_ACCESS
@@ -152,6 +152,13 @@ static inline U8 __clz(U32 value)
 #define NVIC_AIR_CTRL   (*((volatile U32 *)0xE000ED0C))
 #define NVIC_SYS_PRI2   (*((volatile U32 *)0xE000ED1C))
 #define NVIC_SYS_PRI3   (*((volatile U32 *)0xE000ED20))
+#define NVIC_SYS_HND_CTRL (*((volatile U32 *)0xE000ED24))
+
+/* MPU registers */
+#define MPU_CTRL        (*((volatile U32 *)0xE000ED94))
+#define MPU_RNR         (*((volatile U32 *)0xE000ED98))
+#define MPU_RBAR        (*((volatile U32 *)0xE000ED9C))
+#define MPU_RASR        (*((volatile U32 *)0xE000EDA0))
 
 #define OS_PEND_IRQ()   NVIC_INT_CTRL  = (1<<28)
 #define OS_PENDING      ((NVIC_INT_CTRL >> 26) & (1<<2 | 1))
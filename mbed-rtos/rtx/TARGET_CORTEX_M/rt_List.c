@@ -71,7 +71,8 @@ void rt_put_prio (P_XCB p_CB, P_TCB p_task) {
   prio = p_task->prio;
   p_CB2 = p_CB->p_lnk;
   /* Search for an entry in the list */
-  while (p_CB2 != NULL && prio <= p_CB2->prio) {
+  while (p_CB2 != NULL && ((os_edf && !sem_mbx) ? !rt_rdy_before (p_task, p_CB2)
+                                                : (prio <= p_CB2->prio))) {
     p_CB = (P_XCB)p_CB2;
     p_CB2 = p_CB2->p_lnk;
   }
@@ -90,6 +91,25 @@ void rt_put_prio (P_XCB p_CB, P_TCB p_task) {
 }
 
 
+/*--------------------------- rt_rdy_before ---------------------------------*/
+
+BOOL rt_rdy_before (P_TCB p_a, P_TCB p_b) {
+  /* Return __TRUE if task "p_a" has to run before task "p_b": it has a     */
+  /* higher priority or, with EDF scheduling, the same priority and an      */
+  /* earlier deadline. Tasks without a period run after tasks with one.     */
+  if (p_a->prio != p_b->prio) {
+    return (p_a->prio > p_b->prio);
+  }
+  if ((os_edf == 0) || (p_a->period == 0)) {
+    return (__FALSE);
+  }
+  if (p_b->period == 0) {
+    return (__TRUE);
+  }
+  return ((S32)(p_a->deadline - p_b->deadline) < 0);
+}
+
+
 /*--------------------------- rt_get_first ----------------------------------*/
 
 P_TCB rt_get_first (P_XCB p_CB) {
@@ -124,6 +144,22 @@ void rt_put_rdy_first (P_TCB p_task) {
 }
 
 
+/*--------------------------- rt_put_rdy_preempted --------------------------*/
+
+void rt_put_rdy_preempted (P_TCB p_task) {
+  /* Put the preempted running task "p_task" back into the ready list. It   */
+  /* continues first within its priority; with EDF scheduling only as long  */
+  /* as no ready task has an earlier deadline, its own deadline may have    */
+  /* moved while it was running.                                            */
+  if (os_edf && os_rdy.p_lnk && rt_rdy_before (os_rdy.p_lnk, p_task)) {
+    rt_put_prio (&os_rdy, p_task);
+  }
+  else {
+    rt_put_rdy_first (p_task);
+  }
+}
+
+
 /*--------------------------- rt_get_same_rdy_prio --------------------------*/
 
 P_TCB rt_get_same_rdy_prio (void) {
@@ -307,6 +343,10 @@ void rt_psq_enq (OS_ID entry, U32 arg) {
   if (idx < os_psq->size) {
     os_psq->q[idx].id  = entry;
     os_psq->q[idx].arg = arg;
+    rt_inc (&os_stat.isr_requests);
+    if (os_psq->count > os_stat.psq_max) {
+      os_stat.psq_max = os_psq->count;
+    }
   }
   else {
     os_error (OS_ERR_FIFO_OVF);
@@ -38,6 +38,27 @@
 #include "rt_MemBox.h"
 #include "rt_HAL_CM.h"
 
+/*----------------------------------------------------------------------------
+ *      Local Functions
+ *---------------------------------------------------------------------------*/
+
+/*--------------------------- rt_box_usage ----------------------------------*/
+
+static __inline U32 rt_box_usage (U32 usage, BIT alloc) {
+  /* Return "usage" updated for one allocated or freed memory block. */
+  U32 used = usage & 0xFFFF;
+  U32 max  = usage >> 16;
+
+  if (alloc) {
+    if (++used > max) max = used;
+  }
+  else if (used) {
+    used--;
+  }
+  return ((max << 16) | used);
+}
+
+
 /*----------------------------------------------------------------------------
  *      Global Functions
  *---------------------------------------------------------------------------*/
@@ -75,6 +96,7 @@ int _init_box  (void *box_mem, U32 box_size, U32 blk_size) {
   end = ((U8 *) box_mem) + box_size;
   ((P_BM) box_mem)->end      = end;
   ((P_BM) box_mem)->blk_size = blk_size;
+  ((P_BM) box_mem)->usage    = 0;
 
   /* Link all free blocks using offsets. */
   end = ((U8 *) end) - blk_size;
@@ -101,6 +123,7 @@ void *rt_alloc_box (void *box_mem) {
   free = ((P_BM) box_mem)->free;
   if (free) {
     ((P_BM) box_mem)->free = *free;
+    ((P_BM) box_mem)->usage = rt_box_usage (((P_BM) box_mem)->usage, __TRUE);
   }
   if (!irq_dis) __enable_irq ();
 #else
@@ -110,6 +133,10 @@ void *rt_alloc_box (void *box_mem) {
       break;
     }
   } while (__strex((U32)*free, &((P_BM) box_mem)->free));
+  if (free) {
+    while (__strex (rt_box_usage (__ldrex(&((P_BM) box_mem)->usage), __TRUE),
+                    &((P_BM) box_mem)->usage));
+  }
 #endif
   return (free);
 }
@@ -151,11 +178,14 @@ int rt_free_box (void *box_mem, void *box) {
   irq_dis = __disable_irq ();
   *((void **)box) = ((P_BM) box_mem)->free;
   ((P_BM) box_mem)->free = box;
+  ((P_BM) box_mem)->usage = rt_box_usage (((P_BM) box_mem)->usage, __FALSE);
   if (!irq_dis) __enable_irq ();
 #else
   do {
     *((void **)box) = (void *)__ldrex(&((P_BM) box_mem)->free);
   } while (__strex ((U32)box, &((P_BM) box_mem)->free));
+  while (__strex (rt_box_usage (__ldrex(&((P_BM) box_mem)->usage), __FALSE),
+                  &((P_BM) box_mem)->usage));
 #endif
   return (0);
 }
@@ -84,7 +84,7 @@ OS_RESULT rt_mut_delete (OS_ID mutex) {
     rt_put_prio (&os_rdy, p_TCB);
   }
 
-  if (os_rdy.p_lnk && (os_rdy.p_lnk->prio > os_tsk.run->prio)) {
+  if (os_rdy.p_lnk && rt_rdy_before (os_rdy.p_lnk, os_tsk.run)) {
     /* preempt running task */
     rt_put_prio (&os_rdy, os_tsk.run);
     os_tsk.run->state = READY;
@@ -127,12 +127,13 @@ OS_RESULT rt_mut_release (OS_ID mutex) {
     p_MCB->level     = 1;
     p_MCB->owner     = p_TCB;
     p_MCB->prio      = p_TCB->prio;
-    /* Priority inversion, check which task continues. */
-    if (os_tsk.run->prio >= rt_rdy_prio()) {
+    /* Priority inversion, check which task continues. With EDF scheduling  */
+    /* a ready task of the same priority may have an earlier deadline.      */
+    if (!rt_rdy_before (os_rdy.p_lnk, os_tsk.run)) {
       rt_dispatch (p_TCB);
     }
     else {
-      /* Ready task has higher priority than running task. */
+      /* Ready task has to run before running task. */
       rt_put_prio (&os_rdy, os_tsk.run);
       rt_put_prio (&os_rdy, p_TCB);
       os_tsk.run->state = READY;
@@ -141,8 +142,10 @@ OS_RESULT rt_mut_release (OS_ID mutex) {
     }
   }
   else {
+    /* Mutex is free, 'owner' is tested by the lock fast path in rt_CMSIS.c */
+    p_MCB->owner = NULL;
     /* Check if own priority raised by priority inversion. */
-    if (rt_rdy_prio() > os_tsk.run->prio) {
+    if (rt_rdy_before (os_rdy.p_lnk, os_tsk.run)) {
       rt_put_prio (&os_rdy, os_tsk.run);
       os_tsk.run->state = READY;
       rt_dispatch (NULL);
@@ -158,7 +161,7 @@ OS_RESULT rt_mut_wait (OS_ID mutex, U16 timeout) {
   /* Wait for a mutex, continue when mutex is free. */
   P_MUCB p_MCB = mutex;
 
-  if (p_MCB->level == 0) {
+  if (p_MCB->owner == NULL) {
     p_MCB->owner = os_tsk.run;
     p_MCB->prio  = os_tsk.run->prio;
     goto inc;
@@ -174,7 +177,7 @@ inc:p_MCB->level++;
   }
   /* Raise the owner task priority if lower than current priority. */
   /* This priority inversion is called priority inheritance.       */
-  if (p_MCB->prio < os_tsk.run->prio) {
+  if (p_MCB->owner->prio < os_tsk.run->prio) {
     p_MCB->owner->prio = os_tsk.run->prio;
     rt_resort_prio (p_MCB->owner);
   }
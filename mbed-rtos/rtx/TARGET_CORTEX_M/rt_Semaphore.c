@@ -75,7 +75,7 @@ OS_RESULT rt_sem_delete (OS_ID semaphore) {
     rt_put_prio (&os_rdy, p_TCB);
   }
 
-  if (os_rdy.p_lnk && (os_rdy.p_lnk->prio > os_tsk.run->prio)) {
+  if (os_rdy.p_lnk && rt_rdy_before (os_rdy.p_lnk, os_tsk.run)) {
     /* preempt running task */
     rt_put_prio (&os_rdy, os_tsk.run);
     os_tsk.run->state = READY;
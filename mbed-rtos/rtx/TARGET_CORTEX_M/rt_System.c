@@ -49,6 +49,7 @@
  *---------------------------------------------------------------------------*/
 
 int os_tick_irqn;
+struct OS_STAT os_stat;
 
 /*----------------------------------------------------------------------------
  *      Local Variables
@@ -99,8 +100,11 @@ void rt_resume (U32 sleep_time) {
   P_TCB next;
   U32   delta;
 
+  /* The idle demon slept for the whole time. */
+  os_stat.idle_ticks += sleep_time;
+
   os_tsk.run->state = READY;
-  rt_put_rdy_first (os_tsk.run);
+  rt_put_rdy_preempted (os_tsk.run);
 
   os_robin.task = NULL;
 
@@ -207,7 +211,7 @@ void rt_pop_req (void) {
   U32  idx;
 
   os_tsk.run->state = READY;
-  rt_put_rdy_first (os_tsk.run);
+  rt_put_rdy_preempted (os_tsk.run);
 
   idx = os_psq->last;
   while (os_psq->count) {
@@ -258,8 +262,13 @@ void rt_systick (void) {
   /* Check for system clock update, suspend running task. */
   P_TCB next;
 
+  /* Sample the idle time. */
+  if (os_tsk.run == &os_idle_TCB) {
+    os_stat.idle_ticks++;
+  }
+
   os_tsk.run->state = READY;
-  rt_put_rdy_first (os_tsk.run);
+  rt_put_rdy_preempted (os_tsk.run);
 
   /* Check Round Robin timeout. */
   rt_chk_robin ();
@@ -293,6 +302,36 @@ __weak void rt_stk_check (void) {
     }
 }
 
+/*--------------------------- rt_stk_guard_init -----------------------------*/
+
+void rt_stk_guard_init (void) {
+  /* Enable the MPU with the default memory map and the MemManage fault. */
+  MPU_RNR  = STK_GUARD_REGION;
+  MPU_RASR = 0;
+  MPU_CTRL = 0x05;                    /* PRIVDEFENA | ENABLE                   */
+  NVIC_SYS_HND_CTRL |= (1 << 16);     /* MEMFAULTENA                           */
+}
+
+/*--------------------------- rt_stk_guard ----------------------------------*/
+__weak void rt_stk_guard (void) {
+  /* Move the stack guard region to the bottom of the next task's stack. */
+  P_TCB p_new = os_tsk.new_tsk;
+  U32 base;
+
+  /* The main thread has no stack bottom of its own: it ends at the heap. */
+  base = 0;
+  if (p_new->task_id != 0x01) {
+    base = rt_stk_guard_base ((U32)p_new->stack, p_new->priv_stack);
+  }
+  if (base == 0) {
+    MPU_RNR  = STK_GUARD_REGION;
+    MPU_RASR = 0;
+    return;
+  }
+  MPU_RBAR = base | 0x10 | STK_GUARD_REGION;   /* VALID | REGION           */
+  MPU_RASR = STK_GUARD_RASR;
+}
+
 /*----------------------------------------------------------------------------
  * end of file
  *---------------------------------------------------------------------------*/
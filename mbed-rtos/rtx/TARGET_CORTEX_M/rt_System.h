@@ -35,6 +35,7 @@
 /* Variables */
 #define os_psq  ((P_PSQ)&os_fifo)
 extern int os_tick_irqn;
+extern struct OS_STAT os_stat;
 
 /* Functions */
 extern U32  rt_suspend    (void);
@@ -45,6 +46,28 @@ extern void rt_psh_req    (void);
 extern void rt_pop_req    (void);
 extern void rt_systick    (void);
 extern void rt_stk_check  (void);
+extern void rt_stk_guard  (void);
+extern void rt_stk_guard_init (void);
+
+/* Stack guard */
+#define STK_GUARD_REGION  7           /* Highest priority MPU region           */
+#define STK_GUARD_SIZE    32          /* Smallest MPU region                   */
+#define STK_GUARD_RASR   ((1 << 28) | /* XN                                    */ \
+                          (6 << 24) | /* AP: read-only                         */ \
+                          (1 << 19) | /* TEX=1 C=1 B=1: normal memory, as SRAM */ \
+                          (1 << 17) | \
+                          (1 << 16) | \
+                          (4 << 1)  | /* SIZE: 2^(4+1) = 32 bytes              */ \
+                          1)          /* ENABLE                                */
+
+__inline static U32 rt_stk_guard_base (U32 stack, U32 size) {
+  /* Base of the guard region of a stack, 0 if the stack is too small.       */
+  /* The guard is aligned inside the stack, so it never covers foreign data. */
+  if (size < 4*STK_GUARD_SIZE) {
+    return (0);
+  }
+  return ((stack + (STK_GUARD_SIZE-1)) & ~(STK_GUARD_SIZE-1));
+}
 
 /*----------------------------------------------------------------------------
  * end of file
@@ -97,6 +97,11 @@ void rt_init_context (P_TCB p_TCB, U8 priority, FUNCP task_body) {
   p_TCB->events  = 0;
   p_TCB->waits   = 0;
   p_TCB->stack_frame = 0;
+  p_TCB->period  = 0;
+  p_TCB->rel_deadline = 0;
+  p_TCB->release = 0;
+  p_TCB->deadline = 0;
+  p_TCB->dl_miss = 0;
 
   rt_init_stack (p_TCB, task_body);
 }
@@ -106,6 +111,9 @@ void rt_init_context (P_TCB p_TCB, U8 priority, FUNCP task_body) {
 
 void rt_switch_req (P_TCB p_new) {
   /* Switch to next task (identified by "p_new"). */
+  if (p_new != os_tsk.run) {
+    os_stat.switches++;
+  }
   os_tsk.new_tsk   = p_new;
   p_new->state = RUNNING;
   DBG_TASK_SWITCH(p_new->task_id);
@@ -124,9 +132,9 @@ void rt_dispatch (P_TCB next_TCB) {
   }
   else {
     /* Check which task continues */
-    if (next_TCB->prio > os_tsk.run->prio) {
+    if (rt_rdy_before (next_TCB, os_tsk.run)) {
       /* preempt running task */
-      rt_put_rdy_first (os_tsk.run);
+      rt_put_rdy_preempted (os_tsk.run);
       os_tsk.run->state = READY;
       rt_switch_req (next_TCB);
     }
@@ -307,6 +315,11 @@ void rt_sys_init (FUNCP first_task, U32 prio_stksz, void *stk) {
   /* Intitialize SVC and PendSV */
   rt_svc_init ();
 
+  /* Guard the thread stacks with the MPU */
+  if (os_stkguard) {
+    rt_stk_guard_init ();
+  }
+
 #ifndef __CMSIS_RTOS
   /* Intitialize and start system clock timer */
   os_tick_irqn = os_tick_init ();
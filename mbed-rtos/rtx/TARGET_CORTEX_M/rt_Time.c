@@ -34,6 +34,7 @@
 
 #include "rt_TypeDef.h"
 #include "RTX_Conf.h"
+#include "rt_List.h"
 #include "rt_Task.h"
 #include "rt_Time.h"
 
@@ -88,6 +89,54 @@ void rt_itv_wait (void) {
   }
 }
 
+
+/*--------------------------- rt_period_set ---------------------------------*/
+
+void rt_period_set (P_TCB p_task, U32 period, U32 deadline) {
+  /* Set release period and relative deadline of a task, the current       */
+  /* release starts now. A period of 0 removes the deadline of the task.   */
+  p_task->period       = period;
+  p_task->rel_deadline = deadline;
+  p_task->release      = os_time;
+  p_task->deadline     = os_time + deadline;
+  if ((p_task != os_tsk.run) && (p_task->state == READY)) {
+    /* Deadline of a ready task has changed */
+    rt_resort_prio (p_task);
+  }
+}
+
+
+/*--------------------------- rt_period_wait --------------------------------*/
+
+void rt_period_wait (void) {
+  /* Complete the current release of the running task and wait for the     */
+  /* next one. Completion after the deadline counts as a deadline miss,     */
+  /* releases whose deadline already passed are skipped and counted too.   */
+  P_TCB p_task = os_tsk.run;
+  U32 delay;
+
+  if ((S32)(os_time - p_task->deadline) > 0) {
+    p_task->dl_miss++;
+  }
+  p_task->release += p_task->period;
+  while ((S32)(os_time - (p_task->release + p_task->rel_deadline)) > 0) {
+    p_task->dl_miss++;
+    p_task->release += p_task->period;
+  }
+  p_task->deadline = p_task->release + p_task->rel_deadline;
+
+  if ((S32)(p_task->release - os_time) > 0) {
+    delay = p_task->release - os_time;
+    rt_block ((U16)delay, WAIT_DLY);
+  }
+  else if (os_rdy.p_lnk && rt_rdy_before (os_rdy.p_lnk, p_task)) {
+    /* Next release is due already, but a ready task has an earlier deadline */
+    rt_put_prio (&os_rdy, p_task);
+    p_task->state = READY;
+    rt_dispatch (NULL);
+  }
+}
+
 /*----------------------------------------------------------------------------
  * end of file
  *---------------------------------------------------------------------------*/
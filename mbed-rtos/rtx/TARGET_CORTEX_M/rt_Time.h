@@ -40,6 +40,8 @@ extern U32  rt_time_get (void);
 extern void rt_dly_wait (U16 delay_time);
 extern void rt_itv_set  (U16 interval_time);
 extern void rt_itv_wait (void);
+extern void rt_period_set  (P_TCB p_task, U32 period, U32 deadline);
+extern void rt_period_wait (void);
 
 /*----------------------------------------------------------------------------
  * end of file
@@ -118,8 +118,17 @@ typedef struct OS_BM {
   void *free;                     /* Pointer to first free memory block      */
   void *end;                      /* Pointer to memory block end             */
   U32  blk_size;                  /* Memory block size                       */
+  U32  usage;                     /* Blocks in use (lo), high-water (hi)     */
 } *P_BM;
 
+typedef struct OS_STAT {          /* Kernel Statistics                       */
+  U32  switches;                  /* Number of task switches                 */
+  U32  svc_calls;                 /* Number of SVC calls, RTX and user       */
+  U32  isr_requests;              /* Number of ISR post service requests     */
+  U32  idle_ticks;                /* System ticks spent in the idle demon    */
+  U32  psq_max;                   /* Post service queue high-water mark      */
+} *P_STAT;
+
 /* Definitions */
 #define __TRUE          1
 #define __FALSE         0
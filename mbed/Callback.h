@@ -0,0 +1,381 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_CALLBACK_H
+#define MBED_CALLBACK_H
+
+#include <stdint.h>
+#include <new>
+
+namespace mbed {
+
+/** A class for storing and calling any callable object without using the heap
+ *
+ *  Besides static and member functions, a Callback stores function objects with state
+ *  (for example a struct holding the pin to toggle) by value in a buffer of N bytes inside
+ *  the Callback. A function object that does not fit does not compile.
+ *
+ *  A Callback<void(), N> can be attached wherever a member function is accepted:
+ *  @code
+ *  Toggle toggle(&led);
+ *  Callback<void()> cb(toggle);
+ *  ticker.attach(&cb, &Callback<void()>::call, 0.5);
+ *  @endcode
+ *
+ *  @tparam Sig function type, R() or R(A1)
+ *  @tparam N size of the inline storage in bytes, by default enough for an object and a member function
+ */
+template <typename Sig, uint32_t N = 4 * sizeof(void*)>
+class Callback;
+
+/** A Callback taking one argument (R (A1))
+ */
+template <typename R, typename A1, uint32_t N>
+class Callback<R(A1), N> {
+public:
+    /** Create a Callback, attaching a static function
+     *
+     *  @param function The static function to attach (default is none)
+     */
+    Callback(R (*function)(A1) = 0) : _ops(0) {
+        attach(function);
+    }
+
+    /** Create a Callback, attaching a member function
+     *
+     *  @param object The object pointer to invoke the member function on (i.e. the this pointer)
+     *  @param member The address of the member function to attach
+     */
+    template<typename T>
+    Callback(T *object, R (T::*member)(A1)) : _ops(0) {
+        attach(object, member);
+    }
+
+    /** Create a Callback, storing a copy of a function object
+     *
+     *  @param function The function object to store
+     */
+    template<typename F>
+    Callback(const F &function) : _ops(0) {
+        attach(function);
+    }
+
+    Callback(const Callback &other) : _ops(0) {
+        *this = other;
+    }
+
+    Callback &operator=(const Callback &other) {
+        if (this != &other) {
+            clear();
+            if (other._ops) {
+                other._ops->copy(_storage.buffer, other._storage.buffer);
+                _ops = other._ops;
+            }
+        }
+        return *this;
+    }
+
+    ~Callback() {
+        clear();
+    }
+
+    /** Attach a static function
+     *
+     *  @param function The static function to attach (default is none)
+     */
+    void attach(R (*function)(A1)) {
+        clear();
+        if (function) {
+            store(function);
+        }
+    }
+
+    /** Attach a member function
+     *
+     *  @param object The object pointer to invoke the member function on (i.e. the this pointer)
+     *  @param member The address of the member function to attach
+     */
+    template<typename T>
+    void attach(T *object, R (T::*member)(A1)) {
+        clear();
+        if (object && member) {
+            store(MemberCaller<T>(object, member));
+        }
+    }
+
+    /** Store a copy of a function object
+     *
+     *  @param function The function object to store
+     */
+    template<typename F>
+    void attach(const F &function) {
+        clear();
+        store(function);
+    }
+
+    /** Remove the attached function
+     */
+    void clear() {
+        if (_ops) {
+            _ops->destroy(_storage.buffer);
+            _ops = 0;
+        }
+    }
+
+    /** Check if a function is attached
+     */
+    bool attached() const {
+        return _ops != 0;
+    }
+
+    /** Call the attached function
+     */
+    R call(A1 a) {
+        if (_ops) {
+            return _ops->call(_storage.buffer, a);
+        }
+        return R();
+    }
+
+#ifdef MBED_OPERATORS
+    R operator ()(A1 a) {
+        return call(a);
+    }
+    operator bool(void) const {
+        return attached();
+    }
+#endif
+private:
+    template<typename T>
+    struct MemberCaller {
+        MemberCaller(T *o, R (T::*m)(A1)) : object(o), member(m) {
+        }
+        R operator ()(A1 a) {
+            return (object->*member)(a);
+        }
+        T *object;
+        R (T::*member)(A1);
+    };
+
+    struct Ops {
+        R (*call)(void *storage, A1 a);
+        void (*copy)(void *storage, const void *other);
+        void (*destroy)(void *storage);
+    };
+
+    template<typename F>
+    struct OpsFor {
+        typedef char storage_size_check[(sizeof(F) <= N) ? 1 : -1];
+
+        static R call(void *storage, A1 a) {
+            return (*static_cast<F*>(storage))(a);
+        }
+        static void copy(void *storage, const void *other) {
+            new (storage) F(*static_cast<const F*>(other));
+        }
+        static void destroy(void *storage) {
+            static_cast<F*>(storage)->~F();
+        }
+        static const Ops *ops() {
+            static const Ops table = { &call, &copy, &destroy };
+            return &table;
+        }
+    };
+
+    template<typename F>
+    void store(const F &function) {
+        new (_storage.buffer) F(function);
+        _ops = OpsFor<F>::ops();
+    }
+
+    union {
+        char buffer[N];
+        void *align_pointer;
+        uint64_t align_word;
+    } _storage;
+    const Ops *_ops;
+};
+
+/** A Callback taking no argument (R ())
+ */
+template <typename R, uint32_t N>
+class Callback<R(), N> {
+public:
+    /** Create a Callback, attaching a static function
+     *
+     *  @param function The static function to attach (default is none)
+     */
+    Callback(R (*function)(void) = 0) : _ops(0) {
+        attach(function);
+    }
+
+    /** Create a Callback, attaching a member function
+     *
+     *  @param object The object pointer to invoke the member function on (i.e. the this pointer)
+     *  @param member The address of the member function to attach
+     */
+    template<typename T>
+    Callback(T *object, R (T::*member)(void)) : _ops(0) {
+        attach(object, member);
+    }
+
+    /** Create a Callback, storing a copy of a function object
+     *
+     *  @param function The function object to store
+     */
+    template<typename F>
+    Callback(const F &function) : _ops(0) {
+        attach(function);
+    }
+
+    Callback(const Callback &other) : _ops(0) {
+        *this = other;
+    }
+
+    Callback &operator=(const Callback &other) {
+        if (this != &other) {
+            clear();
+            if (other._ops) {
+                other._ops->copy(_storage.buffer, other._storage.buffer);
+                _ops = other._ops;
+            }
+        }
+        return *this;
+    }
+
+    ~Callback() {
+        clear();
+    }
+
+    /** Attach a static function
+     *
+     *  @param function The static function to attach (default is none)
+     */
+    void attach(R (*function)(void)) {
+        clear();
+        if (function) {
+            store(function);
+        }
+    }
+
+    /** Attach a member function
+     *
+     *  @param object The object pointer to invoke the member function on (i.e. the this pointer)
+     *  @param member The address of the member function to attach
+     */
+    template<typename T>
+    void attach(T *object, R (T::*member)(void)) {
+        clear();
+        if (object && member) {
+            store(MemberCaller<T>(object, member));
+        }
+    }
+
+    /** Store a copy of a function object
+     *
+     *  @param function The function object to store
+     */
+    template<typename F>
+    void attach(const F &function) {
+        clear();
+        store(function);
+    }
+
+    /** Remove the attached function
+     */
+    void clear() {
+        if (_ops) {
+            _ops->destroy(_storage.buffer);
+            _ops = 0;
+        }
+    }
+
+    /** Check if a function is attached
+     */
+    bool attached() const {
+        return _ops != 0;
+    }
+
+    /** Call the attached function
+     */
+    R call() {
+        if (_ops) {
+            return _ops->call(_storage.buffer);
+        }
+        return R();
+    }
+
+#ifdef MBED_OPERATORS
+    R operator ()(void) {
+        return call();
+    }
+    operator bool(void) const {
+        return attached();
+    }
+#endif
+private:
+    template<typename T>
+    struct MemberCaller {
+        MemberCaller(T *o, R (T::*m)(void)) : object(o), member(m) {
+        }
+        R operator ()(void) {
+            return (object->*member)();
+        }
+        T *object;
+        R (T::*member)(void);
+    };
+
+    struct Ops {
+        R (*call)(void *storage);
+        void (*copy)(void *storage, const void *other);
+        void (*destroy)(void *storage);
+    };
+
+    template<typename F>
+    struct OpsFor {
+        typedef char storage_size_check[(sizeof(F) <= N) ? 1 : -1];
+
+        static R call(void *storage) {
+            return (*static_cast<F*>(storage))();
+        }
+        static void copy(void *storage, const void *other) {
+            new (storage) F(*static_cast<const F*>(other));
+        }
+        static void destroy(void *storage) {
+            static_cast<F*>(storage)->~F();
+        }
+        static const Ops *ops() {
+            static const Ops table = { &call, &copy, &destroy };
+            return &table;
+        }
+    };
+
+    template<typename F>
+    void store(const F &function) {
+        new (_storage.buffer) F(function);
+        _ops = OpsFor<F>::ops();
+    }
+
+    union {
+        char buffer[N];
+        void *align_pointer;
+        uint64_t align_word;
+    } _storage;
+    const Ops *_ops;
+};
+
+} // namespace mbed
+
+#endif
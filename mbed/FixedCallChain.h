@@ -0,0 +1,209 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_FIXEDCALLCHAIN_H
+#define MBED_FIXEDCALLCHAIN_H
+
+#include "Callback.h"
+
+namespace mbed {
+
+/** A CallChain with a fixed capacity which never uses the heap
+ *
+ *  The functions are kept as Callback objects in an array inside the chain, so
+ *  adding a function never allocates and function objects with state can be added.
+ *  Adding to a full chain fails and returns NULL.
+ *
+ *  @tparam Capacity maximum number of functions in the chain
+ *  @tparam N size of the inline storage of each function in bytes
+ */
+template <uint32_t Capacity, uint32_t N = 4 * sizeof(void*)>
+class FixedCallChain {
+public:
+    typedef Callback<void(), N> callback_t;
+    typedef callback_t* pCallback_t;
+
+    /** Create an empty chain
+     */
+    FixedCallChain() : _size(0) {
+    }
+
+    /** Add a function at the end of the chain
+     *  @param function A pointer to a void function
+     *  @returns
+     *  The function object created for 'function', NULL if the chain is full
+     */
+    pCallback_t add(void (*function)(void)) {
+        return common_add(callback_t(function));
+    }
+
+    /** Add a function at the end of the chain
+     *  @param tptr pointer to the object to call the member function on
+     *  @param mptr pointer to the member function to be called
+     *  @returns
+     *  The function object created for 'tptr' and 'mptr', NULL if the chain is full
+     */
+    template<typename T>
+    pCallback_t add(T *tptr, void (T::*mptr)(void)) {
+        return common_add(callback_t(tptr, mptr));
+    }
+
+    /** Add a copy of a function object at the end of the chain
+     *  @param function the function object
+     *  @returns
+     *  The function object created for 'function', NULL if the chain is full
+     */
+    template<typename F>
+    pCallback_t add(const F &function) {
+        return common_add(callback_t(function));
+    }
+
+    /** Add a function at the beginning of the chain
+     *  @param function A pointer to a void function
+     *  @returns
+     *  The function object created for 'function', NULL if the chain is full
+     */
+    pCallback_t add_front(void (*function)(void)) {
+        return common_add_front(callback_t(function));
+    }
+
+    /** Add a function at the beginning of the chain
+     *  @param tptr pointer to the object to call the member function on
+     *  @param mptr pointer to the member function to be called
+     *  @returns
+     *  The function object created for 'tptr' and 'mptr', NULL if the chain is full
+     */
+    template<typename T>
+    pCallback_t add_front(T *tptr, void (T::*mptr)(void)) {
+        return common_add_front(callback_t(tptr, mptr));
+    }
+
+    /** Add a copy of a function object at the beginning of the chain
+     *  @param function the function object
+     *  @returns
+     *  The function object created for 'function', NULL if the chain is full
+     */
+    template<typename F>
+    pCallback_t add_front(const F &function) {
+        return common_add_front(callback_t(function));
+    }
+
+    /** Get the number of functions in the chain
+     */
+    int size() const {
+        return _size;
+    }
+
+    /** Get a function object from the chain
+     *  @param i function object index
+     *  @returns
+     *  The function object at position 'i' in the chain, NULL if there is none
+     */
+    pCallback_t get(int i) {
+        if (i < 0 || i >= _size) {
+            return NULL;
+        }
+        return &_chain[i];
+    }
+
+    /** Look for a function object in the call chain
+     *  @param f the function object to search
+     *  @returns
+     *  The index of the function object if found, -1 otherwise.
+     */
+    int find(pCallback_t f) const {
+        for (int i = 0; i < _size; i++) {
+            if (f == &_chain[i]) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /** Clear the call chain (remove all functions in the chain).
+     */
+    void clear() {
+        for (int i = 0; i < _size; i++) {
+            _chain[i].clear();
+        }
+        _size = 0;
+    }
+
+    /** Remove a function object from the chain, later function objects move down by one
+     *  @arg f the function object to remove
+     *  @returns
+     *  true if the function object was found and removed, false otherwise.
+     */
+    bool remove(pCallback_t f) {
+        int i = find(f);
+        if (i < 0) {
+            return false;
+        }
+        for (; i < _size - 1; i++) {
+            _chain[i] = _chain[i + 1];
+        }
+        _chain[--_size].clear();
+        return true;
+    }
+
+    /** Call all the functions in the chain in sequence
+     */
+    void call() {
+        for (int i = 0; i < _size; i++) {
+            _chain[i].call();
+        }
+    }
+
+#ifdef MBED_OPERATORS
+    void operator ()(void) {
+        call();
+    }
+    pCallback_t operator [](int i) {
+        return get(i);
+    }
+#endif
+
+private:
+    pCallback_t common_add(const callback_t &callback) {
+        if (_size >= (int)Capacity) {
+            return NULL;
+        }
+        _chain[_size] = callback;
+        return &_chain[_size++];
+    }
+
+    pCallback_t common_add_front(const callback_t &callback) {
+        if (_size >= (int)Capacity) {
+            return NULL;
+        }
+        for (int i = _size; i > 0; i--) {
+            _chain[i] = _chain[i - 1];
+        }
+        _chain[0] = callback;
+        _size++;
+        return &_chain[0];
+    }
+
+    callback_t _chain[Capacity];
+    int _size;
+
+    /* disallow copy constructor and assignment operators */
+    FixedCallChain(const FixedCallChain&);
+    FixedCallChain & operator = (const FixedCallChain&);
+};
+
+} // namespace mbed
+
+#endif
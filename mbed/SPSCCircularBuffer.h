@@ -0,0 +1,218 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_SPSCCIRCULARBUFFER_H
+#define MBED_SPSCCIRCULARBUFFER_H
+
+#include <stdint.h>
+#include "cmsis.h"
+
+namespace mbed {
+
+/** Lock-free circular buffer for one producer and one consumer
+ *
+ *  The producer (for example an ISR) only writes the head index and the consumer
+ *  (for example a thread) only writes the tail index, so neither side has to disable
+ *  interrupts. The indices run freely and are masked with BufferSize - 1, which must be
+ *  a power of two; all BufferSize elements can be used.
+ *
+ *  Unlike CircularBuffer, a push to a full buffer fails instead of overwriting the
+ *  oldest element, since the producer must not move the consumer's index.
+ *  Contiguous spans of the storage can be filled or drained directly, for example by DMA.
+ */
+template<typename T, uint32_t BufferSize>
+class SPSCCircularBuffer {
+public:
+    SPSCCircularBuffer() : _head(0), _tail(0) {
+    }
+
+    /** Push an element to the buffer (producer)
+     *
+     * @param data Data to be pushed to the buffer
+     * @return True if the element was pushed, false if the buffer is full
+     */
+    bool push(const T& data) {
+        uint32_t head = _head;
+        if ((head - _tail) == BufferSize) {
+            return false;
+        }
+        _pool[head & Mask] = data;
+        // the element is written before the consumer can see it
+        __DMB();
+        _head = head + 1;
+        return true;
+    }
+
+    /** Push several elements to the buffer (producer)
+     *
+     * @param data Elements to be pushed to the buffer
+     * @param count Number of elements
+     * @return Number of elements pushed, less than count if the buffer became full
+     */
+    uint32_t push(const T *data, uint32_t count) {
+        uint32_t head = _head;
+        uint32_t space = BufferSize - (head - _tail);
+        if (count > space) {
+            count = space;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            _pool[(head + i) & Mask] = data[i];
+        }
+        __DMB();
+        _head = head + count;
+        return count;
+    }
+
+    /** Get the largest contiguous free span of the storage (producer)
+     *
+     * @param span Set to the first free element
+     * @return Number of elements that can be written at span
+     */
+    uint32_t write_span(T *&span) {
+        uint32_t head = _head;
+        uint32_t space = BufferSize - (head - _tail);
+        uint32_t index = head & Mask;
+        span = &_pool[index];
+        return (space < BufferSize - index) ? space : BufferSize - index;
+    }
+
+    /** Publish elements written to the span returned by write_span (producer)
+     *
+     * @param count Number of elements written, at most the size of the span
+     */
+    void commit_write(uint32_t count) {
+        __DMB();
+        _head = _head + count;
+    }
+
+    /** Pop an element from the buffer (consumer)
+     *
+     * @param data Receives the element
+     * @return True if the buffer is not empty and data contains an element, false otherwise
+     */
+    bool pop(T& data) {
+        if (!peek(data)) {
+            return false;
+        }
+        // the element is read before the producer can reuse its slot
+        __DMB();
+        _tail = _tail + 1;
+        return true;
+    }
+
+    /** Pop several elements from the buffer (consumer)
+     *
+     * @param data Receives the elements
+     * @param count Maximum number of elements
+     * @return Number of elements popped
+     */
+    uint32_t pop(T *data, uint32_t count) {
+        uint32_t tail = _tail;
+        uint32_t used = _head - tail;
+        __DMB();
+        if (count > used) {
+            count = used;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            data[i] = _pool[(tail + i) & Mask];
+        }
+        __DMB();
+        _tail = tail + count;
+        return count;
+    }
+
+    /** Read the oldest element without removing it (consumer)
+     *
+     * @param data Receives the element
+     * @return True if the buffer is not empty and data contains an element, false otherwise
+     */
+    bool peek(T& data) {
+        uint32_t tail = _tail;
+        if (_head == tail) {
+            return false;
+        }
+        // the head is read before the element it publishes
+        __DMB();
+        data = _pool[tail & Mask];
+        return true;
+    }
+
+    /** Get the largest contiguous span of stored elements (consumer)
+     *
+     * @param span Set to the oldest element
+     * @return Number of elements that can be read at span
+     */
+    uint32_t read_span(const T *&span) {
+        uint32_t tail = _tail;
+        uint32_t used = _head - tail;
+        __DMB();
+        uint32_t index = tail & Mask;
+        span = &_pool[index];
+        return (used < BufferSize - index) ? used : BufferSize - index;
+    }
+
+    /** Remove elements read from the span returned by read_span (consumer)
+     *
+     * @param count Number of elements read, at most the size of the span
+     */
+    void consume(uint32_t count) {
+        __DMB();
+        _tail = _tail + count;
+    }
+
+    /** Check if the buffer is empty
+     *
+     * @return True if the buffer is empty, false if not
+     */
+    bool empty() {
+        return _head == _tail;
+    }
+
+    /** Check if the buffer is full
+     *
+     * @return True if the buffer is full, false if not
+     */
+    bool full() {
+        return (_head - _tail) == BufferSize;
+    }
+
+    /** Get the number of stored elements
+     *
+     * @return Number of elements in the buffer
+     */
+    uint32_t size() {
+        return _head - _tail;
+    }
+
+    /** Reset the buffer, neither side may use it at the same time
+     *
+     */
+    void reset() {
+        _head = 0;
+        _tail = 0;
+    }
+
+private:
+    static const uint32_t Mask = BufferSize - 1;
+    typedef char buffer_size_check[(BufferSize > 0 && (BufferSize & Mask) == 0) ? 1 : -1];
+
+    T _pool[BufferSize];
+    volatile uint32_t _head;
+    volatile uint32_t _tail;
+};
+
+}
+
+#endif
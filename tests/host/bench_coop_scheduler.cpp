@@ -0,0 +1,150 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "host_port.h"
+#include "CoopScheduler.h"
+#include "Semaphore.h"
+#include "Thread.h"
+
+using namespace rtos;
+
+/* 50 tasks pass a token around a ring, once as cooperative tasks and once as threads.
+ A scheduler holds at most 32 tasks, so the cooperative ring is split over two schedulers
+ of 25 tasks, each on its own thread. Host threads are switched by the host kernel, so the
+ ratio of the two costs is what carries over to the target, not the absolute numbers. */
+
+#define TASKS       50
+#define RING        (TASKS / 2)
+#define HANDOFFS    20000
+
+/*--------------------------- Cooperative tasks ----------------------------*/
+
+struct CoopRing;
+
+struct CoopNode {
+    CoopRing *ring;
+    int next;
+};
+
+struct CoopRing {
+    StaticCoopScheduler<RING> scheduler;
+    CoopNode nodes[RING];
+    uint32_t remaining;
+    Semaphore done;
+
+    CoopRing() : remaining(0), done(0) {
+    }
+};
+
+static void coop_step(void const *argument) {
+    const CoopNode *node = (const CoopNode*)argument;
+    CoopRing *ring = node->ring;
+    if (ring->remaining == 0) {
+        ring->done.release();
+        return;
+    }
+    ring->remaining--;
+    ring->scheduler.signal(node->next);
+}
+
+TEST(cooperative_tasks) {
+    static CoopRing rings[2];
+    for (int r = 0; r < 2; r++) {
+        for (int i = 0; i < RING; i++) {
+            rings[r].nodes[i].ring = &rings[r];
+            rings[r].nodes[i].next = (i + 1) % RING;
+            CHECK_EQUAL(i, rings[r].scheduler.add_event(coop_step, 0, &rings[r].nodes[i]));
+        }
+        rings[r].remaining = HANDOFFS / 2;
+    }
+
+    static StaticThread<512> thread0(CoopScheduler::thread, &rings[0].scheduler);
+    static StaticThread<512> thread1(CoopScheduler::thread, &rings[1].scheduler);
+    Thread::wait(10);
+
+    uint64_t start = host_test::now_ns();
+    rings[0].scheduler.signal(0);
+    rings[1].scheduler.signal(0);
+    rings[0].done.wait();
+    rings[1].done.wait();
+    uint64_t elapsed = host_test::now_ns() - start;
+
+    Thread::wait(10);                           // the last steps return after releasing done
+    uint32_t runs = 0;
+    for (int r = 0; r < 2; r++) {
+        for (int i = 0; i < RING; i++)
+            runs += rings[r].scheduler.runs(i);
+    }
+    CHECK_EQUAL(HANDOFFS + 2, runs);
+
+    uint32_t ram = 2 * (sizeof(StaticCoopScheduler<RING>) + StaticThread<512>::ram_size());
+    printf("  %d cooperative tasks: %u bytes (2 schedulers and their threads)\n", TASKS, ram);
+    host_test::report("cooperative task switch", HANDOFFS / 2, elapsed);
+    thread0.terminate();
+    thread1.terminate();
+}
+
+/*--------------------------- Threads --------------------------------------*/
+
+struct ThreadNode {
+    Thread *next;
+};
+
+static ThreadNode thread_nodes[TASKS];
+static Thread *ring_threads[TASKS];
+static volatile uint32_t thread_remaining;
+static Semaphore thread_done(0);
+
+static void thread_step(void const *argument) {
+    const ThreadNode *node = (const ThreadNode*)argument;
+    while (true) {
+        Thread::signal_wait(0x1);
+        if (thread_remaining == 0) {
+            thread_done.release();
+            continue;
+        }
+        thread_remaining--;
+        node->next->signal_set(0x1);
+    }
+}
+
+TEST(threads) {
+    // like raising OS_TASKCNT in RTX_Conf_CM.c, 50 threads and main do not fit in 32 entries
+    host_set_taskcnt(TASKS + 1);
+    for (int i = TASKS - 1; i >= 0; i--) {
+        ring_threads[i] = new StaticThread<256>(thread_step, &thread_nodes[i]);
+        thread_nodes[i].next = ring_threads[(i + 1) % TASKS];
+    }
+    for (int i = 0; i < TASKS; i++)
+        thread_nodes[i].next = ring_threads[(i + 1) % TASKS];
+    thread_remaining = HANDOFFS;
+
+    uint64_t start = host_test::now_ns();
+    ring_threads[0]->signal_set(0x1);
+    thread_done.wait();
+    uint64_t elapsed = host_test::now_ns() - start;
+
+    printf("  %d threads: %u bytes\n", TASKS, (unsigned)(TASKS * StaticThread<256>::ram_size()));
+    host_test::report("thread switch", HANDOFFS, elapsed);
+    for (int i = 0; i < TASKS; i++)
+        delete ring_threads[i];
+}
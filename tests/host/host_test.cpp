@@ -0,0 +1,69 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace host_test {
+
+static TestCase *first;
+static TestCase **last = &first;
+static std::atomic<int> failures(0);
+
+int add(TestCase *test) {
+    *last = test;
+    last = &test->next;
+    return 0;
+}
+
+void fail(const char *file, int line, const char *expression) {
+    fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+    failures++;
+}
+
+void fail_equal(const char *file, int line, const char *expression, long long expected, long long actual) {
+    fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", file, line, expression, actual, expected);
+    failures++;
+}
+
+uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void report(const char *name, uint64_t operations, uint64_t elapsed_ns) {
+    printf("  %-40s %10.1f ns/op\n", name, operations ? (double)elapsed_ns / operations : 0.0);
+}
+
+}
+
+int main() {
+    for (host_test::TestCase *test = host_test::first; test != NULL; test = test->next) {
+        int before = host_test::failures;
+        printf("%s\n", test->name);
+        fflush(stdout);
+        test->function();
+        printf("%s: %s\n", test->name, (host_test::failures == before) ? "ok" : "FAILED");
+    }
+    return host_test::failures;
+}
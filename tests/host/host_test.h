@@ -0,0 +1,69 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+/* Minimal test harness of the host tests: TEST cases run in definition order, a failed
+ CHECK is reported and the case goes on, the exit code is the number of failures. */
+
+#include <stdint.h>
+#include <stdio.h>
+
+namespace host_test {
+
+typedef void (*test_function)();
+
+struct TestCase {
+    const char *name;
+    test_function function;
+    TestCase *next;
+};
+
+int add(TestCase *test);
+void fail(const char *file, int line, const char *expression);
+void fail_equal(const char *file, int line, const char *expression, long long expected, long long actual);
+
+/** Host clock in nanoseconds, for the benchmarks */
+uint64_t now_ns();
+
+/** Print one benchmark result line */
+void report(const char *name, uint64_t operations, uint64_t elapsed_ns);
+
+}
+
+#define TEST(name) \
+    static void name(); \
+    static host_test::TestCase name##_case = { #name, name, 0 }; \
+    static int name##_added = host_test::add(&name##_case); \
+    static void name()
+
+#define CHECK(expression) \
+    do { if (!(expression)) host_test::fail(__FILE__, __LINE__, #expression); } while (0)
+
+#define CHECK_EQUAL(expected, actual) \
+    do { \
+        long long check_expected = (long long)(expected), check_actual = (long long)(actual); \
+        if (check_expected != check_actual) \
+            host_test::fail_equal(__FILE__, __LINE__, #actual, check_expected, check_actual); \
+    } while (0)
+
+#endif
@@ -0,0 +1,79 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef HOST_CMSIS_H
+#define HOST_CMSIS_H
+
+/* Host stand-in for the CMSIS core header of the LPC1768.
+ Interrupt masking is a process wide lock: code under PRIMASK and host "interrupts"
+ (see host_isr_enter) exclude each other as they do on the single core target.
+ LDREX/STREX are emulated with a per thread reservation and a compare on store. */
+
+#include <stdint.h>
+
+#define __CORTEX_M      0x03
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t host_irq_disable(void);
+void     host_irq_enable(void);
+uint32_t host_irq_primask(void);
+uint32_t host_irq_ipsr(void);
+uint32_t host_ldrex(volatile uint32_t *addr);
+uint32_t host_strex(uint32_t value, volatile uint32_t *addr);
+void     host_clrex(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+static inline uint32_t __disable_irq(void)                      { return host_irq_disable(); }
+static inline void     __enable_irq(void)                       { host_irq_enable(); }
+static inline uint32_t __get_PRIMASK(void)                      { return host_irq_primask(); }
+static inline void     __set_PRIMASK(uint32_t primask)          { if (primask & 1) host_irq_disable(); else host_irq_enable(); }
+static inline uint32_t __get_IPSR(void)                         { return host_irq_ipsr(); }
+static inline uint32_t __LDREXW(volatile uint32_t *addr)        { return host_ldrex(addr); }
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t *addr) { return host_strex(value, addr); }
+static inline void     __CLREX(void)                            { host_clrex(); }
+static inline void     __DMB(void)                              { __sync_synchronize(); }
+static inline void     __DSB(void)                              { __sync_synchronize(); }
+static inline void     __ISB(void)                              { __sync_synchronize(); }
+static inline uint8_t  __clz(uint32_t value)                    { return value ? __builtin_clz(value) : 32; }
+
+/* Watchdog registers, only written by TaskWatchdog */
+typedef struct {
+    volatile uint32_t WDMOD;
+    volatile uint32_t WDTC;
+    volatile uint32_t WDFEED;
+    volatile uint32_t WDTV;
+    volatile uint32_t WDCLKSEL;
+} LPC_WDT_TypeDef;
+
+#ifdef __cplusplus
+extern "C" LPC_WDT_TypeDef host_wdt;
+#else
+extern LPC_WDT_TypeDef host_wdt;
+#endif
+#define LPC_WDT (&host_wdt)
+
+#endif
@@ -0,0 +1,299 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* mbed library parts used by the rtos layer: the us_ticker with its event queue,
+ TimerEvent and error(). The us_ticker runs from the host clock, or from a virtual clock
+ moved by the tests; with the host clock a ticker thread runs the due events. */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cmsis.h"
+#include "host_port.h"
+#include "mbed_error.h"
+#include "TimerEvent.h"
+#include "us_ticker_api.h"
+
+/*----------------------------- us_ticker ----------------------------------*/
+
+static std::atomic<bool> ticker_virtual(false);
+static std::atomic<uint32_t> ticker_virtual_us(0);
+
+static std::mutex &ticker_mutex() {
+    static std::mutex *mutex = new std::mutex;
+    return *mutex;
+}
+
+static std::condition_variable &ticker_cond() {
+    static std::condition_variable *cond = new std::condition_variable;
+    return *cond;
+}
+
+static uint32_t ticker_generation;
+
+static uint32_t host_us(void) {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+extern "C" void us_ticker_init(void) {
+}
+
+extern "C" uint32_t us_ticker_read(void) {
+    return ticker_virtual ? ticker_virtual_us.load() : host_us();
+}
+
+extern "C" void us_ticker_set_interrupt(timestamp_t timestamp) {
+    std::lock_guard<std::mutex> guard(ticker_mutex());
+    ticker_generation++;
+    ticker_cond().notify_all();
+}
+
+extern "C" void us_ticker_disable_interrupt(void) {
+}
+
+extern "C" void us_ticker_clear_interrupt(void) {
+}
+
+static const ticker_interface_t us_interface = {
+    us_ticker_init,
+    us_ticker_read,
+    us_ticker_disable_interrupt,
+    us_ticker_clear_interrupt,
+    us_ticker_set_interrupt,
+};
+
+static ticker_event_queue_t us_queue;
+
+static const ticker_data_t us_data = {
+    &us_interface,
+    &us_queue,
+};
+
+static void ticker_main(void);
+
+extern "C" const ticker_data_t *get_us_ticker_data(void) {
+    static std::thread *ticker_thread = new std::thread(ticker_main);
+    (void)ticker_thread;
+    return &us_data;
+}
+
+extern "C" void us_ticker_irq_handler(void) {
+    ticker_irq_handler(&us_data);
+}
+
+/*----------------------------- Ticker event queue -------------------------*/
+
+extern "C" void ticker_set_handler(const ticker_data_t *const data, ticker_event_handler handler) {
+    data->queue->event_handler = handler;
+}
+
+extern "C" void ticker_irq_handler(const ticker_data_t *const data) {
+    data->interface->clear_interrupt();
+    for (;;) {
+        ticker_event_t *event = data->queue->head;
+        if (event == NULL)
+            break;
+        if ((int32_t)(event->timestamp - data->interface->read()) > 0) {
+            data->interface->set_interrupt(event->timestamp);
+            break;
+        }
+        data->queue->head = event->next;
+        if (data->queue->event_handler != NULL)
+            data->queue->event_handler(event->id);
+    }
+}
+
+extern "C" void ticker_insert_event(const ticker_data_t *const data, ticker_event_t *obj,
+                                    timestamp_t timestamp, uint32_t id) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    obj->timestamp = timestamp;
+    obj->id = id;
+    ticker_event_t *prev = NULL, *p = data->queue->head;
+    while ((p != NULL) && ((int32_t)(timestamp - p->timestamp) >= 0)) {
+        prev = p;
+        p = p->next;
+    }
+    obj->next = p;
+    if (prev == NULL) {
+        data->queue->head = obj;
+        data->interface->set_interrupt(timestamp);
+    } else {
+        prev->next = obj;
+    }
+    __set_PRIMASK(primask);
+}
+
+extern "C" void ticker_remove_event(const ticker_data_t *const data, ticker_event_t *obj) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    for (ticker_event_t **p = &data->queue->head; *p != NULL; p = &(*p)->next) {
+        if (*p == obj) {
+            *p = obj->next;
+            break;
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+extern "C" timestamp_t ticker_read(const ticker_data_t *const data) {
+    return data->interface->read();
+}
+
+extern "C" int ticker_get_next_timestamp(const ticker_data_t *const data, timestamp_t *timestamp) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    int ret = 0;
+    if (data->queue->head != NULL) {
+        *timestamp = data->queue->head->timestamp;
+        ret = 1;
+    }
+    __set_PRIMASK(primask);
+    return ret;
+}
+
+/* Plays the us_ticker interrupt while the host clock is used */
+static void ticker_main(void) {
+    for (;;) {
+        uint32_t generation;
+        {
+            std::lock_guard<std::mutex> guard(ticker_mutex());
+            generation = ticker_generation;
+        }
+        timestamp_t next = 0;
+        bool pending = !ticker_virtual && ticker_get_next_timestamp(&us_data, &next);
+        int32_t delay_us = pending ? (int32_t)(next - host_us()) : 0;
+        if (pending && (delay_us <= 0)) {
+            host_isr_enter();
+            ticker_irq_handler(&us_data);
+            host_isr_exit();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(ticker_mutex());
+        if (pending) {
+            ticker_cond().wait_for(lock, std::chrono::microseconds(delay_us),
+                                   [&] { return ticker_generation != generation; });
+        } else {
+            ticker_cond().wait(lock, [&] { return ticker_generation != generation; });
+        }
+    }
+}
+
+void host_ticker_virtual(bool enable) {
+    ticker_virtual_us = host_us();
+    ticker_virtual = enable;
+    us_ticker_set_interrupt(0);
+}
+
+void host_ticker_set(uint32_t now_us) {
+    ticker_virtual_us = now_us;
+}
+
+void host_ticker_advance(uint32_t delta_us) {
+    uint32_t target = ticker_virtual_us + delta_us;
+    for (;;) {
+        host_isr_enter();
+        ticker_event_t *event = us_queue.head;
+        if ((event == NULL) || ((int32_t)(event->timestamp - target) > 0)) {
+            ticker_virtual_us = target;
+            host_isr_exit();
+            break;
+        }
+        if ((int32_t)(event->timestamp - ticker_virtual_us) > 0)
+            ticker_virtual_us = event->timestamp;
+        ticker_irq_handler(&us_data);
+        host_isr_exit();
+    }
+}
+
+/*----------------------------- TimerEvent ---------------------------------*/
+
+/* Ticker event ids are 32 bit, so TimerEvent objects are looked up by a key */
+static std::map<uint32_t, mbed::TimerEvent*> &timer_events() {
+    static std::map<uint32_t, mbed::TimerEvent*> *map = new std::map<uint32_t, mbed::TimerEvent*>;
+    return *map;
+}
+
+static uint32_t timer_event_key;
+
+namespace mbed {
+
+TimerEvent::TimerEvent() : event(), _ticker_data(get_us_ticker_data()) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    event.id = ++timer_event_key;
+    timer_events()[event.id] = this;
+    __set_PRIMASK(primask);
+    ticker_set_handler(_ticker_data, (&TimerEvent::irq));
+}
+
+TimerEvent::TimerEvent(const ticker_data_t *data) : event(), _ticker_data(data) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    event.id = ++timer_event_key;
+    timer_events()[event.id] = this;
+    __set_PRIMASK(primask);
+    ticker_set_handler(_ticker_data, (&TimerEvent::irq));
+}
+
+void TimerEvent::irq(uint32_t id) {
+    std::map<uint32_t, TimerEvent*>::iterator it = timer_events().find(id);
+    if (it != timer_events().end())
+        it->second->handler();
+}
+
+TimerEvent::~TimerEvent() {
+    remove();
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    timer_events().erase(event.id);
+    __set_PRIMASK(primask);
+}
+
+void TimerEvent::insert(timestamp_t timestamp) {
+    ticker_insert_event(_ticker_data, &event, timestamp, event.id);
+}
+
+void TimerEvent::remove() {
+    ticker_remove_event(_ticker_data, &event);
+}
+
+}
+
+/*----------------------------- error --------------------------------------*/
+
+extern "C" void error(const char* format, ...) {
+    va_list arg;
+    va_start(arg, format);
+    vfprintf(stderr, format, arg);
+    va_end(arg);
+    abort();
+}
@@ -0,0 +1,912 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* CMSIS-RTOS API of RTX on top of host threads.
+ Every RTX object is a plain struct guarded by one port lock. A blocked thread waits on its
+ own condition variable for the object it is blocked on, which is notified when the object
+ changes. Priorities are stored but not scheduled: all threads run in parallel, so the tests
+ only rely on blocking semantics. */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cmsis.h"
+#include "cmsis_os.h"
+#include "host_port.h"
+
+typedef std::chrono::steady_clock host_clock;
+typedef std::unique_lock<std::mutex> host_lock;
+
+/*----------------------------- Interrupt mask -----------------------------*/
+
+static std::recursive_mutex &irq_lock() {
+    static std::recursive_mutex *lock = new std::recursive_mutex;
+    return *lock;
+}
+
+static __thread uint32_t primask;
+static __thread uint32_t ipsr;
+static __thread volatile uint32_t *reserved_addr;
+static __thread uint32_t reserved_value;
+
+extern "C" LPC_WDT_TypeDef host_wdt;
+LPC_WDT_TypeDef host_wdt;
+
+extern "C" uint32_t host_irq_disable(void) {
+    uint32_t previous = primask;
+    if (!primask) {
+        irq_lock().lock();
+        primask = 1;
+    }
+    return previous;
+}
+
+extern "C" void host_irq_enable(void) {
+    if (primask) {
+        primask = 0;
+        irq_lock().unlock();
+    }
+}
+
+extern "C" uint32_t host_irq_primask(void) {
+    return primask;
+}
+
+extern "C" uint32_t host_irq_ipsr(void) {
+    return ipsr;
+}
+
+/* A CMSIS-RTOS call from a thread is an SVC on the target, which escalates to a HardFault
+ while PRIMASK is set; from an interrupt handler it runs directly. */
+static void svc_call() {
+    if (primask && !ipsr) {
+        fprintf(stderr, "CMSIS-RTOS call with interrupts masked: HardFault on the target\n");
+        abort();
+    }
+}
+
+extern "C" uint32_t host_ldrex(volatile uint32_t *addr) {
+    reserved_addr = addr;
+    reserved_value = __atomic_load_n(addr, __ATOMIC_SEQ_CST);
+    return reserved_value;
+}
+
+extern "C" uint32_t host_strex(uint32_t value, volatile uint32_t *addr) {
+    bool stored = false;
+    if (reserved_addr == addr) {
+        // serialised with masked sections, which update the same words without exclusives
+        std::lock_guard<std::recursive_mutex> guard(irq_lock());
+        uint32_t expected = reserved_value;
+        stored = __atomic_compare_exchange_n(addr, &expected, value, false,
+                                             __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    }
+    reserved_addr = NULL;
+    return stored ? 0 : 1;
+}
+
+extern "C" void host_clrex(void) {
+    reserved_addr = NULL;
+}
+
+void host_isr_enter(void) {
+    irq_lock().lock();
+    ipsr = 16;
+}
+
+void host_isr_exit(void) {
+    ipsr = 0;
+    irq_lock().unlock();
+}
+
+/*----------------------------- Port state ---------------------------------*/
+
+/* Thrown out of a blocking call of a thread that has been terminated */
+struct HostExit {
+};
+
+struct os_thread_cb {
+    osThreadDef_t *def;                 // NULL for a thread not created by osThreadCreate
+    void *argument;
+    osPriority priority;
+    int32_t signals;
+    bool terminate;
+    bool finished;
+    const void *waiting_on;             // object the thread is blocked on
+    std::condition_variable cond;
+    std::thread thread;
+    uint32_t period_ms;
+    uint32_t deadline_ms;
+    uint32_t misses;
+    host_clock::time_point release;
+};
+
+/* Mutexes and semaphores are taken and given without the port lock as long as nobody
+ waits, as the LDREX/STREX fast paths of rt_CMSIS.c: a blocking thread counts itself in
+ waiters before its last attempt, a release that sees waiters notifies under the lock. */
+struct os_mutex_cb {
+    std::atomic<os_thread_cb*> owner;
+    uint32_t level;                     // only used by the owner
+    std::atomic<uint32_t> waiters;
+};
+
+struct os_semaphore_cb {
+    std::atomic<uint32_t> tokens;
+    std::atomic<uint32_t> waiters;
+};
+
+struct os_pool_cb {
+    uint32_t item_sz;
+    uint32_t count;
+    uint32_t used;
+    uint32_t max_used;
+    char *memory;
+    std::vector<void*> free;
+};
+
+struct os_mailQ_cb {
+    os_pool_cb pool;
+    std::deque<void*> queue;
+};
+
+struct os_messageQ_cb {
+    uint32_t size;
+    std::deque<uint32_t> queue;
+};
+
+struct os_timer_cb {
+    os_ptimer function;
+    void *argument;
+    os_timer_type type;
+    bool running;
+    bool in_callback;
+    uint32_t period_ms;
+    host_clock::time_point due;
+};
+
+static std::mutex &port_mutex() {
+    static std::mutex *mutex = new std::mutex;
+    return *mutex;
+}
+
+static std::set<os_thread_cb*> &threads() {
+    static std::set<os_thread_cb*> *set = new std::set<os_thread_cb*>;
+    return *set;
+}
+
+static std::set<os_timer_cb*> &timers() {
+    static std::set<os_timer_cb*> *set = new std::set<os_timer_cb*>;
+    return *set;
+}
+
+static __thread os_thread_cb *self;
+static uint32_t taskcnt = OS_TASKCNT;
+static bool fast_path = true;
+
+void host_set_taskcnt(uint32_t count) {
+    taskcnt = count;
+}
+
+void host_lock_fast_path(bool enable) {
+    fast_path = enable;
+}
+
+/* The thread control block of the calling thread, threads not created by the port
+ (main, the ticker thread) are adopted on their first call */
+static os_thread_cb *current(void) {
+    if (self == NULL) {
+        self = new os_thread_cb();
+        self->priority = osPriorityNormal;
+        host_lock lock(port_mutex());
+        threads().insert(self);
+    }
+    return self;
+}
+
+/* Wait with the port lock held until ready() holds after object changed, the timeout
+ expires or the thread is terminated */
+template<typename P>
+static bool port_wait(host_lock &lock, os_thread_cb *thread, const void *object,
+                      uint32_t millisec, P ready) {
+    thread->waiting_on = object;
+    if (millisec == osWaitForever) {
+        while (!thread->terminate && !ready())
+            thread->cond.wait(lock);
+    } else {
+        host_clock::time_point end = host_clock::now() + std::chrono::milliseconds(millisec);
+        while (!thread->terminate && !ready()) {
+            if (thread->cond.wait_until(lock, end) == std::cv_status::timeout)
+                break;
+        }
+    }
+    thread->waiting_on = NULL;
+    if (thread->terminate)
+        throw HostExit();
+    return ready();
+}
+
+/* Wake up the threads blocked on object, called with the port lock held */
+static void port_notify(const void *object) {
+    for (std::set<os_thread_cb*>::iterator it = threads().begin(); it != threads().end(); ++it) {
+        if ((*it)->waiting_on == object)
+            (*it)->cond.notify_one();
+    }
+}
+
+/*----------------------------- Kernel -------------------------------------*/
+
+extern "C" osStatus osKernelInitialize(void) {
+    return osOK;
+}
+
+extern "C" osStatus osKernelStart(void) {
+    return osOK;
+}
+
+extern "C" int32_t osKernelRunning(void) {
+    return 1;
+}
+
+extern "C" osStatus osKernelGetStats(osKernelStats *stats) {
+    if (stats == NULL)
+        return osErrorParameter;
+    memset(stats, 0, sizeof(*stats));
+    return osOK;
+}
+
+/*----------------------------- Threads ------------------------------------*/
+
+static void thread_main(os_thread_cb *thread) {
+    self = thread;
+    thread->def->tcb.state = 2;                 // RUNNING
+    try {
+        thread->def->pthread(thread->argument);
+    } catch (HostExit &) {
+    }
+    host_lock lock(port_mutex());
+    thread->def->tcb.state = 0;                 // INACTIVE
+    thread->finished = true;
+}
+
+extern "C" osThreadId osThreadCreate(osThreadDef_t *thread_def, void *argument) {
+    if ((thread_def == NULL) || (thread_def->pthread == NULL) ||
+        (thread_def->stacksize == 0) || (thread_def->stack_pointer == NULL))
+        return NULL;
+
+    os_thread_cb *thread = new os_thread_cb();
+    thread->def = thread_def;
+    thread->argument = argument;
+    thread->priority = thread_def->tpriority;
+
+    // the host stack is not used, the thread looks as if it had pushed its initial frame
+    OS_TCB &tcb = thread_def->tcb;
+    tcb.state = 1;                              // READY
+    tcb.prio = thread_def->tpriority - osPriorityIdle + 1;
+    tcb.stack = thread_def->stack_pointer;
+    tcb.priv_stack = thread_def->stacksize;
+    tcb.tsk_stack = (U32)((uintptr_t)thread_def->stack_pointer + thread_def->stacksize - 64);
+
+    {
+        // like os_active_TCB, OS_TASKCNT counts main but not the timer thread
+        host_lock lock(port_mutex());
+        uint32_t active = 1;
+        for (std::set<os_thread_cb*>::iterator it = threads().begin(); it != threads().end(); ++it) {
+            if (((*it)->def != NULL) && !(*it)->finished)
+                active++;
+        }
+        if (active >= taskcnt) {
+            delete thread;
+            return NULL;
+        }
+        threads().insert(thread);
+    }
+    thread->thread = std::thread(thread_main, thread);
+    return thread;
+}
+
+extern "C" osThreadId osThreadGetId(void) {
+    svc_call();
+    return current();
+}
+
+extern "C" osStatus osThreadTerminate(osThreadId thread_id) {
+    os_thread_cb *thread = thread_id;
+    if ((thread != NULL) && (thread == self))
+        throw HostExit();
+    {
+        host_lock lock(port_mutex());
+        if (threads().count(thread) == 0)
+            return osErrorParameter;
+        if (thread->def == NULL)
+            return osErrorResource;
+        thread->terminate = true;
+        thread->cond.notify_one();
+    }
+    thread->thread.join();
+    {
+        host_lock lock(port_mutex());
+        threads().erase(thread);
+    }
+    delete thread;
+    return osOK;
+}
+
+extern "C" osStatus osThreadYield(void) {
+    svc_call();
+    std::this_thread::yield();
+    return osOK;
+}
+
+extern "C" osStatus osThreadSetPriority(osThreadId thread_id, osPriority priority) {
+    svc_call();
+    host_lock lock(port_mutex());
+    if (threads().count(thread_id) == 0)
+        return osErrorParameter;
+    if ((priority < osPriorityIdle) || (priority > osPriorityRealtime))
+        return osErrorValue;
+    thread_id->priority = priority;
+    return osOK;
+}
+
+extern "C" osPriority osThreadGetPriority(osThreadId thread_id) {
+    svc_call();
+    host_lock lock(port_mutex());
+    if (threads().count(thread_id) == 0)
+        return osPriorityError;
+    return thread_id->priority;
+}
+
+extern "C" osStatus osThreadSetPeriod(osThreadId thread_id, uint32_t period, uint32_t deadline) {
+    svc_call();
+    if (deadline == 0)
+        deadline = period;
+    if ((deadline > period) || (period > 60000))
+        return osErrorValue;
+    host_lock lock(port_mutex());
+    if (threads().count(thread_id) == 0)
+        return osErrorParameter;
+    thread_id->period_ms = period;
+    thread_id->deadline_ms = deadline;
+    thread_id->release = host_clock::now();
+    return osOK;
+}
+
+extern "C" osStatus osThreadWaitPeriod(void) {
+    svc_call();
+    os_thread_cb *thread = current();
+    host_lock lock(port_mutex());
+    if (thread->period_ms == 0)
+        return osErrorResource;
+    host_clock::time_point now = host_clock::now();
+    if (now > thread->release + std::chrono::milliseconds(thread->deadline_ms))
+        thread->misses++;
+    thread->release += std::chrono::milliseconds(thread->period_ms);
+    host_clock::time_point release = thread->release;
+    while (!thread->terminate && (host_clock::now() < release))
+        thread->cond.wait_until(lock, release);
+    if (thread->terminate)
+        throw HostExit();
+    return osOK;
+}
+
+extern "C" uint32_t osThreadGetDeadlineMisses(osThreadId thread_id) {
+    host_lock lock(port_mutex());
+    if (threads().count(thread_id) == 0)
+        return 0;
+    return thread_id->misses;
+}
+
+extern "C" osStatus osDelay(uint32_t millisec) {
+    svc_call();
+    os_thread_cb *thread = current();
+    host_lock lock(port_mutex());
+    port_wait(lock, thread, &taskcnt, millisec, [] { return false; });
+    return osEventTimeout;
+}
+
+/*----------------------------- Signals ------------------------------------*/
+
+extern "C" int32_t osSignalSet(osThreadId thread_id, int32_t signals) {
+    svc_call();
+    host_lock lock(port_mutex());
+    if (threads().count(thread_id) == 0)
+        return 0x80000000;
+    int32_t previous = thread_id->signals;
+    thread_id->signals |= signals & 0xFFFF;
+    port_notify(thread_id);
+    return previous;
+}
+
+extern "C" int32_t osSignalClear(osThreadId thread_id, int32_t signals) {
+    svc_call();
+    host_lock lock(port_mutex());
+    if (threads().count(thread_id) == 0)
+        return 0x80000000;
+    int32_t previous = thread_id->signals;
+    thread_id->signals &= ~signals;
+    return previous;
+}
+
+extern "C" int32_t osSignalGet(osThreadId thread_id) {
+    host_lock lock(port_mutex());
+    if (threads().count(thread_id) == 0)
+        return 0x80000000;
+    return thread_id->signals;
+}
+
+extern "C" osEvent osSignalWait(int32_t signals, uint32_t millisec) {
+    svc_call();
+    osEvent event;
+    memset(&event, 0, sizeof(event));
+    if (ipsr != 0) {
+        event.status = osErrorISR;
+        return event;
+    }
+    if ((uint32_t)signals > 0xFFFF) {
+        event.status = osErrorValue;
+        return event;
+    }
+
+    os_thread_cb *thread = current();
+    host_lock lock(port_mutex());
+    // signals == 0 waits for any flag, otherwise for all of them
+    auto ready = [&] {
+        return (signals != 0) ? ((thread->signals & signals) == signals) : (thread->signals != 0);
+    };
+    if (!ready() && ((millisec == 0) || !port_wait(lock, thread, thread, millisec, ready))) {
+        event.status = (millisec == 0) ? osOK : osEventTimeout;
+        return event;
+    }
+    event.status = osEventSignal;
+    event.value.signals = (signals != 0) ? signals : thread->signals;
+    thread->signals &= ~event.value.signals;
+    return event;
+}
+
+/*----------------------------- Mutex --------------------------------------*/
+
+extern "C" osMutexId osMutexCreate(osMutexDef_t *mutex_def) {
+    return (mutex_def != NULL) ? new os_mutex_cb() : NULL;
+}
+
+static bool mutex_try_lock(osMutexId mutex_id, os_thread_cb *thread) {
+    os_thread_cb *free = NULL;
+    return mutex_id->owner.compare_exchange_strong(free, thread);
+}
+
+extern "C" osStatus osMutexWait(osMutexId mutex_id, uint32_t millisec) {
+    svc_call();
+    if (ipsr != 0)
+        return osErrorISR;
+    if (mutex_id == NULL)
+        return osErrorParameter;
+    os_thread_cb *thread = current();
+    if (mutex_id->owner == thread) {
+        mutex_id->level++;
+        return osOK;
+    }
+    if (fast_path && mutex_try_lock(mutex_id, thread)) {
+        mutex_id->level = 1;
+        return osOK;
+    }
+    host_lock lock(port_mutex());
+    mutex_id->waiters++;
+    bool owned = false;
+    auto ready = [&] { return owned || (owned = mutex_try_lock(mutex_id, thread)); };
+    if (!ready() && (millisec != 0))
+        port_wait(lock, thread, mutex_id, millisec, ready);
+    mutex_id->waiters--;
+    if (!owned)
+        return (millisec == 0) ? osErrorResource : osErrorTimeoutResource;
+    mutex_id->level = 1;
+    return osOK;
+}
+
+extern "C" osStatus osMutexRelease(osMutexId mutex_id) {
+    svc_call();
+    if (ipsr != 0)
+        return osErrorISR;
+    if (mutex_id == NULL)
+        return osErrorParameter;
+    os_thread_cb *thread = current();
+    if (mutex_id->owner != thread)
+        return osErrorResource;
+    if (--mutex_id->level == 0) {
+        mutex_id->owner = NULL;
+        if (!fast_path || (mutex_id->waiters != 0)) {
+            host_lock lock(port_mutex());
+            port_notify(mutex_id);
+        }
+    }
+    return osOK;
+}
+
+extern "C" osStatus osMutexDelete(osMutexId mutex_id) {
+    if (mutex_id == NULL)
+        return osErrorParameter;
+    delete mutex_id;
+    return osOK;
+}
+
+/*----------------------------- Semaphore ----------------------------------*/
+
+extern "C" osSemaphoreId osSemaphoreCreate(osSemaphoreDef_t *semaphore_def, int32_t count) {
+    if ((semaphore_def == NULL) || (count < 0) || (count > osFeature_Semaphore))
+        return NULL;
+    os_semaphore_cb *semaphore = new os_semaphore_cb();
+    semaphore->tokens = count;
+    return semaphore;
+}
+
+/* Take a token, returns the number of tokens before or 0 if there was none */
+static int32_t semaphore_try_wait(osSemaphoreId semaphore_id) {
+    uint32_t tokens = semaphore_id->tokens;
+    while ((tokens != 0) && !semaphore_id->tokens.compare_exchange_weak(tokens, tokens - 1))
+        ;
+    return tokens;
+}
+
+extern "C" int32_t osSemaphoreWait(osSemaphoreId semaphore_id, uint32_t millisec) {
+    svc_call();
+    if ((semaphore_id == NULL) || ((ipsr != 0) && (millisec != 0)))
+        return -1;
+    int32_t taken = 0;
+    if (fast_path && ((taken = semaphore_try_wait(semaphore_id)) != 0))
+        return taken;
+    os_thread_cb *thread = current();
+    host_lock lock(port_mutex());
+    semaphore_id->waiters++;
+    auto ready = [&] { return (taken != 0) || ((taken = semaphore_try_wait(semaphore_id)) != 0); };
+    if (!ready() && (millisec != 0))
+        port_wait(lock, thread, semaphore_id, millisec, ready);
+    semaphore_id->waiters--;
+    return taken;
+}
+
+extern "C" osStatus osSemaphoreRelease(osSemaphoreId semaphore_id) {
+    svc_call();
+    if (semaphore_id == NULL)
+        return osErrorParameter;
+    uint32_t tokens = semaphore_id->tokens;
+    do {
+        if (tokens >= osFeature_Semaphore)
+            return osErrorResource;
+    } while (!semaphore_id->tokens.compare_exchange_weak(tokens, tokens + 1));
+    if (!fast_path || (semaphore_id->waiters != 0)) {
+        host_lock lock(port_mutex());
+        port_notify(semaphore_id);
+    }
+    return osOK;
+}
+
+extern "C" osStatus osSemaphoreDelete(osSemaphoreId semaphore_id) {
+    if (semaphore_id == NULL)
+        return osErrorParameter;
+    delete semaphore_id;
+    return osOK;
+}
+
+/*----------------------------- Memory Pool --------------------------------*/
+
+static void pool_init(os_pool_cb *pool, uint32_t count, uint32_t item_sz) {
+    pool->item_sz = (item_sz + 7) & ~7U;
+    pool->count = count;
+    pool->memory = new char[pool->item_sz * count];
+    for (uint32_t i = count; i > 0; i--)
+        pool->free.push_back(pool->memory + (i - 1) * pool->item_sz);
+}
+
+static void *pool_alloc(os_pool_cb *pool) {
+    if (pool->free.empty())
+        return NULL;
+    void *block = pool->free.back();
+    pool->free.pop_back();
+    if (++pool->used > pool->max_used)
+        pool->max_used = pool->used;
+    return block;
+}
+
+static osStatus pool_free(os_pool_cb *pool, void *block) {
+    char *p = (char*)block;
+    if ((p < pool->memory) || (p >= pool->memory + pool->item_sz * pool->count) ||
+        ((p - pool->memory) % pool->item_sz != 0))
+        return osErrorValue;
+    pool->free.push_back(block);
+    pool->used--;
+    return osOK;
+}
+
+extern "C" osPoolId osPoolCreate(osPoolDef_t *pool_def) {
+    if ((pool_def == NULL) || (pool_def->pool_sz == 0) || (pool_def->item_sz == 0))
+        return NULL;
+    os_pool_cb *pool = new os_pool_cb();
+    pool_init(pool, pool_def->pool_sz, pool_def->item_sz);
+    return pool;
+}
+
+extern "C" void *osPoolAlloc(osPoolId pool_id) {
+    if (pool_id == NULL)
+        return NULL;
+    host_lock lock(port_mutex());
+    return pool_alloc(pool_id);
+}
+
+extern "C" void *osPoolCAlloc(osPoolId pool_id) {
+    void *block = osPoolAlloc(pool_id);
+    if (block != NULL)
+        memset(block, 0, pool_id->item_sz);
+    return block;
+}
+
+extern "C" osStatus osPoolFree(osPoolId pool_id, void *block) {
+    if (pool_id == NULL)
+        return osErrorParameter;
+    host_lock lock(port_mutex());
+    return pool_free(pool_id, block);
+}
+
+extern "C" uint32_t osPoolGetUsage(osPoolId pool_id, uint32_t *max_used) {
+    if (pool_id == NULL)
+        return 0;
+    host_lock lock(port_mutex());
+    if (max_used != NULL)
+        *max_used = pool_id->max_used;
+    return pool_id->used;
+}
+
+/*----------------------------- Message Queue ------------------------------*/
+
+extern "C" osMessageQId osMessageCreate(osMessageQDef_t *queue_def, osThreadId thread_id) {
+    if ((queue_def == NULL) || (queue_def->queue_sz == 0))
+        return NULL;
+    os_messageQ_cb *queue = new os_messageQ_cb();
+    queue->size = queue_def->queue_sz;
+    return queue;
+}
+
+extern "C" osStatus osMessagePut(osMessageQId queue_id, uint32_t info, uint32_t millisec) {
+    svc_call();
+    if (queue_id == NULL)
+        return osErrorParameter;
+    if ((ipsr != 0) && (millisec != 0))
+        return osErrorParameter;
+    os_thread_cb *thread = current();
+    host_lock lock(port_mutex());
+    auto ready = [&] { return queue_id->queue.size() < queue_id->size; };
+    if (!ready()) {
+        if (millisec == 0)
+            return osErrorResource;
+        if (!port_wait(lock, thread, &queue_id->size, millisec, ready))
+            return osErrorTimeoutResource;
+    }
+    queue_id->queue.push_back(info);
+    port_notify(queue_id);
+    return osOK;
+}
+
+extern "C" osEvent osMessageGet(osMessageQId queue_id, uint32_t millisec) {
+    svc_call();
+    osEvent event;
+    memset(&event, 0, sizeof(event));
+    event.def.message_id = queue_id;
+    if ((queue_id == NULL) || ((ipsr != 0) && (millisec != 0))) {
+        event.status = osErrorParameter;
+        return event;
+    }
+    os_thread_cb *thread = current();
+    host_lock lock(port_mutex());
+    auto ready = [&] { return !queue_id->queue.empty(); };
+    if (!ready() && ((millisec == 0) || !port_wait(lock, thread, queue_id, millisec, ready))) {
+        event.status = (millisec == 0) ? osOK : osEventTimeout;
+        return event;
+    }
+    event.status = osEventMessage;
+    event.value.v = queue_id->queue.front();
+    queue_id->queue.pop_front();
+    port_notify(&queue_id->size);
+    return event;
+}
+
+/*----------------------------- Mail Queue ---------------------------------*/
+
+extern "C" osMailQId osMailCreate(osMailQDef_t *queue_def, osThreadId thread_id) {
+    if ((queue_def == NULL) || (queue_def->queue_sz == 0) || (queue_def->item_sz == 0))
+        return NULL;
+    os_mailQ_cb *queue = new os_mailQ_cb();
+    pool_init(&queue->pool, queue_def->queue_sz, queue_def->item_sz);
+    return queue;
+}
+
+extern "C" void *osMailAlloc(osMailQId queue_id, uint32_t millisec) {
+    if ((queue_id == NULL) || ((ipsr != 0) && (millisec != 0)))
+        return NULL;
+    os_thread_cb *thread = current();
+    host_lock lock(port_mutex());
+    auto ready = [&] { return !queue_id->pool.free.empty(); };
+    if (!ready() && ((millisec == 0) || !port_wait(lock, thread, &queue_id->pool, millisec, ready)))
+        return NULL;
+    return pool_alloc(&queue_id->pool);
+}
+
+extern "C" void *osMailCAlloc(osMailQId queue_id, uint32_t millisec) {
+    void *mail = osMailAlloc(queue_id, millisec);
+    if (mail != NULL)
+        memset(mail, 0, queue_id->pool.item_sz);
+    return mail;
+}
+
+extern "C" osStatus osMailPut(osMailQId queue_id, void *mail) {
+    svc_call();
+    if (queue_id == NULL)
+        return osErrorParameter;
+    if (mail == NULL)
+        return osErrorValue;
+    host_lock lock(port_mutex());
+    queue_id->queue.push_back(mail);
+    port_notify(queue_id);
+    return osOK;
+}
+
+extern "C" osEvent osMailGet(osMailQId queue_id, uint32_t millisec) {
+    svc_call();
+    osEvent event;
+    memset(&event, 0, sizeof(event));
+    event.def.mail_id = queue_id;
+    if ((queue_id == NULL) || ((ipsr != 0) && (millisec != 0))) {
+        event.status = osErrorParameter;
+        return event;
+    }
+    os_thread_cb *thread = current();
+    host_lock lock(port_mutex());
+    auto ready = [&] { return !queue_id->queue.empty(); };
+    if (!ready() && ((millisec == 0) || !port_wait(lock, thread, queue_id, millisec, ready))) {
+        event.status = (millisec == 0) ? osOK : osEventTimeout;
+        return event;
+    }
+    event.status = osEventMail;
+    event.value.p = queue_id->queue.front();
+    queue_id->queue.pop_front();
+    return event;
+}
+
+extern "C" osStatus osMailFree(osMailQId queue_id, void *mail) {
+    svc_call();
+    if (queue_id == NULL)
+        return osErrorParameter;
+    host_lock lock(port_mutex());
+    osStatus status = pool_free(&queue_id->pool, mail);
+    port_notify(&queue_id->pool);
+    return status;
+}
+
+extern "C" uint32_t osMailGetUsage(osMailQId queue_id, uint32_t *max_used) {
+    if (queue_id == NULL)
+        return 0;
+    host_lock lock(port_mutex());
+    if (max_used != NULL)
+        *max_used = queue_id->pool.max_used;
+    return queue_id->pool.used;
+}
+
+/*----------------------------- Timers -------------------------------------*/
+
+/* Runs the timer callbacks, like osTimerThread on the target */
+static void timer_main(void) {
+    os_thread_cb *thread = current();
+    thread->priority = osPriorityHigh;
+    host_lock lock(port_mutex());
+    for (;;) {
+        os_timer_cb *next = NULL;
+        for (std::set<os_timer_cb*>::iterator it = timers().begin(); it != timers().end(); ++it) {
+            if ((*it)->running && ((next == NULL) || ((*it)->due < next->due)))
+                next = *it;
+        }
+        thread->waiting_on = &timers();
+        if (next == NULL) {
+            thread->cond.wait(lock);
+            continue;
+        }
+        if (host_clock::now() < next->due) {
+            thread->cond.wait_until(lock, next->due);
+            continue;
+        }
+        thread->waiting_on = NULL;
+        if (next->type == osTimerPeriodic)
+            next->due += std::chrono::milliseconds(next->period_ms);
+        else
+            next->running = false;
+        next->in_callback = true;
+        lock.unlock();
+        next->function(next->argument);
+        lock.lock();
+        if (timers().count(next) != 0)         // a callback may delete its own timer
+            next->in_callback = false;
+        port_notify(next);
+    }
+}
+
+static std::thread::id timer_thread_id(void) {
+    static std::thread *timer_thread = new std::thread(timer_main);
+    return timer_thread->get_id();
+}
+
+extern "C" osTimerId osTimerCreate(osTimerDef_t *timer_def, os_timer_type type, void *argument) {
+    if ((timer_def == NULL) || (timer_def->ptimer == NULL))
+        return NULL;
+    timer_thread_id();
+    os_timer_cb *timer = new os_timer_cb();
+    timer->function = timer_def->ptimer;
+    timer->argument = argument;
+    timer->type = type;
+    host_lock lock(port_mutex());
+    timers().insert(timer);
+    return timer;
+}
+
+extern "C" osStatus osTimerStart(osTimerId timer_id, uint32_t millisec) {
+    svc_call();
+    if ((timer_id == NULL) || (millisec == 0))
+        return osErrorParameter;
+    host_lock lock(port_mutex());
+    timer_id->running = true;
+    timer_id->period_ms = millisec;
+    timer_id->due = host_clock::now() + std::chrono::milliseconds(millisec);
+    port_notify(&timers());
+    return osOK;
+}
+
+extern "C" osStatus osTimerStop(osTimerId timer_id) {
+    svc_call();
+    if (timer_id == NULL)
+        return osErrorParameter;
+    host_lock lock(port_mutex());
+    if (!timer_id->running)
+        return osErrorResource;
+    timer_id->running = false;
+    port_notify(&timers());
+    return osOK;
+}
+
+extern "C" osStatus osTimerDelete(osTimerId timer_id) {
+    if (timer_id == NULL)
+        return osErrorParameter;
+    os_thread_cb *thread = current();
+    host_lock lock(port_mutex());
+    timer_id->running = false;
+    if (std::this_thread::get_id() != timer_thread_id()) {
+        thread->waiting_on = timer_id;
+        while (timer_id->in_callback)
+            thread->cond.wait(lock);
+        thread->waiting_on = NULL;
+    }
+    timers().erase(timer_id);
+    delete timer_id;
+    return osOK;
+}
@@ -0,0 +1,54 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef HOST_PORT_H
+#define HOST_PORT_H
+
+/* Controls of the host port used by the tests */
+
+#include <stdint.h>
+
+/** Run the calling thread as an interrupt handler: interrupts are masked and
+ __get_IPSR() is non-zero until host_isr_exit() */
+void host_isr_enter(void);
+void host_isr_exit(void);
+
+/** Change the number of concurrent threads, as OS_TASKCNT in RTX_Conf_CM.c
+ (default: OS_TASKCNT of the LPC1768, counting main) */
+void host_set_taskcnt(uint32_t taskcnt);
+
+/** Switch the lock free paths of the mutexes and semaphores, which only take the port
+ lock when a thread has to wait (default: on). Off, every call takes the port lock as a
+ service call enters the kernel. */
+void host_lock_fast_path(bool enable);
+
+/** Switch the us_ticker between the host clock and a virtual clock which only
+ moves with host_ticker_set and host_ticker_advance. */
+void host_ticker_virtual(bool enable);
+
+/** Set the virtual us_ticker without running any due event */
+void host_ticker_set(uint32_t now_us);
+
+/** Advance the virtual us_ticker, running every us_ticker event that falls due in
+ the calling thread, in timestamp order and in interrupt context. */
+void host_ticker_advance(uint32_t delta_us);
+
+#endif
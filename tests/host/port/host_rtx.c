@@ -0,0 +1,96 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/* Configuration, idle task and Cortex-M specific parts of RTX for running the
+ * scheduler sources (rt_List.c, rt_Time.c, rt_Task.c, rt_System.c), the
+ * mutexes (rt_Mutex.c) and the memory boxes (rt_MemBox.c) on host.
+ * The test drives rt_systick() and the task functions itself, a task
+ * switch requested by rt_switch_req() only sets os_tsk.new_tsk.
+ *
+ * Deliberately does not include RTX_Conf.h: the configuration constants are
+ * writable here so that a test can switch os_edf.
+ */
+#include "rt_TypeDef.h"
+#include "rt_MemBox.h"
+
+#define HOST_RTX_TASK_CNT   8
+#define HOST_RTX_IDLE_STACK 32
+
+unsigned char  os_edf;
+unsigned char  os_stkguard   = 0;
+unsigned short os_maxtaskrun = HOST_RTX_TASK_CNT;
+unsigned int   os_trv        = 0;
+
+unsigned int   idle_task_stack[HOST_RTX_IDLE_STACK];
+unsigned short const idle_task_stack_size = HOST_RTX_IDLE_STACK;
+/* a post service entry holds a pointer, so its size follows the host pointer */
+unsigned int   os_fifo[2 + 4*sizeof(struct OS_PSFE)/sizeof(unsigned int)] __attribute__((aligned(8)));
+unsigned char  const os_fifo_size = 4;
+void          *os_active_TCB[HOST_RTX_TASK_CNT];
+struct OS_ROBIN os_robin;
+
+unsigned int host_rtx_errors;
+
+void os_idle_demon (void) {
+}
+
+void os_error (U32 err_code) {
+  (void)err_code;
+  host_rtx_errors++;
+}
+
+void sysTimerTick (void) {
+}
+
+/* OS_ROBIN 0, as in RTX_CM_lib.h */
+void rt_init_robin (void) {
+}
+
+void rt_chk_robin (void) {
+}
+
+/* Post service requests are not used by the scheduler tests */
+void rt_evt_psh (P_TCB p_CB, U16 set_flags) { (void)p_CB; (void)set_flags; }
+void rt_mbx_psh (void *p_CB, void *p_msg)   { (void)p_CB; (void)p_msg; }
+void rt_sem_psh (void *p_CB)                { (void)p_CB; }
+
+/* No stacks on host: the tasks are simulated by the test */
+void rt_init_stack (P_TCB p_TCB, FUNCP task_body) {
+  (void)task_body;
+  p_TCB->stack_frame = 0;
+}
+
+U32 rt_get_PSP (void) {
+  return 0;
+}
+
+/* The return values are written to the stack frame of the task on the target */
+void rt_ret_val (P_TCB p_TCB, U32 v0) { (void)p_TCB; (void)v0; }
+void rt_ret_val2 (P_TCB p_TCB, U32 v0, U32 v1) { (void)p_TCB; (void)v0; (void)v1; }
+
+/* The tests run privileged, the wrappers of HAL_CM3.c call the box functions */
+void *_alloc_box (void *box_mem) {
+  return rt_alloc_box (box_mem);
+}
+
+int _free_box (void *box_mem, void *box) {
+  return rt_free_box (box_mem, box);
+}
@@ -0,0 +1,206 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "host_test.h"
+#include "BitFlag.h"
+#include "Semaphore.h"
+#include "Thread.h"
+
+using namespace rtos;
+
+/* Host addresses lie outside the bit-band region, so the flags use the read-modify-write path;
+ on the LPC1768 a FlagSet in AHBSRAM0 writes single flags with one store instead. */
+
+static void join(Thread &thread) {
+    while (thread.get_state() != Thread::Inactive)
+        Thread::wait(1);
+}
+
+TEST(flags_and_bit_flags) {
+    FlagSet flags(0x5);
+    CHECK(!flags.bit_band());
+    CHECK(flags.get(0));
+    CHECK(!flags.get(1));
+    CHECK(flags.get(2));
+
+    flags.set(31);
+    flags.clear(0);
+    flags.set(1, true);
+    CHECK_EQUAL(0x80000006, flags.read());
+
+    flags.write(0xF, 0x9);
+    CHECK_EQUAL(0x80000009, flags.read());
+
+    BitFlag engine(flags, 4);
+    BitFlag lights(flags, 5);
+    CHECK_EQUAL(0x10, engine.mask());
+    CHECK(!engine);
+    engine = true;
+    lights = engine;
+    CHECK(engine);
+    CHECK(lights);
+    CHECK_EQUAL(0x80000039, flags.read());
+    flags.write(engine.mask() | lights.mask(), 0);
+    CHECK(!engine);
+    CHECK(!lights);
+}
+
+static bool aborts(void (*function)()) {
+    fflush(stdout);
+    pid_t child = fork();
+    if (child == 0) {
+        // the error message of the child is expected
+        freopen("/dev/null", "w", stderr);
+        function();
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    return WIFSIGNALED(status) && (WTERMSIG(status) == SIGABRT);
+}
+
+static FlagSet range;
+
+static void get_bit_32() {
+    range.get(32);
+}
+
+static void set_bit_32() {
+    range.set(32);
+}
+
+static void set_bit_31() {
+    range.set(31);
+}
+
+TEST(flag_number_out_of_range) {
+    CHECK(aborts(get_bit_32));
+    CHECK(aborts(set_bit_32));
+    CHECK(!aborts(set_bit_31));
+}
+
+/* Every thread toggles its own flag of a shared set, as the car threads write their own vehicle
+ flags; a lost update of the read-modify-write leaves a flag in the wrong state or a count off. */
+
+#define THREADS     8
+#define TOGGLES     100000
+
+static FlagSet shared_flags;
+static uint32_t shared_word;
+static Semaphore word_lock(1);
+static uint32_t seen[THREADS];
+
+static void toggle_flag(void const *argument) {
+    uint32_t bit = (uint32_t)(uintptr_t)argument;
+    for (uint32_t i = 0; i < TOGGLES; i++) {
+        shared_flags.set(bit, (i & 1) == 0);
+        if (shared_flags.get(bit) == ((i & 1) == 0))
+            seen[bit]++;
+    }
+}
+
+static void toggle_word(void const *argument) {
+    uint32_t bit = (uint32_t)(uintptr_t)argument;
+    for (uint32_t i = 0; i < TOGGLES; i++) {
+        word_lock.wait();
+        if ((i & 1) == 0)
+            shared_word |= 1UL << bit;
+        else
+            shared_word &= ~(1UL << bit);
+        word_lock.release();
+        word_lock.wait();
+        if (((shared_word >> bit) & 1) == ((i & 1) == 0))
+            seen[bit]++;
+        word_lock.release();
+    }
+}
+
+static uint64_t run_threads(void (*function)(void const *argument)) {
+    for (int i = 0; i < THREADS; i++)
+        seen[i] = 0;
+    uint64_t start = host_test::now_ns();
+    Thread *threads[THREADS];
+    for (int i = 0; i < THREADS; i++)
+        threads[i] = new Thread(function, (void*)(uintptr_t)i);
+    for (int i = 0; i < THREADS; i++) {
+        join(*threads[i]);
+        delete threads[i];
+    }
+    return host_test::now_ns() - start;
+}
+
+TEST(concurrent_flags_against_semaphore) {
+    shared_flags.write(0xFFFFFFFF, 0xFFFF0000);
+    uint64_t flags_ns = run_threads(toggle_flag);
+    // TOGGLES is even, every flag ends cleared and the other flags are kept
+    CHECK_EQUAL(0xFFFF0000, shared_flags.read());
+    for (int i = 0; i < THREADS; i++)
+        CHECK_EQUAL(TOGGLES, seen[i]);
+
+    shared_word = 0xFFFF0000;
+    uint64_t word_ns = run_threads(toggle_word);
+    CHECK_EQUAL(0xFFFF0000, shared_word);
+    for (int i = 0; i < THREADS; i++)
+        CHECK_EQUAL(TOGGLES, seen[i]);
+
+    // one write and one read per toggle
+    host_test::report("8 threads, FlagSet set and get", 2ULL * THREADS * TOGGLES, flags_ns);
+    host_test::report("8 threads, Semaphore guarded word", 2ULL * THREADS * TOGGLES, word_ns);
+}
+
+#define ITERATIONS  2000000
+
+TEST(bench_single_flag) {
+    FlagSet flags;
+    BitFlag engine(flags, 7);
+    uint32_t count = 0;
+    uint64_t start = host_test::now_ns();
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        engine = (i & 1) != 0;
+        if (engine)
+            count++;
+    }
+    uint64_t flag_ns = host_test::now_ns() - start;
+    CHECK_EQUAL(ITERATIONS / 2, count);
+
+    Semaphore lock(1);
+    volatile uint32_t word = 0;
+    count = 0;
+    start = host_test::now_ns();
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        lock.wait();
+        word = (word & ~0x80UL) | (((i & 1) != 0) ? 0x80UL : 0);
+        lock.release();
+        lock.wait();
+        if (word & 0x80)
+            count++;
+        lock.release();
+    }
+    uint64_t word_ns = host_test::now_ns() - start;
+    CHECK_EQUAL(ITERATIONS / 2, count);
+
+    host_test::report("BitFlag write and read", 2ULL * ITERATIONS, flag_ns);
+    host_test::report("Semaphore guarded word write and read", 2ULL * ITERATIONS, word_ns);
+}
@@ -0,0 +1,239 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "Callback.h"
+#include "FixedCallChain.h"
+#include "FunctionPointer.h"
+
+#include <stdlib.h>
+
+using namespace mbed;
+
+/* every allocation of the test is counted, a Callback must not make any */
+static uint32_t allocations = 0;
+
+void *operator new(size_t size) {
+    allocations++;
+    return malloc(size);
+}
+
+void operator delete(void *pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    free(pointer);
+}
+
+static volatile int calls = 0;
+
+static void count_call() {
+    calls++;
+}
+
+static int add_one(int value) {
+    return value + 1;
+}
+
+struct Counter {
+    Counter() : count(0) {}
+    void increment() { count++; }
+    int add(int value) { count += value; return count; }
+    int count;
+};
+
+/* a function object with state which counts its live copies */
+struct Toggle {
+    static int live;
+    Toggle(int *pin) : pin(pin), toggles(0) { live++; }
+    Toggle(const Toggle &other) : pin(other.pin), toggles(other.toggles) { live++; }
+    ~Toggle() { live--; }
+    void operator()() { *pin = !*pin; toggles++; }
+    int *pin;
+    int toggles;
+};
+int Toggle::live = 0;
+
+struct Scale {
+    Scale(int factor) : factor(factor) {}
+    int operator()(int value) { return value * factor; }
+    int factor;
+};
+
+TEST(static_member_and_function_object) {
+    uint32_t before = allocations;
+
+    Callback<void()> empty;
+    CHECK(!empty.attached());
+    empty.call();
+
+    calls = 0;
+    Callback<void()> function(count_call);
+    function.call();
+    CHECK_EQUAL(1, calls);
+
+    Counter counter;
+    Callback<void()> member(&counter, &Counter::increment);
+    member.call();
+    member.call();
+    CHECK_EQUAL(2, counter.count);
+
+    int pin = 0;
+    Callback<void()> toggle((Toggle(&pin)));
+    toggle.call();
+    CHECK_EQUAL(1, pin);
+    toggle.call();
+    CHECK_EQUAL(0, pin);
+
+    Callback<int(int)> plus(add_one);
+    CHECK_EQUAL(5, plus.call(4));
+    Callback<int(int)> add(&counter, &Counter::add);
+    CHECK_EQUAL(12, add.call(10));
+    Callback<int(int)> scale((Scale(3)));
+    CHECK_EQUAL(21, scale.call(7));
+    Callback<int(int)> none;
+    CHECK_EQUAL(0, none.call(7));
+
+    CHECK_EQUAL(before, allocations);
+}
+
+TEST(copies_own_their_state) {
+    int pin = 0;
+    {
+        Callback<void()> first((Toggle(&pin)));
+        CHECK_EQUAL(1, Toggle::live);
+        first.call();
+
+        Callback<void()> second(first);
+        CHECK_EQUAL(2, Toggle::live);
+        second.call();
+        CHECK_EQUAL(0, pin);
+
+        // the copy has its own toggle count
+        second.call();
+        CHECK_EQUAL(1, pin);
+
+        second.attach(count_call);
+        CHECK_EQUAL(1, Toggle::live);
+        first = second;
+        CHECK_EQUAL(0, Toggle::live);
+        CHECK(first.attached());
+
+        first.attach(Toggle(&pin));
+        first.clear();
+        CHECK(!first.attached());
+    }
+    CHECK_EQUAL(0, Toggle::live);
+}
+
+static int order[8];
+static int order_count = 0;
+
+struct Record {
+    Record(int id) : id(id) {}
+    void operator()() { order[order_count++] = id; }
+    int id;
+};
+
+TEST(fixed_call_chain) {
+    uint32_t before = allocations;
+    FixedCallChain<4> chain;
+    order_count = 0;
+
+    FixedCallChain<4>::pCallback_t second = chain.add(Record(2));
+    CHECK(second != NULL);
+    chain.add(Record(3));
+    chain.add_front(Record(1));
+    calls = 0;
+    chain.add(count_call);
+    CHECK_EQUAL(4, chain.size());
+    CHECK(chain.add(Record(5)) == NULL);
+    CHECK(chain.add_front(Record(0)) == NULL);
+
+    chain.call();
+    CHECK_EQUAL(3, order_count);
+    CHECK_EQUAL(1, order[0]);
+    CHECK_EQUAL(2, order[1]);
+    CHECK_EQUAL(3, order[2]);
+    CHECK_EQUAL(1, calls);
+
+    // add_front moved the second function to index 1
+    CHECK_EQUAL(1, chain.find(chain.get(1)));
+    CHECK(chain.remove(chain.get(1)));
+    CHECK(!chain.remove(NULL));
+    CHECK_EQUAL(3, chain.size());
+    CHECK(chain.get(3) == NULL);
+    order_count = 0;
+    chain.call();
+    CHECK_EQUAL(2, order_count);
+    CHECK_EQUAL(3, order[1]);
+
+    chain.clear();
+    CHECK_EQUAL(0, chain.size());
+    CHECK_EQUAL(before, allocations);
+}
+
+/*--------------------------- Benchmark ------------------------------------*/
+
+/* Calls through a FunctionPointer and a Callback of the same function; a function
+ object only fits a Callback */
+
+#define ROUNDS 20000000
+
+TEST(benchmark_against_function_pointer) {
+    Counter counter;
+
+    FunctionPointer pointer(count_call);
+    calls = 0;
+    uint64_t start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+        pointer.call();
+    host_test::report("FunctionPointer, static", ROUNDS, host_test::now_ns() - start);
+
+    Callback<void()> callback(count_call);
+    start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+        callback.call();
+    host_test::report("Callback, static", ROUNDS, host_test::now_ns() - start);
+    CHECK_EQUAL(2 * ROUNDS, calls);
+
+    FunctionPointer member_pointer(&counter, &Counter::increment);
+    start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+        member_pointer.call();
+    host_test::report("FunctionPointer, member", ROUNDS, host_test::now_ns() - start);
+
+    Callback<void()> member_callback(&counter, &Counter::increment);
+    start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+        member_callback.call();
+    host_test::report("Callback, member", ROUNDS, host_test::now_ns() - start);
+    CHECK_EQUAL(2 * ROUNDS, counter.count);
+
+    int pin = 0;
+    Callback<void()> object((Toggle(&pin)));
+    start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+        object.call();
+    host_test::report("Callback, function object", ROUNDS, host_test::now_ns() - start);
+    CHECK_EQUAL(0, pin);
+}
@@ -0,0 +1,200 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <time.h>
+#include "host_test.h"
+#include "ChainStage.h"
+#include "RtosTimer.h"
+#include "Thread.h"
+#include "us_ticker_api.h"
+
+using namespace rtos;
+
+static void join(Thread &thread) {
+    while (thread.get_state() != Thread::Inactive)
+        Thread::wait(1);
+}
+
+static volatile uint32_t steps[3];
+
+static void count_step(void const *argument) {
+    steps[(intptr_t)argument]++;
+}
+
+TEST(decimation_and_pending_activations) {
+    ChainStage first(count_step, (void*)0);
+    ChainStage second(count_step, (void*)1, 4);
+    ChainStage third(count_step, (void*)2);
+    CHECK(&first.then(second) == &second);
+    second.then(third);
+
+    // activations before the thread runs are merged into one step
+    first.activate();
+    first.activate();
+    first.activate();
+    Thread third_thread(ChainStage::thread, &third, osPriorityAboveNormal);
+    Thread second_thread(ChainStage::thread, &second, osPriorityAboveNormal);
+    Thread first_thread(ChainStage::thread, &first, osPriorityAboveNormal);
+    Thread::wait(20);
+    CHECK_EQUAL(1, first.runs());
+    CHECK_EQUAL(2, first.overruns());
+    CHECK_EQUAL(1, second.runs());
+
+    for (int i = 0; i < 39; i++) {
+        first.activate();
+        Thread::wait(2);
+    }
+    Thread::wait(20);
+    CHECK_EQUAL(40, first.runs());
+    CHECK_EQUAL(40, second.runs());
+    CHECK_EQUAL(10, third.runs());
+    CHECK_EQUAL(10, steps[2]);
+    CHECK_EQUAL(0, second.overruns());
+
+    first_thread.terminate();
+    second_thread.terminate();
+    third_thread.terminate();
+    join(first_thread);
+    join(second_thread);
+    join(third_thread);
+}
+
+/* The pipeline of main.cpp at ten times the rate: pedal samples, simulation steps every 5 ms and
+ an average of every 4th step, once as a chain started by a timer and once as three threads
+ released by their own periods (pedals at 10 ms, as without ACTIVATION_CHAIN). The latency is the
+ age of the newest pedal sample when the average is computed; the chain samples twice as often and
+ wakes the timer thread as well, which shows in its cpu time. Host threads are switched by the
+ host kernel, so the difference of the two runs is what carries over to the target. */
+
+#define PERIOD_MS   5
+#define RUN_MS      2000
+
+struct Pipeline {
+    volatile uint32_t sample_us;
+    volatile uint32_t simulated_us;
+    uint32_t averages;
+    uint64_t latency_us;
+    uint32_t max_latency_us;
+
+    void reset() {
+        sample_us = simulated_us = 0;
+        averages = 0;
+        latency_us = 0;
+        max_latency_us = 0;
+    }
+};
+
+static Pipeline pipeline;
+
+static void sample(void const *argument) {
+    pipeline.sample_us = us_ticker_read();
+}
+
+static void simulate(void const *argument) {
+    pipeline.simulated_us = pipeline.sample_us;
+}
+
+static void average(void const *argument) {
+    if (pipeline.simulated_us == 0)
+        return;
+    uint32_t latency_us = us_ticker_read() - pipeline.simulated_us;
+    pipeline.averages++;
+    pipeline.latency_us += latency_us;
+    if (latency_us > pipeline.max_latency_us)
+        pipeline.max_latency_us = latency_us;
+}
+
+struct periodic_t {
+    void (*step)(void const *argument);
+    uint32_t period;
+};
+
+static void periodic(void const *argument) {
+    const periodic_t *task = (const periodic_t*)argument;
+    osThreadSetPeriod(Thread::gettid(), task->period, 0);
+    while (true) {
+        task->step(NULL);
+        Thread::wait_period();
+    }
+}
+
+static uint64_t cpu_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+static void report(const char *name, uint64_t cpu) {
+    printf("    %-20s %4u averages, latency mean %5u us, max %5u us, cpu %6u ns per average\n", name,
+           (unsigned)pipeline.averages, (unsigned)(pipeline.latency_us / pipeline.averages),
+           (unsigned)pipeline.max_latency_us, (unsigned)(cpu / pipeline.averages));
+}
+
+TEST(bench_chain_against_periodic_threads) {
+    pipeline.reset();
+    ChainStage sample_stage(sample);
+    ChainStage simulation_stage(simulate, NULL, 4);
+    ChainStage average_stage(average);
+    sample_stage.then(simulation_stage).then(average_stage);
+    Thread simulation_thread(ChainStage::thread, &simulation_stage, osPriorityRealtime);
+    Thread sample_thread(ChainStage::thread, &sample_stage, osPriorityHigh);
+    Thread average_thread(ChainStage::thread, &average_stage, osPriorityAboveNormal);
+    RtosTimer timer(ChainStage::trigger, osTimerPeriodic, &sample_stage);
+
+    uint64_t cpu = cpu_ns();
+    timer.start(PERIOD_MS);
+    Thread::wait(RUN_MS);
+    timer.stop();
+    cpu = cpu_ns() - cpu;
+    report("activation chain", cpu);
+    uint32_t chain_mean_us = pipeline.latency_us / pipeline.averages;
+    uint32_t chain_averages = pipeline.averages;
+    CHECK_EQUAL(0, simulation_stage.overruns() + average_stage.overruns());
+    simulation_thread.terminate();
+    sample_thread.terminate();
+    average_thread.terminate();
+    join(simulation_thread);
+    join(sample_thread);
+    join(average_thread);
+
+    pipeline.reset();
+    static const periodic_t sample_task = { sample, 2 * PERIOD_MS };
+    static const periodic_t simulation_task = { simulate, PERIOD_MS };
+    static const periodic_t average_task = { average, 4 * PERIOD_MS };
+    cpu = cpu_ns();
+    Thread periodic_simulation(periodic, (void*)&simulation_task, osPriorityRealtime);
+    Thread periodic_sample(periodic, (void*)&sample_task, osPriorityHigh);
+    Thread periodic_average(periodic, (void*)&average_task, osPriorityAboveNormal);
+    Thread::wait(RUN_MS);
+    cpu = cpu_ns() - cpu;
+    report("periodic threads", cpu);
+    periodic_simulation.terminate();
+    periodic_sample.terminate();
+    periodic_average.terminate();
+    join(periodic_simulation);
+    join(periodic_sample);
+    join(periodic_average);
+
+    // one average per 4 timer periods, less the first ones before a step was simulated
+    CHECK(chain_averages > RUN_MS / (4 * PERIOD_MS) * 9 / 10);
+    // a periodic average sees a sample of up to a sample period and a simulation period ago
+    CHECK(chain_mean_us < pipeline.latency_us / pipeline.averages);
+}
@@ -0,0 +1,189 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "host_port.h"
+#include "AgeMonitor.h"
+#include "RateTransition.h"
+#include "Topic.h"
+
+using namespace rtos;
+
+/* Simulation of the pedal to output pipeline of main.cpp on the virtual us_ticker, with the
+ stages, rates and priorities of the independent threads:
+
+   readBreakAndAccel 10 Hz -> carSimulation 20 Hz -> getAverageSpeed 5 Hz -> servo 1 Hz
+                                                                           -> LCD 2 Hz
+
+ The stages take no time, due stages run in priority order. Every run starts the stages with
+ other phases, as the threads of the target start at arbitrary points of their periods. */
+
+struct pedals_t {
+    float accelerationValue;
+    float brakeValue;
+};
+
+struct speeds_t {
+    Stamped<float> speeds[3];
+};
+
+static RateTransition<Stamped<pedals_t> > pedals;
+static RateTransition<speeds_t> lastSpeeds;
+static Topic<Stamped<float> > averageSpeed;
+static speeds_t recentSpeeds;
+static int counter;
+static uint32_t pedalSample;
+static uint32_t shownVersion;
+static uint32_t alarms;
+
+static AgeMonitor servoAge("servo");
+static AgeMonitor lcdAge("lcd", 0, 10000);
+
+static void carSimulation() {
+    pedals.update();
+    Stamped<float> speed;
+    speed.value = pedals.value().value.accelerationValue * 10;
+    speed.derive(pedals.value());
+    recentSpeeds.speeds[counter] = speed;
+    counter = (counter + 1) % 3;
+    lastSpeeds.publish(recentSpeeds);
+}
+
+static void readBreakAndAccel() {
+    Stamped<pedals_t> pedal;
+    pedal.capture(++pedalSample);
+    pedal.value.accelerationValue = 0.5f;
+    pedal.value.brakeValue = 0.0f;
+    pedals.publish(pedal);
+}
+
+static void getAverageSpeed() {
+    lastSpeeds.update();
+    const speeds_t &recent = lastSpeeds.value();
+    Stamped<float> average = recent.speeds[0];
+    float sum = 0;
+    for (int i = 0; i < 3; i++) {
+        sum += recent.speeds[i].value;
+        average.derive_oldest(recent.speeds[i]);
+    }
+    average.value = sum / 3;
+    averageSpeed.publish(average);
+}
+
+static void showAverageSpeed() {
+    Stamped<float> speed;
+    // averages of the zero speeds before the first three simulation steps have no source sample
+    if (averageSpeed.read_if_changed(speed, shownVersion) && (speed.seq != 0))
+        servoAge.record(speed);
+}
+
+static void updateOdometer() {
+    Stamped<float> speed = averageSpeed.get();
+    if (speed.seq != 0)
+        lcdAge.record(speed);
+}
+
+static void count_alarm(AgeMonitor &monitor, uint32_t age_us, uint32_t seq) {
+    alarms++;
+}
+
+struct Stage {
+    void (*run)();
+    uint32_t period_us;
+    uint32_t next_us;
+};
+
+/* highest priority first, as carPriorities in main.cpp; the outputs run in the cooperative thread */
+static Stage stages[] = {
+    { carSimulation,    50000, 0 },
+    { readBreakAndAccel, 100000, 0 },
+    { getAverageSpeed,  200000, 0 },
+    { showAverageSpeed, 1000000, 0 },
+    { updateOdometer,   500000, 0 },
+};
+static const int STAGES = sizeof(stages) / sizeof(stages[0]);
+
+static uint32_t random_state = 12345;
+
+static uint32_t random_below(uint32_t limit) {
+    random_state = random_state * 1103515245 + 12345;
+    return (random_state >> 8) % limit;
+}
+
+/* one run of the pipeline with random phases, in 1 ms steps; the data flows on from the previous run */
+static void run_pipeline(uint32_t start_us, uint32_t duration_us) {
+    for (int i = 0; i < STAGES; i++)
+        stages[i].next_us = start_us + random_below(stages[i].period_us / 1000) * 1000;
+
+    for (uint32_t now_us = start_us; now_us < start_us + duration_us; now_us += 1000) {
+        host_ticker_set(now_us);
+        for (int i = 0; i < STAGES; i++) {
+            if (now_us == stages[i].next_us) {
+                stages[i].run();
+                stages[i].next_us += stages[i].period_us;
+            }
+        }
+    }
+}
+
+static void print_histogram(const AgeMonitor &monitor) {
+    printf("    pedal to %s: %u samples, mean %u ms, max %u ms\n", monitor.name(),
+           (unsigned)monitor.samples(), (unsigned)(monitor.mean_age_us() / 1000),
+           (unsigned)(monitor.max_age_us() / 1000));
+    for (uint32_t i = 0; i < AgeMonitor::buckets; i++) {
+        if (monitor.count(i) == 0)
+            continue;
+        if (monitor.bucket_limit_us(i) != 0)
+            printf("      < %5u ms: %u\n", (unsigned)(monitor.bucket_limit_us(i) / 1000), (unsigned)monitor.count(i));
+        else
+            printf("      older:     %u\n", (unsigned)monitor.count(i));
+    }
+}
+
+#define RUNS 50
+#define RUN_US 60000000
+
+TEST(pedal_to_output_latency_distribution) {
+    host_ticker_virtual(true);
+    // tighter than staleAge_us of main.cpp, so the alarm path is taken
+    lcdAge.set_alarm(400000, count_alarm);
+
+    uint32_t start_us = 1000000;
+    for (int run = 0; run < RUNS; run++) {
+        run_pipeline(start_us, RUN_US);
+        start_us += RUN_US;
+    }
+    host_ticker_virtual(false);
+
+    print_histogram(servoAge);
+    print_histogram(lcdAge);
+    printf("    LCD stale alarms above 400 ms: %u\n", (unsigned)alarms);
+
+    // a pedal sample waits for the simulation (< 100 ms), is the oldest of 3 speeds
+    // (< 100 ms more), waits for the average (< 200 ms) and for the output
+    CHECK(servoAge.samples() > 0);
+    CHECK(lcdAge.samples() > 0);
+    CHECK(servoAge.max_age_us() < 100000 + 100000 + 200000 + 1000000);
+    CHECK(lcdAge.max_age_us() < 100000 + 100000 + 200000 + 500000);
+    CHECK(lcdAge.max_age_us() > 400000);
+    CHECK_EQUAL(lcdAge.stale(), alarms);
+    CHECK(alarms > 0);
+}
@@ -0,0 +1,263 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+
+#include <string.h>
+
+/* rt_TypeDef.h defines NULL as in C, use 0 below */
+#undef NULL
+
+extern "C" {
+#include "rt_TypeDef.h"
+#include "rt_List.h"
+#include "rt_Task.h"
+#include "rt_Mutex.h"
+#include "rt_Time.h"
+#include "rt_System.h"
+
+/* writable in port/host_rtx.c */
+extern unsigned char os_edf;
+extern unsigned int host_rtx_errors;
+}
+
+/* Simulation of periodic tasks on the RTX scheduler: every tick the running task
+ executes one tick of its job, a completed job calls rt_period_wait(), then the
+ tick ends with rt_systick(). The task switches requested by the kernel take
+ effect at once. */
+struct SimTask {
+    struct OS_TCB tcb;
+    uint32_t wcet;
+    uint32_t left;
+    uint32_t jobs;
+};
+
+static const int MAX_TASKS = 4;
+static SimTask tasks[MAX_TASKS];
+static int task_count;
+
+static void sim_reset(bool edf) {
+    memset(tasks, 0, sizeof(tasks));
+    memset(&os_rdy, 0, sizeof(os_rdy));
+    memset(&os_dly, 0, sizeof(os_dly));
+    memset(&os_idle_TCB, 0, sizeof(os_idle_TCB));
+    memset(&os_tsk, 0, sizeof(os_tsk));
+    task_count = 0;
+    os_time = 0;
+    os_edf = edf;
+    host_rtx_errors = 0;
+
+    os_idle_TCB.cb_type = TCB;
+    os_idle_TCB.task_id = 0xFF;
+    os_idle_TCB.state = READY;
+    rt_put_prio(&os_rdy, &os_idle_TCB);
+}
+
+static SimTask *sim_add(U8 prio, uint32_t period, uint32_t deadline, uint32_t wcet) {
+    SimTask *task = &tasks[task_count++];
+    task->tcb.cb_type = TCB;
+    task->tcb.task_id = task_count;
+    task->tcb.prio = prio;
+    task->tcb.state = INACTIVE;
+    rt_period_set(&task->tcb, period, deadline);
+    task->tcb.state = READY;
+    rt_put_prio(&os_rdy, &task->tcb);
+    task->wcet = task->left = wcet;
+    return task;
+}
+
+static void sim_start() {
+    os_tsk.run = os_tsk.new_tsk = rt_get_first(&os_rdy);
+    os_tsk.run->state = RUNNING;
+}
+
+static SimTask *running() {
+    for (int i = 0; i < task_count; i++) {
+        if (os_tsk.run == &tasks[i].tcb)
+            return &tasks[i];
+    }
+    return 0;
+}
+
+static void sim_tick() {
+    SimTask *task = running();
+    if ((task != 0) && (--task->left == 0)) {
+        task->left = task->wcet;
+        task->jobs++;
+        rt_period_wait();
+        os_tsk.run = os_tsk.new_tsk;
+    }
+    rt_systick();
+    os_tsk.run = os_tsk.new_tsk;
+}
+
+static uint32_t sim_run(uint32_t ticks) {
+    uint32_t misses = 0;
+    for (uint32_t t = 0; t < ticks; t++)
+        sim_tick();
+    for (int i = 0; i < task_count; i++)
+        misses += tasks[i].tcb.dl_miss;
+    return misses;
+}
+
+/* (wcet, period) = (1, 4), (2, 6), (4, 10): U = 0.98, above the rate monotonic bound
+ of 0.78 for three tasks; the hyperperiod is 60 ticks */
+static const uint32_t HYPERPERIOD = 60;
+static const uint32_t RUNS = 100;
+
+static void add_high_utilisation_set(bool edf) {
+    /* EDF with equal priorities, fixed priority with rate monotonic priorities */
+    sim_add(edf ? 1 : 3, 4, 4, 1);
+    sim_add(edf ? 1 : 2, 6, 6, 2);
+    sim_add(edf ? 1 : 1, 10, 10, 4);
+}
+
+TEST(edf_meets_all_deadlines_at_high_utilisation) {
+    sim_reset(true);
+    add_high_utilisation_set(true);
+    sim_start();
+    uint32_t misses = sim_run(RUNS * HYPERPERIOD);
+
+    CHECK_EQUAL(0, misses);
+    CHECK_EQUAL(RUNS * HYPERPERIOD / 4, tasks[0].jobs);
+    CHECK_EQUAL(RUNS * HYPERPERIOD / 6, tasks[1].jobs);
+    CHECK_EQUAL(RUNS * HYPERPERIOD / 10, tasks[2].jobs);
+    CHECK_EQUAL(0, host_rtx_errors);
+    printf("edf: %u of %u releases missed\n", (unsigned)misses,
+           (unsigned)(RUNS * HYPERPERIOD * (15 + 10 + 6) / 60));
+}
+
+TEST(fixed_priority_misses_at_high_utilisation) {
+    sim_reset(false);
+    add_high_utilisation_set(false);
+    sim_start();
+    uint32_t misses = sim_run(RUNS * HYPERPERIOD);
+
+    /* the two higher priority tasks always meet their deadlines, the lowest one
+     gets 3 ticks in its first period and misses */
+    CHECK_EQUAL(0, tasks[0].tcb.dl_miss);
+    CHECK_EQUAL(0, tasks[1].tcb.dl_miss);
+    CHECK(tasks[2].tcb.dl_miss > 0);
+    CHECK_EQUAL(misses, tasks[2].tcb.dl_miss);
+    printf("fixed priority: %u of %u releases missed\n", (unsigned)misses,
+           (unsigned)(RUNS * HYPERPERIOD * (15 + 10 + 6) / 60));
+}
+
+/* The running task is preempted by the tick while a ready task of the same
+ priority has an earlier deadline: under EDF it has to go behind that task
+ instead of to the front of its priority */
+TEST(preempted_task_is_requeued_by_deadline) {
+    sim_reset(true);
+    SimTask *a = sim_add(1, 10, 5, 10);
+    SimTask *b = sim_add(1, 10, 8, 1);
+    sim_start();
+    CHECK(os_tsk.run == &a->tcb);
+
+    /* the deadline of the running task moves behind the one of b */
+    rt_period_set(&a->tcb, 20, 20);
+    rt_systick();
+    os_tsk.run = os_tsk.new_tsk;
+    CHECK(os_tsk.run == &b->tcb);
+    CHECK(os_rdy.p_lnk == &a->tcb);
+}
+
+TEST(preempted_task_continues_with_fixed_priority) {
+    sim_reset(false);
+    SimTask *a = sim_add(1, 10, 5, 10);
+    sim_add(1, 10, 8, 1);
+    sim_start();
+
+    rt_period_set(&a->tcb, 20, 20);
+    rt_systick();
+    os_tsk.run = os_tsk.new_tsk;
+    CHECK(os_tsk.run == &a->tcb);
+}
+
+/* a owns a mutex that b waits for, then c is released with an earlier deadline
+ than a while a runs; b has the latest deadline */
+static void setup_mutex_handoff(bool edf, struct OS_MUCB *mutex, SimTask **a, SimTask **b, SimTask **c) {
+    /* the tasks are brought into this state by their deadlines */
+    sim_reset(true);
+    *a = sim_add(1, 20, 2, 10);
+    *b = sim_add(1, 20, 4, 1);
+    *c = sim_add(1, 20, 12, 1);
+    sim_start();
+    rt_mut_init(mutex);
+    CHECK_EQUAL(OS_R_OK, rt_mut_wait(mutex, 0xFFFF));
+
+    /* a is preempted by b, b blocks on the mutex and a continues */
+    rt_period_set(&(*a)->tcb, 20, 10);
+    rt_systick();
+    os_tsk.run = os_tsk.new_tsk;
+    CHECK(os_tsk.run == &(*b)->tcb);
+    rt_mut_wait(mutex, 0xFFFF);
+    os_tsk.run = os_tsk.new_tsk;
+    CHECK(os_tsk.run == &(*a)->tcb);
+
+    rt_period_set(&(*b)->tcb, 20, 20);
+    rt_period_set(&(*c)->tcb, 20, 5);
+    os_edf = edf;
+}
+
+/* The release of a mutex hands it over to the waiting task: under EDF the ready
+ task with the earliest deadline runs next, not the releasing task */
+TEST(mutex_handoff_is_ordered_by_deadline) {
+    struct OS_MUCB mutex;
+    SimTask *a, *b, *c;
+    setup_mutex_handoff(true, &mutex, &a, &b, &c);
+
+    CHECK_EQUAL(OS_R_OK, rt_mut_release(&mutex));
+    os_tsk.run = os_tsk.new_tsk;
+    CHECK(mutex.owner == &b->tcb);
+    CHECK(os_tsk.run == &c->tcb);
+    CHECK(os_rdy.p_lnk == &a->tcb);
+    CHECK(os_rdy.p_lnk->p_lnk == &b->tcb);
+}
+
+TEST(mutex_handoff_continues_with_fixed_priority) {
+    struct OS_MUCB mutex;
+    SimTask *a, *b, *c;
+    setup_mutex_handoff(false, &mutex, &a, &b, &c);
+
+    CHECK_EQUAL(OS_R_OK, rt_mut_release(&mutex));
+    os_tsk.run = os_tsk.new_tsk;
+    CHECK(mutex.owner == &b->tcb);
+    CHECK(os_tsk.run == &a->tcb);
+}
+
+/* The release of a mutex without waiting tasks yields to a ready task with an
+ earlier deadline */
+TEST(mutex_release_yields_by_deadline) {
+    sim_reset(true);
+    SimTask *a = sim_add(1, 20, 2, 10);
+    SimTask *c = sim_add(1, 20, 12, 1);
+    sim_start();
+    struct OS_MUCB mutex;
+    rt_mut_init(&mutex);
+    CHECK_EQUAL(OS_R_OK, rt_mut_wait(&mutex, 0xFFFF));
+
+    rt_period_set(&c->tcb, 20, 1);
+    CHECK_EQUAL(OS_R_OK, rt_mut_release(&mutex));
+    os_tsk.run = os_tsk.new_tsk;
+    CHECK(mutex.owner == 0);
+    CHECK(os_tsk.run == &c->tcb);
+    CHECK(os_rdy.p_lnk == &a->tcb);
+}
@@ -0,0 +1,199 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <chrono>
+#include <thread>
+
+#include "host_test.h"
+#include "host_port.h"
+#include "EventFlags.h"
+#include "Semaphore.h"
+#include "Thread.h"
+
+using namespace rtos;
+
+#define PEDALS_UPDATED  0x01
+#define SWITCH_CHANGED  0x02
+#define LOG_FLUSH       0x04
+
+struct Setter {
+    EventFlags *flags;
+    uint32_t value;
+    uint32_t delay_ms;
+    bool isr;
+};
+
+static void set_later(void const *argument) {
+    const Setter *setter = (const Setter*)argument;
+    Thread::wait(setter->delay_ms);
+    if (setter->isr)
+        host_isr_enter();
+    setter->flags->set(setter->value);
+    if (setter->isr)
+        host_isr_exit();
+}
+
+TEST(wait_any_wakes_on_one_flag) {
+    EventFlags flags;
+    Setter setter = { &flags, SWITCH_CHANGED, 20, false };
+    Thread thread(set_later, &setter);
+    CHECK_EQUAL(SWITCH_CHANGED, flags.wait_any(PEDALS_UPDATED | SWITCH_CHANGED | LOG_FLUSH));
+    CHECK_EQUAL(0, flags.get());
+}
+
+TEST(wait_all_needs_every_flag) {
+    EventFlags flags(PEDALS_UPDATED);
+    Setter setter = { &flags, SWITCH_CHANGED, 20, false };
+    Thread thread(set_later, &setter);
+    CHECK_EQUAL(0, flags.wait_all(PEDALS_UPDATED | SWITCH_CHANGED, 5));
+    CHECK_EQUAL(PEDALS_UPDATED | SWITCH_CHANGED, flags.wait_all(PEDALS_UPDATED | SWITCH_CHANGED));
+    CHECK_EQUAL(0, flags.get());
+}
+
+TEST(flags_are_kept_until_consumed) {
+    EventFlags flags;
+    flags.set(LOG_FLUSH);
+    flags.set(PEDALS_UPDATED);
+    CHECK_EQUAL(PEDALS_UPDATED | LOG_FLUSH, flags.wait_any(PEDALS_UPDATED, 0, false));
+    CHECK_EQUAL(PEDALS_UPDATED | LOG_FLUSH, flags.wait_any(PEDALS_UPDATED, 0));
+    CHECK_EQUAL(LOG_FLUSH, flags.get());
+    CHECK_EQUAL(LOG_FLUSH, flags.clear());
+    CHECK_EQUAL(0, flags.get());
+}
+
+TEST(wait_times_out) {
+    EventFlags flags;
+    uint64_t start = host_test::now_ns();
+    CHECK_EQUAL(0, flags.wait_any(PEDALS_UPDATED, 30));
+    uint64_t elapsed_ms = (host_test::now_ns() - start) / 1000000;
+    CHECK(elapsed_ms >= 29);
+    CHECK(elapsed_ms < 200);
+    CHECK_EQUAL(0, flags.wait_any(0, 0));
+}
+
+TEST(set_from_isr_wakes_the_waiter) {
+    EventFlags flags;
+    Setter setter = { &flags, PEDALS_UPDATED, 20, true };
+    Thread thread(set_later, &setter);
+    CHECK_EQUAL(PEDALS_UPDATED, flags.wait_any(PEDALS_UPDATED, 1000));
+}
+
+struct Waiter {
+    EventFlags *flags;
+    Semaphore waiting;
+    uint32_t result;
+
+    Waiter(EventFlags *flags) : flags(flags), waiting(0), result(0xFFFFFFFF) {
+    }
+};
+
+static void wait_for_pedals(void const *argument) {
+    Waiter *waiter = (Waiter*)argument;
+    waiter->waiting.release();
+    waiter->result = waiter->flags->wait_any(PEDALS_UPDATED, 1000);
+}
+
+TEST(only_one_thread_waits) {
+    EventFlags flags;
+    Waiter waiter(&flags);
+    Thread thread(wait_for_pedals, &waiter);
+    waiter.waiting.wait();
+    Thread::wait(10);
+    CHECK_EQUAL(0, flags.wait_any(PEDALS_UPDATED, 10));
+    flags.set(PEDALS_UPDATED);
+    Thread::wait(20);
+    CHECK_EQUAL(PEDALS_UPDATED, waiter.result);
+}
+
+/*--------------------------- Latency benchmark ----------------------------*/
+
+/* Time from the event until the consumer runs: EventFlags wakes the consumer, the
+ polling consumer checks a semaphore every POLL_MS as main.cpp does. */
+
+#define ROUNDS  100
+#define POLL_MS 1
+
+struct Latency {
+    EventFlags flags;
+    Semaphore event;
+    Semaphore handled;
+    volatile uint64_t set_ns;
+    uint64_t total_ns;
+    uint64_t max_ns;
+
+    Latency() : event(0), handled(0), set_ns(0), total_ns(0), max_ns(0) {
+    }
+
+    void record() {
+        uint64_t latency = host_test::now_ns() - set_ns;
+        total_ns += latency;
+        if (latency > max_ns)
+            max_ns = latency;
+        handled.release();
+    }
+};
+
+static void flags_consumer(void const *argument) {
+    Latency *latency = (Latency*)argument;
+    for (int i = 0; i < ROUNDS; i++) {
+        latency->flags.wait_any(PEDALS_UPDATED | SWITCH_CHANGED);
+        latency->record();
+    }
+}
+
+static void polling_consumer(void const *argument) {
+    Latency *latency = (Latency*)argument;
+    for (int i = 0; i < ROUNDS; i++) {
+        while (latency->event.wait(0) == 0)
+            Thread::wait(POLL_MS);
+        latency->record();
+    }
+}
+
+static void produce(Latency &latency, bool flags) {
+    for (int i = 0; i < ROUNDS; i++) {
+        // let the consumer block or go back to polling first, then spread the events
+        // over the polling period
+        Thread::wait(2);
+        std::this_thread::sleep_for(std::chrono::microseconds(i * 37 % 1000));
+        latency.set_ns = host_test::now_ns();
+        if (flags)
+            latency.flags.set((i & 1) ? PEDALS_UPDATED : SWITCH_CHANGED);
+        else
+            latency.event.release();
+        latency.handled.wait();
+    }
+    printf("  %-40s mean %6.1f us, max %6.1f us\n",
+           flags ? "EventFlags wake-up" : "semaphore polled every 1 ms",
+           latency.total_ns / 1000.0 / ROUNDS, latency.max_ns / 1000.0);
+}
+
+TEST(benchmark_wakeup_latency) {
+    Latency flags_latency;
+    Thread flags_thread(flags_consumer, &flags_latency);
+    produce(flags_latency, true);
+
+    Latency polling_latency;
+    Thread polling_thread(polling_consumer, &polling_latency);
+    produce(polling_latency, false);
+
+    CHECK(flags_latency.total_ns < polling_latency.total_ns);
+}
@@ -0,0 +1,227 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "host_port.h"
+#include "EventQueue.h"
+#include "Semaphore.h"
+#include "Thread.h"
+
+using namespace rtos;
+
+/* Producer threads stand in for interrupt handlers: half of them post in interrupt
+ context (host_isr_enter, which also serialises them as one interrupt level), the
+ others post as threads, so posts of both kinds overlap. */
+
+#define PRODUCERS   4
+#define POSTS       20000
+#define QUEUE_SIZE  64
+
+struct Received {
+    uint32_t count[PRODUCERS];
+    uint32_t next[PRODUCERS];
+    uint32_t out_of_order;
+
+    Received() : out_of_order(0) {
+        for (int i = 0; i < PRODUCERS; i++)
+            count[i] = next[i] = 0;
+    }
+};
+
+/* A posted function object carrying its producer and sequence number */
+struct Work {
+    Received *received;
+    uint32_t producer;
+    uint32_t sequence;
+
+    void operator()() {
+        if (sequence != received->next[producer])
+            received->out_of_order++;
+        received->next[producer] = sequence + 1;
+        received->count[producer]++;
+    }
+};
+
+struct Producer {
+    EventQueue *queue;
+    Received *received;
+    Semaphore *done;
+    uint32_t id;
+    uint32_t retries;
+};
+
+static void produce(void const *argument) {
+    Producer *producer = (Producer*)argument;
+    bool isr = (producer->id & 1) != 0;
+    for (uint32_t i = 0; i < POSTS; i++) {
+        Work work = { producer->received, producer->id, i };
+        while (true) {
+            if (isr)
+                host_isr_enter();
+            bool posted = producer->queue->post(work);
+            if (isr)
+                host_isr_exit();
+            if (posted)
+                break;
+            // full: a real handler drops the event, the test retries to check all of them
+            producer->retries++;
+            Thread::yield();
+        }
+    }
+    producer->done->release();
+}
+
+TEST(multiple_producers) {
+    static StaticEventQueue<QUEUE_SIZE> queue;
+    Received received;
+    Semaphore done(0);
+    Thread worker(EventQueue::thread, &queue, osPriorityHigh);
+
+    Producer producers[PRODUCERS];
+    Thread *threads[PRODUCERS];
+    for (uint32_t i = 0; i < PRODUCERS; i++) {
+        Producer producer = { &queue, &received, &done, i, 0 };
+        producers[i] = producer;
+        threads[i] = new Thread(produce, &producers[i]);
+    }
+    uint32_t retries = 0;
+    for (int i = 0; i < PRODUCERS; i++) {
+        done.wait();
+    }
+    for (int i = 0; i < PRODUCERS; i++) {
+        delete threads[i];
+        retries += producers[i].retries;
+    }
+    // the last posts may still be dispatched
+    for (int wait = 0; (queue.dispatched() < PRODUCERS * POSTS) && (wait < 1000); wait++)
+        Thread::wait(1);
+
+    CHECK_EQUAL(PRODUCERS * POSTS, queue.dispatched());
+    CHECK_EQUAL(retries, queue.overflows());
+    CHECK_EQUAL(0, received.out_of_order);
+    for (int i = 0; i < PRODUCERS; i++)
+        CHECK_EQUAL(POSTS, received.count[i]);
+    printf("  %u posts, %u overflows\n", (unsigned)(PRODUCERS * POSTS), (unsigned)queue.overflows());
+}
+
+static void count_call(void *argument) {
+    (*(uint32_t*)argument)++;
+}
+
+struct Counter {
+    uint32_t calls;
+
+    void increment() {
+        calls++;
+    }
+};
+
+TEST(post_kinds_and_overflow) {
+    StaticEventQueue<4> queue;
+    uint32_t calls = 0;
+    Counter counter = { 0 };
+
+    CHECK(!queue.post((void (*)(void*))NULL));
+    CHECK(!queue.post(EventQueue::callback_t()));
+    CHECK(queue.post(count_call, &calls));
+    CHECK(queue.post(&counter, &Counter::increment));
+    CHECK(queue.post(count_call, &calls));
+    CHECK(queue.post(&counter, &Counter::increment));
+    CHECK(!queue.post(count_call, &calls));
+    CHECK_EQUAL(1, queue.overflows());
+
+    CHECK_EQUAL(4, queue.dispatch());
+    CHECK_EQUAL(2, calls);
+    CHECK_EQUAL(2, counter.calls);
+    CHECK_EQUAL(0, queue.dispatch());
+    CHECK_EQUAL(4, queue.dispatched());
+
+    // the ring wraps around
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 3; i++)
+            CHECK(queue.post(count_call, &calls));
+        CHECK_EQUAL(3, queue.dispatch());
+    }
+    CHECK_EQUAL(11, calls);
+}
+
+/*--------------------------- Throughput benchmark -------------------------*/
+
+/* Posts from interrupt context drained by a worker thread: EventQueue against a
+ CMSIS message queue carrying a value and dispatched by hand */
+
+#define BENCH_POSTS 200000
+
+static void nothing(void *argument) {
+    (void)argument;
+}
+
+TEST(benchmark_throughput) {
+    static StaticEventQueue<QUEUE_SIZE> queue;
+    Thread worker(EventQueue::thread, &queue, osPriorityHigh);
+    uint64_t start = host_test::now_ns();
+    for (uint32_t i = 0; i < BENCH_POSTS; i++) {
+        host_isr_enter();
+        bool posted = queue.post(nothing);
+        host_isr_exit();
+        if (!posted)
+            Thread::yield();
+    }
+    while (queue.dispatched() + queue.overflows() < BENCH_POSTS)
+        Thread::yield();
+    host_test::report("EventQueue post from ISR", BENCH_POSTS, host_test::now_ns() - start);
+}
+
+static osMessageQId message_queue;
+static volatile uint32_t messages;
+
+static void message_worker(void const *argument) {
+    (void)argument;
+    while (true) {
+        osEvent event = osMessageGet(message_queue, osWaitForever);
+        if (event.status == osEventMessage) {
+            nothing(event.value.p);
+            messages++;
+        }
+    }
+}
+
+TEST(benchmark_throughput_message_queue) {
+    osMessageQDef_t message_def;
+    message_def.queue_sz = QUEUE_SIZE;
+    message_def.pool = NULL;
+    message_queue = osMessageCreate(&message_def, NULL);
+    Thread worker(message_worker, NULL, osPriorityHigh);
+    uint32_t dropped = 0;
+    uint64_t start = host_test::now_ns();
+    for (uint32_t i = 0; i < BENCH_POSTS; i++) {
+        host_isr_enter();
+        osStatus status = osMessagePut(message_queue, i, 0);
+        host_isr_exit();
+        if (status != osOK) {
+            dropped++;
+            Thread::yield();
+        }
+    }
+    while (messages + dropped < BENCH_POSTS)
+        Thread::yield();
+    host_test::report("osMessagePut from ISR", BENCH_POSTS, host_test::now_ns() - start);
+}
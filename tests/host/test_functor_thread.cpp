@@ -0,0 +1,140 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "Thread.h"
+#include "RtosTimer.h"
+
+using namespace rtos;
+
+/* The state of one simulated car, owned by the task running it */
+struct CarState {
+    float speed;
+    uint32_t steps;
+    uint64_t first_ns;
+    uint64_t last_ns;
+};
+
+/* The same task body for every car: integrate a constant acceleration */
+struct CarTask {
+    CarTask(CarState *state, float acceleration, uint32_t steps)
+        : state(state), acceleration(acceleration), steps(steps) {}
+
+    void operator()() {
+        state->first_ns = host_test::now_ns();
+        for (uint32_t i = 0; i < steps; i++) {
+            state->speed += acceleration;
+            state->steps++;
+            Thread::wait(1);
+        }
+        state->last_ns = host_test::now_ns();
+    }
+
+    CarState *state;
+    float acceleration;
+    uint32_t steps;
+};
+
+static void join(Thread &thread) {
+    while (thread.get_state() != Thread::Inactive)
+        Thread::wait(1);
+}
+
+TEST(two_instances_of_one_task_run_concurrently) {
+    CarState first = { 0, 0, 0, 0 };
+    CarState second = { 0, 0, 0, 0 };
+    {
+        Thread car1(CarTask(&first, 1.0f, 40));
+        Thread car2(CarTask(&second, -0.5f, 60));
+        join(car1);
+        join(car2);
+    }
+    CHECK_EQUAL(40, first.steps);
+    CHECK_EQUAL(60, second.steps);
+    CHECK(first.speed == 40.0f);
+    CHECK(second.speed == -30.0f);
+    // both ran at the same time, not one after the other
+    CHECK(first.first_ns < second.last_ns);
+    CHECK(second.first_ns < first.last_ns);
+}
+
+/* the Thread runs its own copy of the function object */
+struct CopyCheck {
+    CopyCheck(int *seen) : value(1), seen(seen) {}
+    void operator()() { *seen = value; }
+    int value;
+    int *seen;
+};
+
+TEST(thread_keeps_a_copy_of_the_function_object) {
+    int seen = 0;
+    CopyCheck task(&seen);
+    Thread thread(task, osPriorityBelowNormal);
+    task.value = 2;
+    join(thread);
+    CHECK_EQUAL(1, seen);
+}
+
+static volatile int plain_calls = 0;
+
+static void plain_task(void const *argument) {
+    plain_calls += *(const int*)argument;
+}
+
+TEST(function_pointer_constructors_still_work) {
+    int increment = 3;
+    Thread thread(plain_task, &increment);
+    join(thread);
+    CHECK_EQUAL(3, plain_calls);
+
+    RtosTimer timer(plain_task, osTimerOnce, &increment);
+    CHECK_EQUAL(osOK, timer.start(5));
+    Thread::wait(50);
+    CHECK_EQUAL(6, plain_calls);
+}
+
+/* Two timers of the same function object type, each counting into its own state */
+struct Blink {
+    Blink(uint32_t *count) : count(count) {}
+    void operator()() { (*count)++; }
+    uint32_t *count;
+};
+
+TEST(timers_with_function_objects) {
+    uint32_t fast = 0, slow = 0, once = 0, elapsed_ms = 0;
+    {
+        RtosTimer fast_timer((Blink(&fast)));
+        RtosTimer slow_timer((Blink(&slow)));
+        RtosTimer once_timer(Blink(&once), osTimerOnce);
+        CHECK_EQUAL(osOK, fast_timer.start(5));
+        CHECK_EQUAL(osOK, slow_timer.start(20));
+        CHECK_EQUAL(osOK, once_timer.start(5));
+        uint64_t start = host_test::now_ns();
+        Thread::wait(200);
+        fast_timer.stop();
+        slow_timer.stop();
+        elapsed_ms = (uint32_t)((host_test::now_ns() - start) / 1000000);
+    }
+    printf("    5 ms timer: %u calls, 20 ms timer: %u calls\n", (unsigned)fast, (unsigned)slow);
+    CHECK_EQUAL(1, once);
+    CHECK(fast >= 20 && fast <= elapsed_ms / 5);
+    CHECK(slow >= 5 && slow <= elapsed_ms / 20);
+}
@@ -0,0 +1,190 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+
+#include <string.h>
+
+/* rt_TypeDef.h defines NULL as in C, use 0 below */
+#undef NULL
+
+extern "C" {
+#include "rt_TypeDef.h"
+#include "rt_List.h"
+#include "rt_Task.h"
+#include "rt_Time.h"
+#include "rt_System.h"
+#include "rt_MemBox.h"
+
+/* writable in port/host_rtx.c */
+extern unsigned char os_edf;
+extern unsigned int host_rtx_errors;
+extern unsigned int os_fifo[];
+extern unsigned char const os_fifo_size;
+}
+
+/* The counters of osKernelGetStats, driven through the kernel sources. The SVC count is
+ kept by the SVC_Handler assembly of HAL_CM3.c, and rt_resume unlocks the scheduler through
+ the NVIC, so neither is covered on host. */
+
+struct SimTask {
+    struct OS_TCB tcb;
+    uint32_t wcet;
+    uint32_t left;
+};
+
+static SimTask tasks[2];
+static uint32_t expected_switches;
+
+static void kernel_reset() {
+    memset(tasks, 0, sizeof(tasks));
+    memset(&os_rdy, 0, sizeof(os_rdy));
+    memset(&os_dly, 0, sizeof(os_dly));
+    memset(&os_idle_TCB, 0, sizeof(os_idle_TCB));
+    memset(&os_tsk, 0, sizeof(os_tsk));
+    memset(&os_stat, 0, sizeof(os_stat));
+    os_time = 0;
+    os_edf = 0;
+    host_rtx_errors = 0;
+    expected_switches = 0;
+
+    os_idle_TCB.cb_type = TCB;
+    os_idle_TCB.task_id = 0xFF;
+    os_idle_TCB.state = READY;
+    rt_put_prio(&os_rdy, &os_idle_TCB);
+}
+
+static void add_task(int i, U8 prio, uint32_t period, uint32_t wcet) {
+    SimTask *task = &tasks[i];
+    task->tcb.cb_type = TCB;
+    task->tcb.task_id = i + 1;
+    task->tcb.prio = prio;
+    task->tcb.state = INACTIVE;
+    rt_period_set(&task->tcb, period, 0);
+    task->tcb.state = READY;
+    rt_put_prio(&os_rdy, &task->tcb);
+    task->wcet = task->left = wcet;
+}
+
+/* a switch requested by the kernel takes effect at once */
+static void take_switch() {
+    if (os_tsk.new_tsk != os_tsk.run) {
+        expected_switches++;
+        os_tsk.run = os_tsk.new_tsk;
+    }
+}
+
+TEST(switches_and_sampled_idle_ticks) {
+    kernel_reset();
+    add_task(0, 2, 4, 1);
+    add_task(1, 1, 10, 2);
+    os_tsk.run = os_tsk.new_tsk = rt_get_first(&os_rdy);
+    os_tsk.run->state = RUNNING;
+
+    // every tick the running task executes one tick of its job
+    uint32_t busy = 0, sampled_idle = 0;
+    for (uint32_t t = 0; t < 200; t++) {
+        for (int i = 0; i < 2; i++) {
+            if (os_tsk.run == &tasks[i].tcb) {
+                busy++;
+                if (--tasks[i].left == 0) {
+                    tasks[i].left = tasks[i].wcet;
+                    rt_period_wait();
+                    take_switch();
+                }
+                break;
+            }
+        }
+        if (os_tsk.run == &os_idle_TCB)
+            sampled_idle++;
+        rt_systick();
+        take_switch();
+    }
+
+    // U = 1/4 + 2/10, the rest of the 200 ticks is idle. Every job here ends exactly on
+    // a tick, where the idle thread already runs, so the samples overestimate the idle time.
+    printf("    idle: %u ticks, sampled %u ticks\n", (unsigned)(200 - busy), (unsigned)os_stat.idle_ticks);
+    CHECK_EQUAL(50 + 40, busy);
+    CHECK_EQUAL(sampled_idle, os_stat.idle_ticks);
+    CHECK(os_stat.idle_ticks >= 200 - busy);
+    CHECK_EQUAL(expected_switches, os_stat.switches);
+    CHECK(os_stat.switches > 0);
+    CHECK_EQUAL(0, host_rtx_errors);
+}
+
+TEST(isr_requests_and_queue_high_water_mark) {
+    kernel_reset();
+    memset(os_fifo, 0, sizeof(os_fifo[0]) * 2);
+    os_psq->size = os_fifo_size;
+    struct OS_SCB semaphore;
+
+    for (int i = 0; i < 3; i++)
+        rt_psq_enq(&semaphore, 0);
+    CHECK_EQUAL(3, os_stat.isr_requests);
+    CHECK_EQUAL(3, os_stat.psq_max);
+
+    // the kernel served the requests
+    os_psq->count = 0;
+    os_psq->last = os_psq->first;
+    rt_psq_enq(&semaphore, 0);
+    CHECK_EQUAL(4, os_stat.isr_requests);
+    CHECK_EQUAL(3, os_stat.psq_max);
+
+    // an overflow is an error and no request
+    for (int i = 0; i < 5; i++)
+        rt_psq_enq(&semaphore, 0);
+    CHECK_EQUAL(os_fifo_size, os_stat.psq_max);
+    CHECK_EQUAL(4 + os_fifo_size - 1, os_stat.isr_requests);
+    CHECK_EQUAL(2, host_rtx_errors);
+}
+
+#define BLOCKS 5
+#define BLOCK_SIZE 16
+
+TEST(memory_box_usage) {
+    static void *box[(sizeof(struct OS_BM) + BLOCKS * BLOCK_SIZE) / sizeof(void*)];
+    CHECK_EQUAL(0, _init_box(box, sizeof(box), BLOCK_SIZE));
+    P_BM bm = (P_BM)box;
+    CHECK_EQUAL(0, bm->usage);
+
+    void *blocks[BLOCKS + 1];
+    for (int i = 0; i < 3; i++)
+        blocks[i] = rt_alloc_box(box);
+    CHECK_EQUAL(3, bm->usage & 0xFFFF);
+    CHECK_EQUAL(3, bm->usage >> 16);
+
+    CHECK_EQUAL(0, rt_free_box(box, blocks[0]));
+    CHECK_EQUAL(0, rt_free_box(box, blocks[1]));
+    CHECK_EQUAL(1, bm->usage & 0xFFFF);
+    CHECK_EQUAL(3, bm->usage >> 16);
+
+    // a block of another pool is refused and not counted
+    int other;
+    CHECK_EQUAL(1, rt_free_box(box, &other));
+    CHECK_EQUAL(1, bm->usage & 0xFFFF);
+
+    int allocated = 1;
+    while ((blocks[allocated] = _calloc_box(box)) != 0)
+        allocated++;
+    CHECK_EQUAL(BLOCKS, allocated);
+    CHECK_EQUAL(BLOCKS, bm->usage & 0xFFFF);
+    CHECK_EQUAL(BLOCKS, bm->usage >> 16);
+}
@@ -0,0 +1,199 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "host_port.h"
+#include "Mutex.h"
+#include "Semaphore.h"
+#include "Thread.h"
+
+using namespace rtos;
+
+/* Mutex and Semaphore with and without the lock free paths of the port, which stand
+ in for the LDREX/STREX fast paths of rt_CMSIS.c; without them every call takes the
+ port lock, as every call enters the kernel through a service call on the target. */
+
+#define WORKERS     4
+#define ITERATIONS  20000
+#define TOKENS      10000       // per consumer, all of them stay below osFeature_Semaphore
+
+struct Shared {
+    Mutex mutex;
+    Semaphore start;
+    Semaphore done;
+    uint32_t count;
+    uint32_t iterations;
+
+    Shared() : start(0), done(0), count(0), iterations(ITERATIONS) {
+    }
+};
+
+static void increment(void const *argument) {
+    Shared *shared = (Shared*)argument;
+    shared->start.wait();
+    for (uint32_t i = 0; i < shared->iterations; i++) {
+        shared->mutex.lock();
+        shared->count++;
+        shared->mutex.unlock();
+    }
+    shared->done.release();
+}
+
+static uint64_t contended_count(Shared &shared) {
+    Thread *workers[WORKERS];
+    for (int i = 0; i < WORKERS; i++)
+        workers[i] = new Thread(increment, &shared);
+    Thread::wait(10);
+    uint64_t start = host_test::now_ns();
+    for (int i = 0; i < WORKERS; i++)
+        shared.start.release();
+    for (int i = 0; i < WORKERS; i++)
+        shared.done.wait();
+    uint64_t elapsed = host_test::now_ns() - start;
+    for (int i = 0; i < WORKERS; i++)
+        delete workers[i];
+    return elapsed;
+}
+
+TEST(mutex_excludes_with_fast_path) {
+    Shared shared;
+    contended_count(shared);
+    CHECK_EQUAL(WORKERS * ITERATIONS, shared.count);
+}
+
+TEST(mutex_excludes_without_fast_path) {
+    host_lock_fast_path(false);
+    Shared shared;
+    contended_count(shared);
+    host_lock_fast_path(true);
+    CHECK_EQUAL(WORKERS * ITERATIONS, shared.count);
+}
+
+static void hold(void const *argument) {
+    Shared *shared = (Shared*)argument;
+    shared->mutex.lock();
+    shared->done.release();
+    Thread::wait(50);
+    shared->mutex.unlock();
+}
+
+TEST(mutex_recursion_and_blocking) {
+    Shared shared;
+    CHECK_EQUAL(osOK, shared.mutex.lock());
+    CHECK_EQUAL(osOK, shared.mutex.lock());
+    CHECK_EQUAL(osOK, shared.mutex.unlock());
+    CHECK_EQUAL(osOK, shared.mutex.unlock());
+    CHECK_EQUAL(osErrorResource, shared.mutex.unlock());
+
+    Thread holder(hold, &shared);
+    shared.done.wait();
+    CHECK(!shared.mutex.trylock());
+    CHECK_EQUAL(osErrorTimeoutResource, shared.mutex.lock(10));
+    CHECK_EQUAL(osOK, shared.mutex.lock());
+    CHECK_EQUAL(osOK, shared.mutex.unlock());
+}
+
+struct Tokens {
+    Semaphore tokens;
+    Semaphore done;
+    uint32_t taken;
+
+    Tokens() : tokens(0), done(0), taken(0) {
+    }
+};
+
+static void consume(void const *argument) {
+    Tokens *tokens = (Tokens*)argument;
+    for (uint32_t i = 0; i < TOKENS; i++) {
+        if (tokens->tokens.wait() > 0)
+            __sync_fetch_and_add(&tokens->taken, 1);
+    }
+    tokens->done.release();
+}
+
+TEST(semaphore_wakes_every_waiter) {
+    Tokens tokens;
+    Thread *consumers[WORKERS];
+    for (int i = 0; i < WORKERS; i++)
+        consumers[i] = new Thread(consume, &tokens);
+    for (uint32_t i = 0; i < WORKERS * TOKENS; i++)
+        CHECK_EQUAL(osOK, tokens.tokens.release());
+    for (int i = 0; i < WORKERS; i++)
+        tokens.done.wait();
+    for (int i = 0; i < WORKERS; i++)
+        delete consumers[i];
+    CHECK_EQUAL(WORKERS * TOKENS, tokens.taken);
+    CHECK_EQUAL(0, tokens.tokens.wait(0));
+}
+
+TEST(semaphore_counts_tokens) {
+    Semaphore semaphore(2);
+    CHECK_EQUAL(2, semaphore.wait(0));
+    CHECK_EQUAL(1, semaphore.wait(0));
+    CHECK_EQUAL(0, semaphore.wait(0));
+    CHECK_EQUAL(0, semaphore.wait(10));
+    CHECK_EQUAL(osOK, semaphore.release());
+    CHECK_EQUAL(1, semaphore.wait());
+}
+
+/*--------------------------- Benchmarks -----------------------------------*/
+
+#define UNCONTENDED 1000000
+
+static void uncontended(bool fast) {
+    host_lock_fast_path(fast);
+    Mutex mutex;
+    uint64_t start = host_test::now_ns();
+    for (uint32_t i = 0; i < UNCONTENDED; i++) {
+        mutex.lock();
+        mutex.unlock();
+    }
+    host_test::report(fast ? "mutex uncontended, fast path" : "mutex uncontended, port lock",
+                      UNCONTENDED, host_test::now_ns() - start);
+
+    Semaphore semaphore(1);
+    start = host_test::now_ns();
+    for (uint32_t i = 0; i < UNCONTENDED; i++) {
+        semaphore.wait();
+        semaphore.release();
+    }
+    host_test::report(fast ? "semaphore uncontended, fast path" : "semaphore uncontended, port lock",
+                      UNCONTENDED, host_test::now_ns() - start);
+    host_lock_fast_path(true);
+}
+
+TEST(benchmark_uncontended) {
+    uncontended(false);
+    uncontended(true);
+}
+
+TEST(benchmark_contended) {
+    for (int fast = 0; fast < 2; fast++) {
+        host_lock_fast_path(fast != 0);
+        Shared shared;
+        uint64_t elapsed = contended_count(shared);
+        host_test::report(fast ? "mutex contended by 4 threads, fast path" :
+                                 "mutex contended by 4 threads, port lock",
+                          WORKERS * ITERATIONS, elapsed);
+        CHECK_EQUAL(WORKERS * ITERATIONS, shared.count);
+    }
+    host_lock_fast_path(true);
+}
@@ -0,0 +1,195 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "LockOrder.h"
+#include "Mutex.h"
+#include "Semaphore.h"
+#include "Thread.h"
+
+using namespace rtos;
+
+/* The graph of the checker keeps every object ever taken, so each test uses its own
+ static objects */
+
+struct Report {
+    LockOrderViolation violation;
+    const void *held;
+    const void *wanted;
+};
+
+static Report reports[8];
+static int report_count = 0;
+
+static void record(LockOrderViolation violation, const void *held, const void *wanted) {
+    if (report_count < 8) {
+        Report report = { violation, held, wanted };
+        reports[report_count] = report;
+    }
+    report_count++;
+}
+
+static void join(Thread &thread) {
+    while (thread.get_state() != Thread::Inactive)
+        Thread::wait(1);
+}
+
+static Mutex a, b;
+
+TEST(two_lock_cycle) {
+    LockOrder::set_handler(record);
+    report_count = 0;
+
+    // the same order again and again is fine
+    for (int i = 0; i < 3; i++) {
+        a.lock();
+        b.lock();
+        b.unlock();
+        a.unlock();
+    }
+    CHECK_EQUAL(0, report_count);
+
+    // the opposite order is reported the first time it happens, without a deadlock
+    b.lock();
+    a.lock();
+    a.unlock();
+    b.unlock();
+    CHECK_EQUAL(1, report_count);
+    CHECK_EQUAL(LockOrderCycle, reports[0].violation);
+    CHECK(reports[0].held == &b);
+    CHECK(reports[0].wanted == &a);
+
+    // the edge is known now, it is not reported again
+    b.lock();
+    a.lock();
+    a.unlock();
+    b.unlock();
+    CHECK_EQUAL(1, report_count);
+}
+
+static Mutex first, second;
+static Semaphore third(1, true);
+
+static void take_second_then_third(void const *argument) {
+    second.lock();
+    third.wait();
+    third.release();
+    second.unlock();
+}
+
+TEST(cycle_across_threads_and_a_lock_semaphore) {
+    LockOrder::set_handler(record);
+    report_count = 0;
+
+    first.lock();
+    second.lock();
+    second.unlock();
+    first.unlock();
+    {
+        Thread thread(take_second_then_third);
+        join(thread);
+    }
+    CHECK_EQUAL(0, report_count);
+
+    // first -> second -> third -> first
+    third.wait();
+    first.lock();
+    first.unlock();
+    third.release();
+    CHECK_EQUAL(1, report_count);
+    CHECK(reports[0].held == &third);
+    CHECK(reports[0].wanted == &first);
+}
+
+/* A signalling semaphore is taken by one thread and released by another. Tracked like a
+ lock, it would close the cycle data -> ready -> data. */
+
+static Mutex data;
+static Semaphore ready(0);
+
+static void consumer(void const *argument) {
+    ready.wait();
+    data.lock();
+    data.unlock();
+}
+
+TEST(signalling_semaphore_is_not_tracked) {
+    LockOrder::set_handler(record);
+    report_count = 0;
+    {
+        Thread thread(consumer);
+        data.lock();
+        ready.release();
+        Thread::wait(5);
+        data.unlock();
+        join(thread);
+    }
+    data.lock();
+    ready.release();
+    CHECK_EQUAL(1, ready.wait(0));
+    data.unlock();
+    CHECK_EQUAL(0, report_count);
+    CHECK_EQUAL(0, LockOrder::dropped());
+}
+
+/* A thread blocking on an object held by a lower priority thread */
+
+static Mutex shared;
+static Semaphore hold(0);
+static Semaphore holding(0);
+
+static void low_priority_holder(void const *argument) {
+    shared.lock();
+    holding.release();
+    hold.wait();
+    shared.unlock();
+}
+
+TEST(priority_inversion) {
+    LockOrder::set_handler(record);
+    report_count = 0;
+    osThreadSetPriority(osThreadGetId(), osPriorityHigh);
+    {
+        Thread thread(low_priority_holder, NULL, osPriorityLow);
+        holding.wait();
+        // the holder keeps the mutex past the timeout, so the lock always blocks
+        CHECK(shared.lock(10) != osOK);
+        hold.release();
+        join(thread);
+        CHECK_EQUAL(1, report_count);
+        CHECK_EQUAL(LockOrderInversion, reports[0].violation);
+        CHECK(reports[0].wanted == &shared);
+    }
+
+    // a holder of higher priority is no inversion
+    report_count = 0;
+    osThreadSetPriority(osThreadGetId(), osPriorityLow);
+    {
+        Thread thread(low_priority_holder, NULL, osPriorityHigh);
+        holding.wait();
+        // the holder keeps the mutex past the timeout, so the lock always blocks
+        CHECK(shared.lock(10) != osOK);
+        hold.release();
+        join(thread);
+    }
+    CHECK_EQUAL(0, report_count);
+    osThreadSetPriority(osThreadGetId(), osPriorityNormal);
+}
@@ -0,0 +1,231 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "MailBox.h"
+#include "Mutex.h"
+#include "Semaphore.h"
+#include "Thread.h"
+
+using namespace rtos;
+
+static void join(Thread &thread) {
+    while (thread.get_state() != Thread::Inactive)
+        Thread::wait(1);
+}
+
+TEST(uncontended_and_recursive_locks) {
+    Mutex mutex;
+    CHECK_EQUAL(osOK, mutex.lock());
+    CHECK_EQUAL(osOK, mutex.lock());
+    Thread::wait(5);
+    mutex.unlock();
+    mutex.unlock();
+
+    const LockStats &stats = mutex.stats();
+    CHECK_EQUAL(2, stats.acquisitions);
+    CHECK_EQUAL(0, stats.contended);
+    CHECK_EQUAL(0, stats.timeouts);
+    // one hold from the outer lock to the outer unlock
+    CHECK(stats.max_hold_us >= 4000);
+    CHECK(stats.max_holder == osThreadGetId());
+    CHECK(stats.holder == NULL);
+
+    mutex.reset_stats();
+    CHECK_EQUAL(0, mutex.stats().acquisitions);
+    CHECK_EQUAL(0, mutex.stats().max_hold_us);
+}
+
+static Mutex contended_mutex;
+static osThreadId waiter_id;
+
+static void waiter(void const *argument) {
+    waiter_id = osThreadGetId();
+    contended_mutex.lock();
+    contended_mutex.unlock();
+}
+
+static void impatient(void const *argument) {
+    *(osStatus*)argument = contended_mutex.lock(5);
+}
+
+TEST(contended_mutex_records_wait_and_hold) {
+    contended_mutex.lock();
+    osStatus timed_out = osOK;
+    {
+        Thread thread(impatient, &timed_out);
+        join(thread);
+    }
+    CHECK_EQUAL(osErrorTimeoutResource, timed_out);
+    {
+        Thread thread(waiter);
+        Thread::wait(20);
+        contended_mutex.unlock();
+        join(thread);
+    }
+
+    const LockStats &stats = contended_mutex.stats();
+    CHECK_EQUAL(2, stats.acquisitions);
+    CHECK_EQUAL(1, stats.contended);
+    CHECK_EQUAL(1, stats.timeouts);
+    CHECK(stats.max_wait_us >= 15000);
+    CHECK(stats.total_wait_us == stats.max_wait_us);
+    // the main thread held the mutex the longest, not the waiter
+    CHECK(stats.max_hold_us >= 20000);
+    CHECK(stats.max_holder == osThreadGetId());
+    CHECK(stats.max_holder != waiter_id);
+}
+
+static Semaphore signal_semaphore(0);
+
+static void signaller(void const *argument) {
+    Thread::wait(10);
+    signal_semaphore.release();
+}
+
+TEST(semaphore_records_no_hold_time) {
+    {
+        Thread thread(signaller);
+        CHECK_EQUAL(1, signal_semaphore.wait());
+        join(thread);
+    }
+    const LockStats &stats = signal_semaphore.stats();
+    CHECK_EQUAL(1, stats.acquisitions);
+    CHECK_EQUAL(1, stats.contended);
+    CHECK(stats.max_wait_us >= 5000);
+    CHECK_EQUAL(0, stats.max_hold_us);
+    CHECK(stats.max_holder == NULL);
+}
+
+/* The contention of main.cpp: dumpContents holds CAR_MAIL_SEM while it writes every mail to the
+ csv file and the serial port, and sendToMail blocks on it with a new mail. */
+
+#define MAILS       3
+#define MAIL_IO_MS  20
+
+struct mail_t {
+    float speedVal;
+    float accelerometerVal;
+    float breakVal;
+};
+
+static Semaphore car_mail_sem(1, true);
+static MailBox<mail_t, 16> car_mail_box;
+static volatile uint32_t written, read_mails;
+static osThreadId dump_id;
+
+static void send_to_mail(void const *argument) {
+    MailHandle<mail_t> mail;
+    if (!car_mail_box.emplace(mail))
+        return;
+    car_mail_sem.wait();
+    mail->speedVal = 50.0f;
+    written++;
+    car_mail_box.send(mail);
+    car_mail_sem.release();
+}
+
+static void dump_contents(void const *argument) {
+    dump_id = Thread::gettid();
+    car_mail_sem.wait();
+    while (written > read_mails) {
+        MailHandle<mail_t> mail;
+        if (car_mail_box.receive(mail)) {
+            // the file and serial output of one mail
+            Thread::wait(MAIL_IO_MS);
+            read_mails++;
+        }
+    }
+    car_mail_sem.release();
+}
+
+static void late_sender(void const *argument) {
+    Thread::wait(MAIL_IO_MS / 2);
+    send_to_mail(argument);
+}
+
+TEST(dump_contents_blocks_send_to_mail) {
+    for (int i = 0; i < MAILS; i++)
+        send_to_mail(NULL);
+    CHECK_EQUAL(MAILS, car_mail_sem.stats().acquisitions);
+    CHECK_EQUAL(0, car_mail_sem.stats().contended);
+    CHECK(car_mail_sem.stats().holder == NULL);
+    car_mail_sem.reset_stats();
+    {
+        Thread dump(dump_contents);
+        Thread sender(late_sender);
+        join(dump);
+        join(sender);
+    }
+    const LockStats &stats = car_mail_sem.stats();
+    printf("    CAR_MAIL_SEM: taken %u, contended %u, wait max %u us, held max %u us\n",
+           (unsigned)stats.acquisitions, (unsigned)stats.contended, (unsigned)stats.max_wait_us,
+           (unsigned)stats.max_hold_us);
+    CHECK_EQUAL(2, stats.acquisitions);
+    CHECK_EQUAL(1, stats.contended);
+    // the sender waits for the output of all mails after its start
+    CHECK(stats.max_wait_us >= (MAILS * MAIL_IO_MS - MAIL_IO_MS / 2 - 2) * 1000);
+    CHECK(stats.max_hold_us >= MAILS * MAIL_IO_MS * 1000);
+    CHECK(stats.max_hold_us >= stats.max_wait_us);
+    CHECK(stats.max_holder == dump_id);
+    CHECK(stats.holder == NULL);
+    CHECK_EQUAL(MAILS + 1, written);
+}
+
+/* Several threads hold tokens of one semaphore at the same time and all update its
+ statistics, no acquisition may be lost */
+
+#define THREADS 8
+#define ROUNDS 20000
+
+static Semaphore pool(3);
+static Mutex counted;
+
+static void take_tokens(void const *argument) {
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        pool.wait();
+        counted.lock();
+        if ((i % 64) == 0)
+            Thread::yield();
+        counted.unlock();
+        if ((i % 64) == 32)
+            Thread::yield();
+        pool.release();
+    }
+}
+
+TEST(concurrent_acquisitions_are_all_counted) {
+    Thread *threads[THREADS];
+    for (int i = 0; i < THREADS; i++)
+        threads[i] = new Thread(take_tokens);
+    for (int i = 0; i < THREADS; i++) {
+        join(*threads[i]);
+        delete threads[i];
+    }
+    printf("    semaphore: %u contended, mutex: %u contended\n",
+           (unsigned)pool.stats().contended, (unsigned)counted.stats().contended);
+    CHECK_EQUAL(THREADS * ROUNDS, pool.stats().acquisitions);
+    CHECK_EQUAL(THREADS * ROUNDS, counted.stats().acquisitions);
+    CHECK(pool.stats().contended > 0);
+    CHECK(counted.stats().contended > 0);
+    CHECK_EQUAL(0, pool.stats().timeouts);
+    CHECK(counted.stats().holder == NULL);
+}
@@ -0,0 +1,268 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "MailBox.h"
+#include "Mail.h"
+#include "Semaphore.h"
+#include "Thread.h"
+
+using namespace rtos;
+
+/* Built without exceptions, as on the target: every mail has to be destroyed and freed
+ by the handles alone. */
+
+struct Message {
+    static int constructed;
+    static int destroyed;
+
+    uint32_t a, b, c;
+
+    Message() : a(0), b(0), c(0) {
+        constructed++;
+    }
+    Message(uint32_t a) : a(a), b(0), c(0) {
+        constructed++;
+    }
+    Message(uint32_t a, uint32_t b) : a(a), b(b), c(0) {
+        constructed++;
+    }
+    Message(uint32_t a, uint32_t b, uint32_t c) : a(a), b(b), c(c) {
+        constructed++;
+    }
+    Message(const Message &other) : a(other.a), b(other.b), c(other.c) {
+        constructed++;
+    }
+    ~Message() {
+        destroyed++;
+    }
+};
+
+int Message::constructed;
+int Message::destroyed;
+
+static void reset_counts() {
+    Message::constructed = Message::destroyed = 0;
+}
+
+#define BOX_SIZE 4
+
+TEST(handle_frees_on_scope_exit) {
+    reset_counts();
+    MailBox<Message, BOX_SIZE> box;
+    {
+        MailHandle<Message> mail;
+        CHECK(box.emplace_with(mail, 0, 1u, 2u, 3u));
+        CHECK_EQUAL(3, mail->c);
+        CHECK_EQUAL(1, box.usage());
+    }
+    CHECK_EQUAL(0, box.usage());
+    CHECK_EQUAL(1, Message::destroyed);
+
+    // a handle that is emplaced again frees its old mail first
+    MailHandle<Message> mail;
+    CHECK(box.emplace(mail));
+    CHECK(box.emplace_copy(mail, Message(7)));
+    CHECK_EQUAL(7, mail->a);
+    CHECK_EQUAL(1, box.usage());
+    mail.reset();
+    CHECK(!mail.valid());
+    CHECK_EQUAL(0, box.usage());
+    CHECK_EQUAL(Message::constructed, Message::destroyed);
+}
+
+TEST(send_and_receive) {
+    reset_counts();
+    MailBox<Message, BOX_SIZE> box;
+    MailHandle<Message> mail;
+    CHECK(box.emplace_with(mail, 0, 5u));
+    CHECK_EQUAL(osOK, box.send(mail));
+    CHECK(!mail.valid());
+    CHECK_EQUAL(osErrorParameter, box.send(mail));
+
+    MailHandle<Message> received;
+    CHECK(box.receive(received, 0));
+    CHECK_EQUAL(5, received->a);
+    CHECK(!box.receive(received, 0));
+    CHECK(!received.valid());
+    CHECK_EQUAL(0, box.usage());
+    CHECK_EQUAL(Message::constructed, Message::destroyed);
+}
+
+TEST(failed_send_keeps_the_mail) {
+    reset_counts();
+    MailBox<Message, BOX_SIZE> box, other;
+    MailHandle<Message> mail;
+    CHECK(box.emplace(mail));
+    CHECK_EQUAL(osErrorParameter, other.send(mail));
+    CHECK(mail.valid());
+    CHECK_EQUAL(1, box.usage());
+    mail.reset();
+    CHECK_EQUAL(0, box.usage());
+}
+
+TEST(transfer_and_swap) {
+    reset_counts();
+    MailBox<Message, BOX_SIZE> box;
+    MailHandle<Message> first, second;
+    CHECK(box.emplace_with(first, 0, 1u));
+    CHECK(box.emplace_with(second, 0, 2u));
+
+    first.swap(second);
+    CHECK_EQUAL(2, first->a);
+    CHECK_EQUAL(1, second->a);
+
+    first.transfer(second);
+    CHECK_EQUAL(1, first->a);
+    CHECK(!second.valid());
+    CHECK_EQUAL(1, box.usage());
+    first.transfer(first);
+    CHECK(first.valid());
+    CHECK_EQUAL(1, Message::destroyed);
+
+    CHECK_EQUAL(osOK, box.send(first));
+    CHECK_EQUAL(1, box.usage());
+}
+
+TEST(full_box_and_timeouts) {
+    reset_counts();
+    MailBox<Message, BOX_SIZE> box;
+    MailHandle<Message> mails[BOX_SIZE];
+    for (int i = 0; i < BOX_SIZE; i++)
+        CHECK(box.emplace_with(mails[i], 0, (uint32_t)i));
+    MailHandle<Message> extra;
+    CHECK(!box.emplace(extra));
+    uint64_t start = host_test::now_ns();
+    CHECK(!box.emplace_with(extra, 20, 9u));
+    CHECK((host_test::now_ns() - start) >= 19000000);
+
+    for (int i = 0; i < BOX_SIZE; i++)
+        CHECK_EQUAL(osOK, box.send(mails[i]));
+    MailHandle<Message> batch[BOX_SIZE + 2];
+    CHECK_EQUAL(BOX_SIZE, box.receive(batch, BOX_SIZE + 2, 0));
+    for (int i = 0; i < BOX_SIZE; i++)
+        CHECK_EQUAL(i, batch[i]->a);
+    CHECK(!batch[BOX_SIZE].valid());
+    CHECK_EQUAL(0, box.receive(batch, 1, 0));
+    CHECK_EQUAL(3, box.usage());
+}
+
+static MailBox<Message, BOX_SIZE> shared_box;
+
+struct Exchange {
+    Semaphore done;
+    uint32_t received;
+    uint32_t sum;
+
+    Exchange() : done(0), received(0), sum(0) {
+    }
+};
+
+#define MAILS 5000
+
+static void consume(void const *argument) {
+    Exchange *exchange = (Exchange*)argument;
+    MailHandle<Message> batch[3];
+    while (exchange->received < MAILS / 2) {
+        uint32_t count = shared_box.receive(batch, 3, 1000);
+        for (uint32_t i = 0; i < count; i++)
+            exchange->sum += batch[i]->a;
+        exchange->received += count;
+        if (count == 0)
+            break;
+    }
+    exchange->done.release();
+}
+
+TEST(no_leaks_between_threads) {
+    reset_counts();
+    Exchange exchange;
+    Thread consumer(consume, &exchange);
+    uint32_t sent_sum = 0;
+    for (uint32_t i = 0; i < MAILS; i++) {
+        MailHandle<Message> mail;
+        if (!shared_box.emplace_with(mail, 1000, i))
+            break;
+        // every other mail is dropped before it is sent
+        if (i & 1)
+            continue;
+        sent_sum += i;
+        CHECK_EQUAL(osOK, shared_box.send(mail));
+    }
+    exchange.done.wait();
+    CHECK_EQUAL(MAILS / 2, exchange.received);
+    CHECK_EQUAL(sent_sum, exchange.sum);
+    CHECK_EQUAL(0, shared_box.usage());
+    CHECK_EQUAL(MAILS, Message::constructed);
+    CHECK_EQUAL(Message::constructed, Message::destroyed);
+}
+
+/*--------------------------- Benchmark ------------------------------------*/
+
+/* Send and receive in one thread, against Mail with alloc, put, get and free */
+
+#define ROUNDS 200000
+
+struct Sample {
+    float speed;
+    float accelerator;
+    float brake;
+    uint32_t time;
+};
+
+TEST(benchmark_send_receive) {
+    static MailBox<Sample, 100> box;
+    uint64_t start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        MailHandle<Sample> mail;
+        box.emplace(mail);
+        mail->time = i;
+        box.send(mail);
+        MailHandle<Sample> received;
+        box.receive(received);
+    }
+    host_test::report("MailBox emplace, send, receive", ROUNDS, host_test::now_ns() - start);
+
+    static Mail<Sample, 100> mail_queue;
+    start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        Sample *mail = mail_queue.alloc();
+        mail->time = i;
+        mail_queue.put(mail);
+        osEvent evt = mail_queue.get();
+        mail_queue.free((Sample*)evt.value.p);
+    }
+    host_test::report("Mail alloc, put, get, free", ROUNDS, host_test::now_ns() - start);
+
+    start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS / 100; i++) {
+        MailBox<Sample, 100> constructed;
+        (void)constructed;
+    }
+    host_test::report("MailBox<Sample, 100> construction", ROUNDS / 100, host_test::now_ns() - start);
+
+    start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS / 100; i++) {
+        Mail<Sample, 100> constructed;
+        (void)constructed;
+    }
+    host_test::report("Mail<Sample, 100> construction", ROUNDS / 100, host_test::now_ns() - start);
+}
@@ -0,0 +1,130 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "RateMonotonic.h"
+
+using namespace rtos;
+
+/* Response time analysis at run time, to cross-check the compile time result */
+struct Timing {
+    uint32_t period_us, wcet_us, deadline_us;
+    int priority;
+};
+
+static uint32_t response_time(const Timing *set, int count, int i) {
+    uint32_t r = set[i].wcet_us;
+    while (true) {
+        uint32_t next = set[i].wcet_us;
+        for (int j = 0; j < count; j++) {
+            if ((j != i) && (set[j].priority >= set[i].priority))
+                next += ((r + set[j].period_us - 1) / set[j].period_us) * set[j].wcet_us;
+        }
+        if ((next == r) || (next > set[i].deadline_us))
+            return next;
+        r = next;
+    }
+}
+
+#define TIMING(RM, Set, i) \
+    { rm::TaskAt<Set, i>::type::period_us, rm::TaskAt<Set, i>::type::wcet_us, \
+      rm::TaskAt<Set, i>::type::deadline_us, RM::Priority<i>::value }
+
+/* Textbook set (C, T) = (1, 4), (2, 6), (3, 12) ms: R = 1, 3, 10 ms */
+typedef TaskSet<PeriodicTask<4000, 1000>, PeriodicTask<6000, 2000>, PeriodicTask<12000, 3000> > Textbook;
+
+TEST(schedulable_textbook_set) {
+    typedef RateMonotonic<Textbook> RM;
+    CHECK(RM::schedulable);
+    CHECK_EQUAL(osPriorityRealtime, RM::Priority<0>::value);
+    CHECK_EQUAL(osPriorityHigh, RM::Priority<1>::value);
+    CHECK_EQUAL(osPriorityAboveNormal, RM::Priority<2>::value);
+    CHECK_EQUAL(1000, RM::ResponseTime<0>::value);
+    CHECK_EQUAL(3000, RM::ResponseTime<1>::value);
+    CHECK_EQUAL(10000, RM::ResponseTime<2>::value);
+}
+
+/* (1, 4), (2, 6), (4, 8) ms: R of the last task grows 4, 7, 10 ms past its deadline */
+typedef TaskSet<PeriodicTask<4000, 1000>, PeriodicTask<6000, 2000>, PeriodicTask<8000, 4000> > Overloaded;
+
+TEST(unschedulable_set) {
+    CHECK(!(rm::AllSchedulable<Overloaded, osPriorityNormal, osPriorityRealtime>::value));
+    CHECK((rm::Schedulable<Overloaded, 0, osPriorityNormal, osPriorityRealtime>::value));
+    CHECK((rm::Schedulable<Overloaded, 1, osPriorityNormal, osPriorityRealtime>::value));
+    CHECK(!(rm::Schedulable<Overloaded, 2, osPriorityNormal, osPriorityRealtime>::value));
+    CHECK_EQUAL(10000, (rm::Schedulable<Overloaded, 2, osPriorityNormal, osPriorityRealtime>::response_us));
+}
+
+/* A deadline shorter than the period: (1, 4), (2, 6, D = 2) ms misses by the 1 ms of the first task */
+typedef TaskSet<PeriodicTask<4000, 1000>, PeriodicTask<6000, 2000, 2000> > ShortDeadline;
+
+TEST(constrained_deadline) {
+    CHECK(!(rm::AllSchedulable<ShortDeadline, osPriorityNormal, osPriorityRealtime>::value));
+    CHECK((rm::AllSchedulable<TaskSet<PeriodicTask<4000, 1000>, PeriodicTask<6000, 2000, 3000> >,
+                              osPriorityNormal, osPriorityRealtime>::value));
+}
+
+/* Equal periods share a level, the longest periods share the lowest level */
+typedef TaskSet<PeriodicTask<1000, 10>, PeriodicTask<2000, 10>, PeriodicTask<2000, 10>,
+                PeriodicTask<4000, 10>, PeriodicTask<8000, 10>, PeriodicTask<16000, 10> > Levels;
+
+TEST(priority_levels) {
+    typedef RateMonotonic<Levels> RM;
+    CHECK_EQUAL(osPriorityRealtime, RM::Priority<0>::value);
+    CHECK_EQUAL(osPriorityHigh, RM::Priority<1>::value);
+    CHECK_EQUAL(osPriorityHigh, RM::Priority<2>::value);
+    CHECK_EQUAL(osPriorityAboveNormal, RM::Priority<3>::value);
+    CHECK_EQUAL(osPriorityNormal, RM::Priority<4>::value);
+    CHECK_EQUAL(osPriorityNormal, RM::Priority<5>::value);
+
+    typedef RateMonotonic<Levels, osPriorityLow, osPriorityLow> OneLevel;
+    CHECK_EQUAL(osPriorityLow, OneLevel::Priority<0>::value);
+    CHECK_EQUAL(osPriorityLow, OneLevel::Priority<5>::value);
+    // with one level every task interferes with every other one
+    CHECK_EQUAL(60, OneLevel::ResponseTime<0>::value);
+}
+
+/* The threads of main.cpp */
+typedef TaskSet<PeriodicTask<50000, 200>, PeriodicTask<100000, 100>, PeriodicTask<200000, 50>,
+                PeriodicTask<500000, 50>, PeriodicTask<500000, 20000>, PeriodicTask<5000000, 200>,
+                PeriodicTask<20000000, 200000> > CarSet;
+
+TEST(car_task_set) {
+    typedef RateMonotonic<CarSet> RM;
+    CHECK(RM::schedulable);
+    CHECK_EQUAL(osPriorityRealtime, RM::Priority<0>::value);
+    CHECK_EQUAL(osPriorityHigh, RM::Priority<1>::value);
+    CHECK_EQUAL(osPriorityAboveNormal, RM::Priority<2>::value);
+    CHECK_EQUAL(osPriorityNormal, RM::Priority<3>::value);
+    CHECK_EQUAL(osPriorityNormal, RM::Priority<6>::value);
+
+    const Timing set[] = {
+        TIMING(RM, CarSet, 0), TIMING(RM, CarSet, 1), TIMING(RM, CarSet, 2), TIMING(RM, CarSet, 3),
+        TIMING(RM, CarSet, 4), TIMING(RM, CarSet, 5), TIMING(RM, CarSet, 6),
+    };
+    CHECK_EQUAL(response_time(set, 7, 0), RM::ResponseTime<0>::value);
+    CHECK_EQUAL(response_time(set, 7, 1), RM::ResponseTime<1>::value);
+    CHECK_EQUAL(response_time(set, 7, 2), RM::ResponseTime<2>::value);
+    CHECK_EQUAL(response_time(set, 7, 3), RM::ResponseTime<3>::value);
+    CHECK_EQUAL(response_time(set, 7, 4), RM::ResponseTime<4>::value);
+    CHECK_EQUAL(response_time(set, 7, 5), RM::ResponseTime<5>::value);
+    CHECK_EQUAL(response_time(set, 7, 6), RM::ResponseTime<6>::value);
+}
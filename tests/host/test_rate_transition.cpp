@@ -0,0 +1,201 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "RateTransition.h"
+#include "Semaphore.h"
+#include "Thread.h"
+
+using namespace rtos;
+
+/* A frame of the car simulation; every field is derived from seq, so a mixed snapshot shows */
+#define WORDS 14
+
+struct Frame {
+    uint32_t seq;
+    float speed;
+    uint32_t word[WORDS];
+};
+
+static Frame make_frame(uint32_t seq) {
+    Frame frame;
+    frame.seq = seq;
+    frame.speed = (float)seq * 0.5f;
+    for (int i = 0; i < WORDS; i++)
+        frame.word[i] = seq * (i + 1);
+    return frame;
+}
+
+static bool coherent(const Frame &frame) {
+    if (frame.speed != (float)frame.seq * 0.5f)
+        return false;
+    for (int i = 0; i < WORDS; i++) {
+        if (frame.word[i] != frame.seq * (i + 1))
+            return false;
+    }
+    return true;
+}
+
+TEST(hold_and_sample) {
+    RateTransition<uint32_t, 2> transition;
+    CHECK(!transition.update(0));
+    CHECK_EQUAL(0, transition.value(0));
+
+    transition.publish(1);
+    transition.publish(2);
+    CHECK_EQUAL(2, transition.published());
+
+    // fast to slow: reader 0 holds 2 while the writer moves on
+    CHECK(transition.update(0));
+    CHECK_EQUAL(2, transition.value(0));
+    for (uint32_t i = 3; i < 10; i++)
+        transition.publish(i);
+    CHECK_EQUAL(2, transition.value(0));
+
+    // slow to fast: reader 1 sees the last value until the next publish
+    CHECK(transition.update(1));
+    CHECK_EQUAL(9, transition.value(1));
+    CHECK(!transition.update(1));
+    CHECK_EQUAL(9, transition.value(1));
+
+    CHECK(transition.update(0));
+    CHECK_EQUAL(9, transition.value(0));
+}
+
+/* The rates of main.cpp scaled by 20: the writer runs every millisecond like the 20 Hz
+ carSimulation, readers every 2, 4, 10 and 20 ms like the 10, 5, 2 and 1 Hz processes. A
+ reader checks its snapshot several times during its frame while the writer goes on. */
+
+#define READERS 4
+#define RUN_MS 400
+
+static RateTransition<Frame, READERS> frames;
+static volatile bool running;
+
+struct ReaderResult {
+    uint32_t period_ms;
+    uint32_t index;
+    uint32_t frames;
+    uint32_t incoherent;
+    uint32_t changed_in_frame;
+    uint32_t went_back;
+};
+
+static void frame_writer(void const *argument) {
+    uint32_t seq = 1;
+    while (running) {
+        frames.publish(make_frame(seq++));
+        // publish a burst now and then, so several values fall into one reader frame
+        if ((seq % 4) == 0)
+            Thread::wait(1);
+        else
+            Thread::yield();
+    }
+}
+
+static void frame_reader(void const *argument) {
+    ReaderResult *result = (ReaderResult*)argument;
+    uint32_t last_seq = 0;
+    while (running) {
+        frames.update(result->index);
+        const Frame &snapshot = frames.value(result->index);
+        uint32_t seq = snapshot.seq;
+        if (seq < last_seq)
+            result->went_back++;
+        last_seq = seq;
+        for (int check = 0; check < 4; check++) {
+            if (!coherent(snapshot))
+                result->incoherent++;
+            if (snapshot.seq != seq)
+                result->changed_in_frame++;
+            Thread::yield();
+        }
+        result->frames++;
+        Thread::wait(result->period_ms);
+    }
+}
+
+TEST(multi_rate_snapshots_are_coherent) {
+    static const uint32_t periods[READERS] = { 2, 4, 10, 20 };
+    ReaderResult results[READERS];
+    Thread *readers[READERS];
+    running = true;
+    for (uint32_t i = 0; i < READERS; i++) {
+        ReaderResult result = { periods[i], i, 0, 0, 0, 0 };
+        results[i] = result;
+        readers[i] = new Thread(frame_reader, &results[i]);
+    }
+    {
+        Thread writer(frame_writer);
+        Thread::wait(RUN_MS);
+        running = false;
+        while (writer.get_state() != Thread::Inactive)
+            Thread::wait(1);
+    }
+    printf("    %u values published\n", (unsigned)frames.published());
+    for (uint32_t i = 0; i < READERS; i++) {
+        while (readers[i]->get_state() != Thread::Inactive)
+            Thread::wait(1);
+        delete readers[i];
+        printf("    reader every %2u ms: %u frames\n", (unsigned)results[i].period_ms, (unsigned)results[i].frames);
+        CHECK(results[i].frames >= 5);
+        CHECK_EQUAL(0, results[i].incoherent);
+        CHECK_EQUAL(0, results[i].changed_in_frame);
+        CHECK_EQUAL(0, results[i].went_back);
+    }
+    CHECK(frames.published() > RUN_MS);
+}
+
+/*--------------------------- Benchmark ------------------------------------*/
+
+/* One transition: a publish and a reader update and copy, in one thread. The shared
+ global guarded by a binary semaphore is how main.cpp passes values today. */
+
+#define ROUNDS 1000000
+
+TEST(overhead_per_transition) {
+    static RateTransition<Frame, 3> transition;
+    Frame frame = make_frame(1), copy = frame;
+    uint64_t start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        frame.seq = i;
+        transition.publish(frame);
+        transition.update(1);
+        copy = transition.value(1);
+    }
+    host_test::report("RateTransition publish, update, copy", ROUNDS, host_test::now_ns() - start);
+    CHECK_EQUAL(ROUNDS - 1, copy.seq);
+
+    static Semaphore guard(1);
+    static Frame shared;
+    start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        frame.seq = i;
+        guard.wait();
+        shared = frame;
+        guard.release();
+        guard.wait();
+        copy = shared;
+        guard.release();
+    }
+    host_test::report("Semaphore guarded global, write, copy", ROUNDS, host_test::now_ns() - start);
+    CHECK_EQUAL(ROUNDS - 1, copy.seq);
+}
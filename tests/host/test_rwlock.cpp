@@ -0,0 +1,230 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "RWLock.h"
+#include "Thread.h"
+
+using namespace rtos;
+
+static void join(Thread &thread) {
+    while (thread.get_state() != Thread::Inactive)
+        Thread::wait(1);
+}
+
+/* the car state of main.cpp, which must be read as a whole */
+struct CarState {
+    volatile uint32_t speed;
+    volatile uint32_t odometer;
+};
+
+TEST(readers_share_the_lock) {
+    RWLock lock;
+    CHECK_EQUAL(osOK, lock.read_lock());
+    CHECK_EQUAL(osOK, lock.read_lock(0));
+    CHECK_EQUAL(2, lock.readers());
+    CHECK_EQUAL(osOK, lock.read_unlock());
+    CHECK_EQUAL(osOK, lock.read_unlock());
+    CHECK_EQUAL(osErrorResource, lock.read_unlock());
+    CHECK_EQUAL(0, lock.readers());
+
+    CHECK_EQUAL(osOK, lock.write_lock(0));
+    CHECK_EQUAL(osOK, lock.write_unlock());
+}
+
+static RWLock timed_lock;
+
+static void hold_read(void const *argument) {
+    timed_lock.read_lock();
+    Thread::wait(*(const uint32_t*)argument);
+    timed_lock.read_unlock();
+}
+
+static void try_read(void const *argument) {
+    *(osStatus*)argument = timed_lock.read_lock(5);
+    if (*(osStatus*)argument == osOK)
+        timed_lock.read_unlock();
+}
+
+TEST(timeouts) {
+    uint32_t hold_ms = 40;
+    Thread reader(hold_read, &hold_ms);
+    Thread::wait(5);
+
+    CHECK_EQUAL(osErrorResource, timed_lock.write_lock(0));
+    CHECK_EQUAL(osErrorTimeoutResource, timed_lock.write_lock(10));
+    // the timed out writer no longer holds back new readers
+    CHECK_EQUAL(osOK, timed_lock.read_lock(0));
+    CHECK_EQUAL(osOK, timed_lock.read_unlock());
+
+    // a waiting writer gets the lock once the reader leaves
+    CHECK_EQUAL(osOK, timed_lock.write_lock(1000));
+    CHECK_EQUAL(0, timed_lock.readers());
+    osStatus status = osOK;
+    {
+        Thread blocked(try_read, &status);
+        join(blocked);
+    }
+    CHECK_EQUAL(osErrorTimeoutResource, status);
+    CHECK_EQUAL(osOK, timed_lock.write_unlock());
+    join(reader);
+}
+
+/* Once a writer waits, new readers wait behind it */
+
+static RWLock preferred;
+static volatile int order[3];
+static volatile int order_count = 0;
+
+static void late_reader(void const *argument) {
+    preferred.read_lock();
+    order[order_count++] = 2;
+    preferred.read_unlock();
+}
+
+static void writer(void const *argument) {
+    preferred.write_lock();
+    order[order_count++] = 1;
+    preferred.write_unlock();
+}
+
+TEST(writer_preference) {
+    CHECK_EQUAL(osOK, preferred.read_lock());
+    Thread waiting_writer(writer);
+    Thread::wait(5);
+    Thread new_reader(late_reader);
+    Thread::wait(5);
+    // neither could pass the first reader
+    CHECK_EQUAL(0, order_count);
+    order[order_count++] = 0;
+    preferred.read_unlock();
+    join(waiting_writer);
+    join(new_reader);
+
+    CHECK_EQUAL(3, order_count);
+    CHECK_EQUAL(0, order[0]);
+    CHECK_EQUAL(1, order[1]);
+    CHECK_EQUAL(2, order[2]);
+}
+
+/* One writer updates the state while eight readers check that they never see half of an update */
+
+#define READERS 8
+#define RUN_MS 300
+
+static RWLock state_lock;
+static Semaphore state_semaphore(1);
+static CarState state;
+static volatile bool running;
+
+struct ReaderResult {
+    bool use_rwlock;
+    uint32_t reads;
+    uint32_t torn;
+    uint32_t max_readers;
+};
+
+static void state_reader(void const *argument) {
+    ReaderResult *result = (ReaderResult*)argument;
+    while (running) {
+        if (result->use_rwlock) {
+            state_lock.read_lock();
+            if (state_lock.readers() > result->max_readers)
+                result->max_readers = state_lock.readers();
+        } else {
+            state_semaphore.wait();
+        }
+        uint32_t speed = state.speed;
+        if ((result->reads % 256) == 0)
+            Thread::yield();
+        if (state.odometer != speed)
+            result->torn++;
+        if (result->use_rwlock)
+            state_lock.read_unlock();
+        else
+            state_semaphore.release();
+        result->reads++;
+    }
+}
+
+static uint32_t run_writer(bool use_rwlock) {
+    uint32_t writes = 0;
+    uint64_t end = host_test::now_ns() + RUN_MS * 1000000ULL;
+    while (host_test::now_ns() < end) {
+        if (use_rwlock)
+            state_lock.write_lock();
+        else
+            state_semaphore.wait();
+        state.speed = writes;
+        Thread::yield();
+        state.odometer = writes;
+        if (use_rwlock)
+            state_lock.write_unlock();
+        else
+            state_semaphore.release();
+        writes++;
+        Thread::wait(1);
+    }
+    return writes;
+}
+
+static void run_readers_and_writer(bool use_rwlock, const char *name) {
+    ReaderResult results[READERS];
+    Thread *readers[READERS];
+    running = true;
+    for (int i = 0; i < READERS; i++) {
+        ReaderResult result = { use_rwlock, 0, 0, 0 };
+        results[i] = result;
+        readers[i] = new Thread(state_reader, &results[i]);
+    }
+    uint64_t start = host_test::now_ns();
+    uint32_t writes = run_writer(use_rwlock);
+    running = false;
+    uint32_t reads = 0, torn = 0, max_readers = 0;
+    for (int i = 0; i < READERS; i++) {
+        join(*readers[i]);
+        delete readers[i];
+        reads += results[i].reads;
+        torn += results[i].torn;
+        if (results[i].max_readers > max_readers)
+            max_readers = results[i].max_readers;
+    }
+    host_test::report(name, reads, host_test::now_ns() - start);
+    printf("    %u writes\n", (unsigned)writes);
+    CHECK(writes > 10);
+    CHECK(reads > 0);
+    CHECK_EQUAL(0, torn);
+    if (use_rwlock) {
+        printf("    up to %u readers at once\n", (unsigned)max_readers);
+        CHECK(max_readers > 1);
+    }
+}
+
+/*--------------------------- Benchmark ------------------------------------*/
+
+/* Time per read of 8 readers while 1 writer updates the state every millisecond. The host
+ has a single processor here, so shared reading shows as fewer blocked readers rather than
+ as parallel reads. */
+
+TEST(benchmark_one_writer_eight_readers) {
+    run_readers_and_writer(false, "binary Semaphore, per read");
+    run_readers_and_writer(true, "RWLock, per read");
+}
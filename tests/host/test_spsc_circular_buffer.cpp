@@ -0,0 +1,214 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "SPSCCircularBuffer.h"
+#include "CircularBuffer.h"
+#include "Thread.h"
+
+using namespace mbed;
+using namespace rtos;
+
+TEST(push_pop_and_wrap) {
+    static SPSCCircularBuffer<uint32_t, 4> buffer;
+    uint32_t value = 0;
+    CHECK(buffer.empty());
+    CHECK(!buffer.pop(value));
+    CHECK(!buffer.peek(value));
+
+    // all four slots are usable
+    for (uint32_t i = 0; i < 4; i++)
+        CHECK(buffer.push(i));
+    CHECK(buffer.full());
+    CHECK(!buffer.push(4));
+    CHECK_EQUAL(4, buffer.size());
+
+    CHECK(buffer.peek(value));
+    CHECK_EQUAL(0, value);
+    for (uint32_t i = 0; i < 10; i++) {
+        CHECK(buffer.pop(value));
+        CHECK_EQUAL(i, value);
+        CHECK(buffer.push(i + 4));
+    }
+    CHECK_EQUAL(4, buffer.size());
+    buffer.reset();
+    CHECK(buffer.empty());
+}
+
+TEST(bulk_push_and_pop) {
+    SPSCCircularBuffer<uint32_t, 8> buffer;
+    uint32_t in[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    uint32_t out[10] = { 0 };
+
+    CHECK_EQUAL(5, buffer.push(in, 5));
+    CHECK_EQUAL(3, buffer.pop(out, 3));
+    CHECK_EQUAL(2, out[2]);
+    // the pushes wrap around the end of the storage and stop when it is full
+    CHECK_EQUAL(5, buffer.push(in + 5, 5));
+    CHECK_EQUAL(1, buffer.push(in, 3));
+    CHECK(buffer.full());
+    CHECK_EQUAL(8, buffer.pop(out, 10));
+    for (uint32_t i = 0; i < 7; i++)
+        CHECK_EQUAL(i + 3, out[i]);
+    CHECK_EQUAL(0, out[7]);
+    CHECK_EQUAL(0, buffer.pop(out, 10));
+}
+
+TEST(spans_stop_at_the_end_of_the_storage) {
+    SPSCCircularBuffer<uint32_t, 8> buffer;
+    uint32_t *write = NULL;
+    const uint32_t *read = NULL;
+
+    CHECK_EQUAL(8, buffer.write_span(write));
+    for (uint32_t i = 0; i < 6; i++)
+        write[i] = i;
+    buffer.commit_write(6);
+    CHECK_EQUAL(6, buffer.read_span(read));
+    CHECK_EQUAL(0, read[0]);
+    buffer.consume(5);
+
+    // head at 6, tail at 5: two slots to the end, then five more after wrapping
+    CHECK_EQUAL(2, buffer.write_span(write));
+    write[0] = 6;
+    write[1] = 7;
+    buffer.commit_write(2);
+    CHECK_EQUAL(5, buffer.write_span(write));
+    write[0] = 8;
+    buffer.commit_write(1);
+
+    CHECK_EQUAL(3, buffer.read_span(read));
+    CHECK_EQUAL(5, read[0]);
+    CHECK_EQUAL(7, read[2]);
+    buffer.consume(3);
+    CHECK_EQUAL(1, buffer.read_span(read));
+    CHECK_EQUAL(8, read[0]);
+    buffer.consume(1);
+    CHECK(buffer.empty());
+}
+
+/* A producer and a consumer thread move a sequence through a small buffer; the consumer
+ checks that no element is lost, duplicated or reordered */
+
+#define ELEMENTS 2000000
+
+static SPSCCircularBuffer<uint32_t, 64> shared;
+
+static void single_producer(void const *argument) {
+    for (uint32_t i = 0; i < ELEMENTS; ) {
+        if (shared.push(i))
+            i++;
+        else
+            Thread::yield();
+    }
+}
+
+static void span_producer(void const *argument) {
+    for (uint32_t i = 0; i < ELEMENTS; ) {
+        uint32_t *span;
+        uint32_t count = shared.write_span(span);
+        if (count == 0) {
+            Thread::yield();
+            continue;
+        }
+        if (count > ELEMENTS - i)
+            count = ELEMENTS - i;
+        for (uint32_t n = 0; n < count; n++)
+            span[n] = i + n;
+        shared.commit_write(count);
+        i += count;
+    }
+}
+
+static uint32_t consume_sequence(bool spans) {
+    uint32_t expected = 0, errors = 0;
+    while (expected < ELEMENTS) {
+        uint32_t block[16];
+        const uint32_t *data = block;
+        uint32_t count = spans ? shared.read_span(data) : shared.pop(block, 16);
+        if (count == 0) {
+            Thread::yield();
+            continue;
+        }
+        for (uint32_t n = 0; n < count; n++) {
+            if (data[n] != expected)
+                errors++;
+            expected = data[n] + 1;
+        }
+        if (spans)
+            shared.consume(count);
+    }
+    return errors;
+}
+
+TEST(producer_and_consumer_threads) {
+    {
+        Thread producer(single_producer);
+        CHECK_EQUAL(0, consume_sequence(false));
+    }
+    CHECK(shared.empty());
+    {
+        Thread producer(span_producer);
+        CHECK_EQUAL(0, consume_sequence(true));
+    }
+    CHECK(shared.empty());
+}
+
+/*--------------------------- Benchmark ------------------------------------*/
+
+/* Elements through the buffer and back in one thread, so the numbers compare the buffer
+ code and not the thread switches of the host. __DMB is a full fence on the host, which
+ costs more than the DMB of the Cortex-M3; the bulk operations pay it once per block. */
+
+#define ROUNDS 2000000
+#define BLOCK 16
+
+TEST(benchmark_against_circular_buffer) {
+    static CircularBuffer<uint32_t, 64> circular;
+    uint32_t value = 0, sum = 0;
+    uint64_t start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        circular.push(i);
+        circular.pop(value);
+        sum += value;
+    }
+    host_test::report("CircularBuffer push, pop", ROUNDS, host_test::now_ns() - start);
+
+    static SPSCCircularBuffer<uint32_t, 64> spsc;
+    start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        spsc.push(i);
+        spsc.pop(value);
+        sum -= value;
+    }
+    host_test::report("SPSCCircularBuffer push, pop", ROUNDS, host_test::now_ns() - start);
+    CHECK_EQUAL(0, sum);
+
+    uint32_t block[BLOCK];
+    for (uint32_t i = 0; i < BLOCK; i++)
+        block[i] = i;
+    start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i += BLOCK) {
+        spsc.push(block, BLOCK);
+        spsc.pop(block, BLOCK);
+    }
+    host_test::report("SPSCCircularBuffer bulk, per element", ROUNDS, host_test::now_ns() - start);
+    CHECK_EQUAL(BLOCK - 1, block[BLOCK - 1]);
+}
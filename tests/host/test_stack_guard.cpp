@@ -0,0 +1,111 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+
+/* rt_TypeDef.h defines NULL as in C, use 0 below */
+#undef NULL
+
+extern "C" {
+#include "rt_TypeDef.h"
+#include "rt_System.h"
+}
+
+/* The MPU stack guard region of rt_stk_guard for every stack size of RTX_Conf_CM.c (64 to 4096
+ bytes in steps of 8) at every word aligned position of the stack bottom, and a stack overflow
+ simulated word by word from the top of the stack into the guard. */
+
+#define STACK_MEMORY    0x10000000u
+
+TEST(guard_region_inside_every_stack) {
+    uint32_t guarded = 0, unguarded = 0;
+    uint32_t min_lost = 0xFFFFFFFF, max_lost = 0;
+
+    for (uint32_t size = 64; size <= 4096; size += 8) {
+        for (uint32_t offset = 0; offset < STK_GUARD_SIZE; offset += 4) {
+            uint32_t stack = STACK_MEMORY + offset;
+            uint32_t base = rt_stk_guard_base(stack, size);
+            if (size < 4 * STK_GUARD_SIZE) {
+                CHECK_EQUAL(0, base);
+                unguarded++;
+                continue;
+            }
+            guarded++;
+
+            // a valid MPU region: aligned to its size, and covering only the stack itself
+            CHECK_EQUAL(0, base % STK_GUARD_SIZE);
+            CHECK(base >= stack);
+            CHECK(base + STK_GUARD_SIZE <= stack + size);
+            CHECK(base - stack < STK_GUARD_SIZE);
+
+            // the bytes below and in the guard are lost for the thread
+            uint32_t lost = base + STK_GUARD_SIZE - stack;
+            if (lost < min_lost)
+                min_lost = lost;
+            if (lost > max_lost)
+                max_lost = lost;
+
+            // an overflow pushes word after word from the top, the first write into the guard faults
+            uint32_t sp = stack + size;
+            uint32_t fault = 0;
+            while (sp > stack) {
+                sp -= 4;
+                if ((sp >= base) && (sp < base + STK_GUARD_SIZE)) {
+                    fault = sp;
+                    break;
+                }
+            }
+            CHECK_EQUAL(base + STK_GUARD_SIZE - 4, fault);
+            CHECK(sp >= stack);
+        }
+    }
+    printf("    %u stacks guarded, %u too small, %u to %u bytes of a stack lost to the guard\n",
+           (unsigned)guarded, (unsigned)unguarded, (unsigned)min_lost, (unsigned)max_lost);
+    CHECK_EQUAL(STK_GUARD_SIZE, min_lost);
+    CHECK_EQUAL(2 * STK_GUARD_SIZE - 4, max_lost);
+}
+
+TEST(guard_of_rtx_stacks) {
+    // the stack sizes of the car threads, at the 8 byte alignment of the stack arrays
+    static const uint32_t sizes[] = { 128, 200, 512, 1024, 2048, 4096 };
+    for (uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for (uint32_t offset = 0; offset < STK_GUARD_SIZE; offset += 8) {
+            uint32_t base = rt_stk_guard_base(STACK_MEMORY + offset, sizes[i]);
+            CHECK_EQUAL(STACK_MEMORY + ((offset == 0) ? 0 : STK_GUARD_SIZE), base);
+        }
+    }
+    CHECK_EQUAL(0, rt_stk_guard_base(STACK_MEMORY, 4 * STK_GUARD_SIZE - 8));
+}
+
+TEST(guard_attributes) {
+    uint32_t rasr = STK_GUARD_RASR;
+    CHECK_EQUAL(1, rasr & 1);                   // enabled
+    CHECK_EQUAL(4, (rasr >> 1) & 0x1F);         // 2^(4+1) = STK_GUARD_SIZE bytes
+    CHECK_EQUAL(STK_GUARD_SIZE, 1u << (((rasr >> 1) & 0x1F) + 1));
+    CHECK_EQUAL(0, (rasr >> 8) & 0xFF);         // no subregion disabled
+    CHECK_EQUAL(1, (rasr >> 16) & 1);           // B
+    CHECK_EQUAL(1, (rasr >> 17) & 1);           // C
+    CHECK_EQUAL(0, (rasr >> 18) & 1);           // not shareable
+    CHECK_EQUAL(1, (rasr >> 19) & 7);           // TEX: normal memory, write-back, write and read allocate
+    CHECK_EQUAL(6, (rasr >> 24) & 7);           // read-only for privileged and unprivileged code
+    CHECK_EQUAL(1, (rasr >> 28) & 1);           // no execution
+    CHECK(STK_GUARD_REGION < 8);
+}
@@ -0,0 +1,65 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "Thread.h"
+#include "Semaphore.h"
+
+using namespace rtos;
+
+static Semaphore go(0);
+
+static void worker(void const *argument) {
+    go.wait();
+}
+
+/* All OS_TASKCNT entries are in use with main and OS_TASKCNT - 1 StaticThreads */
+TEST(create_maximum_threads) {
+    static StaticThread<256> *threads[OS_TASKCNT - 1];
+    for (int i = 0; i < OS_TASKCNT - 1; i++) {
+        threads[i] = new StaticThread<256>(worker);
+        CHECK(threads[i]->get_priority() == osPriorityNormal);
+        CHECK_EQUAL(256, threads[i]->stack_size());
+        CHECK_EQUAL(256, threads[i]->free_stack() + threads[i]->used_stack());
+    }
+
+    StaticThread<256> extra(worker);
+    CHECK(extra.get_priority() == osPriorityError);
+
+    for (int i = 0; i < OS_TASKCNT - 1; i++)
+        go.release();
+    for (int i = 0; i < OS_TASKCNT - 1; i++)
+        delete threads[i];
+}
+
+TEST(ram_per_thread) {
+    CHECK_EQUAL(sizeof(Thread) + 256, StaticThread<256>::ram_size());
+    CHECK_EQUAL(sizeof(Thread) + DEFAULT_STACK_SIZE, StaticThread<>::ram_size());
+
+    printf("  RAM per thread: Thread object %u bytes (host layout), stack as configured\n",
+           (unsigned)sizeof(Thread));
+    printf("  StaticThread<256> %u, <512> %u, <1024> %u, <%u> %u bytes\n",
+           (unsigned)StaticThread<256>::ram_size(), (unsigned)StaticThread<512>::ram_size(),
+           (unsigned)StaticThread<1024>::ram_size(), (unsigned)DEFAULT_STACK_SIZE,
+           (unsigned)StaticThread<>::ram_size());
+    printf("  %u threads of StaticThread<256>: %u bytes\n", (unsigned)(OS_TASKCNT - 1),
+           (unsigned)((OS_TASKCNT - 1) * StaticThread<256>::ram_size()));
+}
@@ -0,0 +1,224 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "ChainStage.h"
+#include "CoopScheduler.h"
+#include "TaskWatchdog.h"
+#include "Thread.h"
+#include "us_ticker_api.h"
+
+using namespace rtos;
+
+/* Overruns are injected into the steps of a chain stage and of a cooperative task, the detection
+ latency is the time from the end of the budget to the notification of the handler. */
+
+#define CHECK_MS    10
+#define BUDGET_US   5000
+// scheduling slack of the host threads
+#define SLACK_US    10000
+
+static void join(Thread &thread) {
+    while (thread.get_state() != Thread::Inactive)
+        Thread::wait(1);
+}
+
+/* last violation of each kind */
+struct Detection {
+    const WatchedTask *task;
+    uint32_t deadline_us;       /* end of the budget, or of the second period without a cycle */
+    uint32_t detected_us;
+    uint32_t count;
+
+    uint32_t latency_us() const {
+        return detected_us - deadline_us;
+    }
+};
+
+static Detection overrun, missed;
+
+static void detect(WatchedTask &task, WatchdogViolation violation) {
+    Detection &detection = (violation == WatchdogOverrun) ? overrun : missed;
+    detection.task = &task;
+    detection.deadline_us = task.start_us +
+                            ((violation == WatchdogOverrun) ? task.budget_us : 2 * task.period_us);
+    detection.detected_us = us_ticker_read();
+    detection.count++;
+}
+
+static void reset_detections() {
+    overrun = Detection();
+    missed = Detection();
+}
+
+/* the step takes the given time, sleeping or spinning as a step stuck in a busy loop */
+static volatile uint32_t step_ms;
+static volatile bool spin;
+
+static void overrun_step(void const *argument) {
+    uint32_t ms = step_ms;
+    if (spin) {
+        uint32_t start_us = us_ticker_read();
+        while (us_ticker_read() - start_us < ms * 1000)
+            ;
+    } else if (ms != 0) {
+        Thread::wait(ms);
+    }
+}
+
+TEST(chain_stage_overrun_detected_while_running) {
+    reset_detections();
+    TaskWatchdog watchdog(CHECK_MS);
+    watchdog.set_handler(detect);
+    WatchedTask record;
+    ChainStage stage(overrun_step);
+    stage.watch(watchdog, record, "stage", 1000000, BUDGET_US);
+    Thread thread(ChainStage::thread, &stage, osPriorityAboveNormal);
+
+    step_ms = 1;
+    spin = false;
+    for (int i = 0; i < 5; i++) {
+        stage.activate();
+        Thread::wait(5);
+    }
+    CHECK_EQUAL(5, record.cycles);
+    CHECK_EQUAL(0, watchdog.violations());
+
+    // the step hangs far beyond its budget, the watchdog timer reports it before the step ends
+    step_ms = 100;
+    stage.activate();
+    Thread::wait(60);
+    CHECK_EQUAL(1, overrun.count);
+    CHECK(overrun.task == &record);
+    CHECK(record.running);
+    printf("    chain stage overrun detected %u us after the budget\n", (unsigned)overrun.latency_us());
+    CHECK(overrun.latency_us() <= CHECK_MS * 1000 + SLACK_US);
+
+    // counted once per cycle, also when the step ends
+    Thread::wait(60);
+    CHECK(!record.running);
+    CHECK_EQUAL(1, record.overruns);
+    CHECK_EQUAL(1, overrun.count);
+    CHECK(record.max_exec_us >= 100000);
+
+    thread.terminate();
+    join(thread);
+}
+
+TEST(chain_stage_overrun_detected_at_end) {
+    reset_detections();
+    // the timer checks too rarely, the overrun is found when the step ends
+    TaskWatchdog watchdog(1000);
+    watchdog.set_handler(detect);
+    WatchedTask record;
+    ChainStage stage(overrun_step);
+    stage.watch(watchdog, record, "stage", 1000000, BUDGET_US);
+    Thread thread(ChainStage::thread, &stage, osPriorityAboveNormal);
+
+    step_ms = 8;
+    spin = true;
+    stage.activate();
+    Thread::wait(30);
+    CHECK_EQUAL(1, record.overruns);
+    CHECK_EQUAL(1, overrun.count);
+    printf("    chain stage overrun of 3 ms detected %u us after the budget\n", (unsigned)overrun.latency_us());
+    CHECK(overrun.latency_us() >= 3000);
+    CHECK(overrun.latency_us() <= 3000 + SLACK_US);
+
+    thread.terminate();
+    join(thread);
+}
+
+TEST(chain_stage_missed) {
+    reset_detections();
+    TaskWatchdog watchdog(CHECK_MS);
+    watchdog.set_handler(detect);
+    WatchedTask record;
+    ChainStage stage(overrun_step);
+    stage.watch(watchdog, record, "stage", 20000, BUDGET_US);
+    Thread thread(ChainStage::thread, &stage, osPriorityAboveNormal);
+
+    // never activated: missed once no step started for two periods
+    step_ms = 0;
+    spin = false;
+    Thread::wait(100);
+    CHECK_EQUAL(1, record.missed);
+    CHECK_EQUAL(1, missed.count);
+    CHECK_EQUAL(0, overrun.count);
+    printf("    missed chain stage detected %u us after two periods\n", (unsigned)missed.latency_us());
+    CHECK(missed.latency_us() <= CHECK_MS * 1000 + SLACK_US);
+
+    thread.terminate();
+    join(thread);
+}
+
+static StaticCoopScheduler<4> scheduler;
+static volatile bool hang;
+
+/* an LCD update of 1 ms, or a hung one of 80 ms, less than two periods, when requested */
+static void lcd_step(void const *argument) {
+    step_ms = hang ? 80 : 1;
+    hang = false;
+    overrun_step(argument);
+}
+
+static void light_step(void const *argument) {
+}
+
+TEST(cooperative_task_overrun) {
+    reset_detections();
+    TaskWatchdog watchdog(CHECK_MS);
+    watchdog.set_handler(detect);
+    WatchedTask lcd_record, light_record;
+    int lcd = scheduler.add_periodic(lcd_step, 50);
+    int light = scheduler.add_periodic(light_step, 20);
+    int event = scheduler.add_event(light_step);
+    CHECK(scheduler.watch(lcd, watchdog, lcd_record, "lcd", BUDGET_US) == osOK);
+    CHECK(scheduler.watch(light, watchdog, light_record, "light", BUDGET_US) == osOK);
+    CHECK(scheduler.watch(event, watchdog, light_record, "event", BUDGET_US) == osErrorParameter);
+    CHECK(scheduler.watch(3, watchdog, light_record, "none", BUDGET_US) == osErrorParameter);
+
+    spin = true;
+    Thread thread(CoopScheduler::thread, &scheduler, osPriorityAboveNormal);
+    Thread::wait(200);
+    CHECK(lcd_record.cycles >= 3);
+    CHECK(light_record.cycles >= 8);
+    CHECK_EQUAL(0, watchdog.violations());
+
+    // the LCD step hangs: its own overrun is found while it runs, the starved light task is missed
+    hang = true;
+    Thread::wait(300);
+    CHECK(!hang);
+    CHECK_EQUAL(1, overrun.count);
+    CHECK(overrun.task == &lcd_record);
+    printf("    cooperative task overrun detected %u us after the budget\n", (unsigned)overrun.latency_us());
+    CHECK(overrun.latency_us() <= CHECK_MS * 1000 + SLACK_US);
+    CHECK_EQUAL(1, missed.count);
+    CHECK(missed.task == &light_record);
+    printf("    starved cooperative task detected %u us after two periods\n", (unsigned)missed.latency_us());
+    CHECK(missed.latency_us() <= CHECK_MS * 1000 + SLACK_US);
+    CHECK_EQUAL(1, lcd_record.overruns);
+    CHECK_EQUAL(0, light_record.overruns);
+    CHECK_EQUAL(0, lcd_record.missed);
+
+    thread.terminate();
+    join(thread);
+}
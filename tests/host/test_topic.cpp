@@ -0,0 +1,245 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "Topic.h"
+#include "Semaphore.h"
+#include "Thread.h"
+
+using namespace rtos;
+
+#define SIGNAL 0x1
+
+TEST(versions) {
+    Topic<uint32_t> topic(7);
+    CHECK_EQUAL(0, topic.version());
+    CHECK_EQUAL(7, topic.get());
+    CHECK(!topic.changed_since(0));
+
+    uint32_t value = 0, version = 0;
+    CHECK(!topic.read_if_changed(value, version));
+    topic.publish(8);
+    topic.publish(9);
+    CHECK_EQUAL(2, topic.version());
+    CHECK(topic.changed_since(0));
+    CHECK(topic.read_if_changed(value, version));
+    CHECK_EQUAL(9, value);
+    CHECK_EQUAL(2, version);
+    CHECK(!topic.read_if_changed(value, version));
+}
+
+/* every subscriber sees increasing values and ends with the last one */
+
+#define SUBSCRIBERS 16
+#define PUBLISHES 500
+
+static Topic<uint32_t> counter;
+static Semaphore subscribed(0);
+
+struct SubscriberResult {
+    uint32_t seen;
+    uint32_t last;
+    bool ordered;
+};
+
+static void subscriber(void const *argument) {
+    SubscriberResult *result = (SubscriberResult*)argument;
+    TopicSubscription subscription;
+    counter.subscribe(subscription, SIGNAL);
+    subscribed.release();
+
+    uint32_t value = 0;
+    while (result->last != PUBLISHES) {
+        if (!counter.wait(subscription, value, 1000))
+            break;
+        if (value <= result->last)
+            result->ordered = false;
+        result->last = value;
+        result->seen++;
+    }
+    counter.unsubscribe(subscription);
+}
+
+TEST(many_subscribers) {
+    SubscriberResult results[SUBSCRIBERS];
+    Thread *threads[SUBSCRIBERS];
+    for (int i = 0; i < SUBSCRIBERS; i++) {
+        results[i].seen = 0;
+        results[i].last = 0;
+        results[i].ordered = true;
+        threads[i] = new Thread(subscriber, &results[i]);
+    }
+    for (int i = 0; i < SUBSCRIBERS; i++)
+        subscribed.wait();
+
+    for (uint32_t value = 1; value <= PUBLISHES; value++) {
+        counter.publish(value);
+        if ((value % 50) == 0)
+            Thread::wait(1);
+    }
+    for (int i = 0; i < SUBSCRIBERS; i++) {
+        while (threads[i]->get_state() != Thread::Inactive)
+            Thread::wait(1);
+        delete threads[i];
+
+        CHECK_EQUAL(PUBLISHES, results[i].last);
+        CHECK(results[i].ordered);
+        CHECK(results[i].seen >= 1);
+        CHECK(results[i].seen <= PUBLISHES);
+    }
+    printf("    values seen of %d published:", PUBLISHES);
+    for (int i = 0; i < SUBSCRIBERS; i++)
+        printf(" %u", (unsigned)results[i].seen);
+    printf("\n");
+}
+
+/* a read never mixes two published values */
+
+#define WORDS 16
+
+struct Wide {
+    uint32_t word[WORDS];
+};
+
+static Topic<Wide> wide;
+static volatile bool publishing;
+
+static void torn_reader(void const *argument) {
+    uint32_t *torn = (uint32_t*)argument;
+    while (publishing) {
+        Wide value = wide.get();
+        for (int i = 1; i < WORDS; i++) {
+            if (value.word[i] != value.word[0]) {
+                (*torn)++;
+                break;
+            }
+        }
+    }
+}
+
+TEST(no_torn_reads) {
+    uint32_t torn[4] = { 0, 0, 0, 0 };
+    publishing = true;
+    Thread *readers[4];
+    for (int i = 0; i < 4; i++)
+        readers[i] = new Thread(torn_reader, &torn[i]);
+
+    Wide value;
+    for (uint32_t n = 1; n <= 200000; n++) {
+        for (int i = 0; i < WORDS; i++)
+            value.word[i] = n;
+        wide.publish(value);
+        if ((n % 1000) == 0)
+            Thread::yield();
+    }
+    publishing = false;
+    for (int i = 0; i < 4; i++) {
+        while (readers[i]->get_state() != Thread::Inactive)
+            Thread::wait(1);
+        delete readers[i];
+        CHECK_EQUAL(0, torn[i]);
+    }
+}
+
+/* a subscription with a minimum interval skips the values published in between */
+
+static Topic<uint32_t> fast;
+
+static void fast_publisher(void const *argument) {
+    for (uint32_t value = 1; value <= 200; value++) {
+        fast.publish(value);
+        Thread::wait(1);
+    }
+}
+
+TEST(rate_limited_subscription) {
+    TopicSubscription subscription;
+    fast.subscribe(subscription, SIGNAL, 20);
+
+    uint32_t changes = 0, value = 0;
+    uint64_t start = host_test::now_ns();
+    {
+        Thread publisher(fast_publisher);
+        while (value != 200) {
+            if (!fast.wait(subscription, value, 1000))
+                break;
+            changes++;
+        }
+    }
+    uint32_t elapsed_ms = (uint32_t)((host_test::now_ns() - start) / 1000000);
+    fast.unsubscribe(subscription);
+
+    printf("    %u changes seen in %u ms\n", (unsigned)changes, (unsigned)elapsed_ms);
+    CHECK_EQUAL(200, value);
+    CHECK(changes >= 2);
+    CHECK(changes <= elapsed_ms / 20 + 2);
+}
+
+/*--------------------------- Benchmark ------------------------------------*/
+
+/* Cost of one publish by the number of subscribers. The subscribers stay blocked on a
+ semaphore, so a publish pays for setting their signals but no thread switch. */
+
+#define ROUNDS 100000
+
+static Topic<uint32_t> measured;
+static Semaphore stop(0);
+
+static void parked_subscriber(void const *argument) {
+    TopicSubscription subscription;
+    measured.subscribe(subscription, SIGNAL);
+    subscribed.release();
+    stop.wait();
+    measured.unsubscribe(subscription);
+}
+
+TEST(benchmark_publish_by_subscribers) {
+    static const int counts[] = { 0, 1, 4, 16 };
+    for (unsigned c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        Thread *threads[16];
+        for (int i = 0; i < counts[c]; i++)
+            threads[i] = new Thread(parked_subscriber);
+        for (int i = 0; i < counts[c]; i++)
+            subscribed.wait();
+
+        uint64_t start = host_test::now_ns();
+        for (uint32_t i = 0; i < ROUNDS; i++)
+            measured.publish(i);
+        char name[48];
+        snprintf(name, sizeof(name), "publish, %d subscribers", counts[c]);
+        host_test::report(name, ROUNDS, host_test::now_ns() - start);
+
+        for (int i = 0; i < counts[c]; i++)
+            stop.release();
+        for (int i = 0; i < counts[c]; i++) {
+            while (threads[i]->get_state() != Thread::Inactive)
+                Thread::wait(1);
+            delete threads[i];
+        }
+    }
+
+    uint32_t sum = 0;
+    uint64_t start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+        sum += measured.get();
+    host_test::report("get", ROUNDS, host_test::now_ns() - start);
+    CHECK(sum != 0);
+}
@@ -0,0 +1,173 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <vector>
+
+#include "host_test.h"
+#include "host_port.h"
+#include "TTExecutive.h"
+#include "Thread.h"
+
+using namespace rtos;
+
+/* Virtual-time runner: the us_ticker only moves when a step "executes" for its cost,
+ so the dispatch sequence and the statistics are exact. */
+
+struct Dispatch {
+    uint32_t time_ms;
+    int task;
+};
+
+static std::vector<Dispatch> dispatched;
+static uint32_t frame_time_ms;
+static uint32_t step_cost_us = 100;
+
+template<int task>
+static void step(void const *argument) {
+    Dispatch d = { frame_time_ms, task };
+    dispatched.push_back(d);
+    host_ticker_advance(step_cost_us);
+}
+
+/* The periods of the car simulation, with the offsets of main.cpp */
+static const TTTask car_schedule[] = {
+    { step<0>,   0,   100 },
+    { step<1>,   0,   500 },
+    { step<2>,   0,    50 },
+    { step<3>,  50,   200 },
+    { step<4>, 100,  2000 },
+    { step<5>, 150,  2000 },
+    { step<6>, 200,  1000 },
+    { step<7>, 250,   500 },
+    { step<8>, 300,  5000 },
+    { step<9>, 350, 20000 },
+};
+static const uint32_t tasks = sizeof(car_schedule) / sizeof(car_schedule[0]);
+
+/* Run a number of hyperperiods frame by frame, each frame released on time */
+static void run_virtual(TTExecutive &executive, uint32_t hyperperiods) {
+    dispatched.clear();
+    host_ticker_virtual(true);
+    uint32_t frames = hyperperiods * (executive.hyperperiod() / executive.minor_frame());
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        uint32_t release_us = frame * executive.minor_frame() * 1000;
+        host_ticker_set(release_us);
+        frame_time_ms = (frame * executive.minor_frame()) % executive.hyperperiod();
+        executive.dispatch(frame_time_ms, release_us);
+    }
+    host_ticker_virtual(false);
+}
+
+TEST(frames_of_the_car_schedule) {
+    TTStats stats[tasks] = {};
+    TTExecutive executive(car_schedule, stats, tasks);
+    CHECK_EQUAL(50, executive.minor_frame());
+    CHECK_EQUAL(20000, executive.hyperperiod());
+}
+
+TEST(dispatch_sequence_over_three_hyperperiods) {
+    TTStats stats[tasks] = {};
+    TTExecutive executive(car_schedule, stats, tasks);
+    run_virtual(executive, 3);
+
+    // expected: every multiple of the minor frame, the released tasks in table order
+    std::vector<Dispatch> expected;
+    std::vector<uint32_t> max_before(tasks, 0);
+    for (uint32_t t = 0; t < 3 * 20000; t += 50) {
+        uint32_t before = 0;
+        for (uint32_t i = 0; i < tasks; i++) {
+            if ((t % car_schedule[i].period_ms) == car_schedule[i].offset_ms) {
+                Dispatch d = { t % 20000, (int)i };
+                expected.push_back(d);
+                if (before > max_before[i])
+                    max_before[i] = before;
+                before++;
+            }
+        }
+    }
+
+    CHECK_EQUAL(expected.size(), dispatched.size());
+    uint32_t mismatches = 0;
+    for (size_t n = 0; (n < expected.size()) && (n < dispatched.size()); n++) {
+        if ((expected[n].time_ms != dispatched[n].time_ms) || (expected[n].task != dispatched[n].task))
+            mismatches++;
+    }
+    CHECK_EQUAL(0, mismatches);
+
+    for (uint32_t i = 0; i < tasks; i++) {
+        CHECK_EQUAL(3 * 20000 / car_schedule[i].period_ms, stats[i].runs);
+        CHECK_EQUAL(0, stats[i].overruns);
+        // a task waits for the steps before it in its busiest frame
+        CHECK_EQUAL(max_before[i] * step_cost_us, stats[i].max_jitter_us);
+    }
+}
+
+TEST(steps_ending_after_the_frame_are_overruns) {
+    TTStats stats[tasks] = {};
+    TTExecutive executive(car_schedule, stats, tasks);
+    step_cost_us = 20000;                           // only two steps of 20 ms fit in 50 ms
+    run_virtual(executive, 1);
+    step_cost_us = 100;
+
+    // a step overruns in every frame in which two steps run before it
+    for (uint32_t i = 0; i < tasks; i++) {
+        uint32_t expected = 0;
+        for (uint32_t t = car_schedule[i].offset_ms; t < 20000; t += car_schedule[i].period_ms) {
+            uint32_t before = 0;
+            for (uint32_t j = 0; j < i; j++) {
+                if ((t % car_schedule[j].period_ms) == car_schedule[j].offset_ms)
+                    before++;
+            }
+            if (before >= 2)
+                expected++;
+        }
+        CHECK_EQUAL(expected, stats[i].overruns);
+    }
+    CHECK(stats[2].overruns > 0);
+}
+
+/* run() with the minor frame timer: a step blocking for 2.5 frames makes the two
+ frames released meanwhile late, each counted once. The slow step and the first late
+ step end after the end of their frames. */
+
+static volatile uint32_t slow_calls;
+
+static void slow_step(void const *argument) {
+    if (++slow_calls == 3)
+        Thread::wait(50);
+}
+
+TEST(late_frames_are_counted_once) {
+    static const TTTask table[] = {
+        { slow_step, 0, 20 },
+    };
+    static TTStats stats[1];
+    static TTExecutive executive(table, stats, 1);
+    CHECK_EQUAL(20, executive.minor_frame());
+
+    Thread thread(TTExecutive::thread, &executive);
+    Thread::wait(200);
+    thread.terminate();
+
+    CHECK(slow_calls >= 8);
+    CHECK_EQUAL(2, executive.frame_overruns());
+    CHECK_EQUAL(2, executive.stats(0)->overruns);
+}
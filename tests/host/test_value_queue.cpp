@@ -0,0 +1,165 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "host_test.h"
+#include "host_port.h"
+#include "ValueQueue.h"
+#include "Mail.h"
+#include "MemoryPool.h"
+#include "Thread.h"
+
+using namespace rtos;
+
+/* the sample of main.cpp */
+typedef struct {
+  float    speedVal;
+  float    accelerometerVal;
+  float    breakVal;
+  uint32_t captureTime;
+  uint32_t sampleId;
+} mail_t;
+
+TEST(put_and_get_copy_values) {
+    ValueQueue<mail_t, 4> queue;
+    mail_t sample = { 1.0f, 2.0f, 3.0f, 100, 1 };
+    CHECK_EQUAL(osOK, queue.put(sample));
+    sample.sampleId = 2;
+    CHECK_EQUAL(osOK, queue.put(sample));
+    CHECK_EQUAL(2, queue.count());
+
+    mail_t received = { 0, 0, 0, 0, 0 };
+    CHECK_EQUAL(osOK, queue.get(received, 0));
+    CHECK_EQUAL(1, received.sampleId);
+    CHECK(received.breakVal == 3.0f);
+    CHECK_EQUAL(osOK, queue.get(received, 0));
+    CHECK_EQUAL(2, received.sampleId);
+    CHECK_EQUAL(osEventTimeout, queue.get(received, 0));
+    CHECK_EQUAL(0, queue.count());
+}
+
+TEST(full_queue) {
+    ValueQueue<uint32_t, 3> queue;
+    for (uint32_t i = 0; i < 3; i++)
+        CHECK_EQUAL(osOK, queue.put(i));
+    CHECK_EQUAL(osErrorResource, queue.put(3));
+    uint64_t start = host_test::now_ns();
+    CHECK_EQUAL(osEventTimeout, queue.put(3, 20));
+    CHECK((host_test::now_ns() - start) >= 19000000);
+
+    // the ring wraps around
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < 10; i++) {
+        CHECK_EQUAL(osOK, queue.get(value, 0));
+        CHECK_EQUAL(i, value);
+        CHECK_EQUAL(osOK, queue.put(i + 3));
+    }
+}
+
+TEST(put_from_isr) {
+    ValueQueue<uint32_t, 2> queue;
+    host_isr_enter();
+    CHECK_EQUAL(osOK, queue.put(1));
+    CHECK_EQUAL(osErrorParameter, queue.put(2, 10));
+    CHECK_EQUAL(osOK, queue.put(2));
+    CHECK_EQUAL(osErrorResource, queue.put(3));
+    host_isr_exit();
+    CHECK_EQUAL(2, queue.count());
+}
+
+#define VALUES 20000
+
+static ValueQueue<uint32_t, 8> shared_queue;
+
+static void slow_consumer(void const *argument) {
+    uint32_t *sum = (uint32_t*)argument;
+    uint32_t value;
+    for (uint32_t i = 0; i < VALUES; i++) {
+        if (shared_queue.get(value, 1000) != osOK)
+            break;
+        *sum += value;
+    }
+}
+
+TEST(blocking_put_and_get) {
+    uint32_t sum = 0, expected = 0;
+    {
+        Thread consumer(slow_consumer, &sum);
+        for (uint32_t i = 0; i < VALUES; i++) {
+            CHECK_EQUAL(osOK, shared_queue.put(i, osWaitForever));
+            expected += i;
+        }
+        while (shared_queue.count() != 0)
+            Thread::wait(1);
+        Thread::wait(10);
+    }
+    CHECK_EQUAL(expected, sum);
+}
+
+/*--------------------------- Benchmark ------------------------------------*/
+
+/* One mail_t sample through the queue and back in the same thread: ValueQueue copies
+ it, Mail allocates a block, which is freed again after the get */
+
+#define ROUNDS 200000
+
+TEST(benchmark_against_mail) {
+    static ValueQueue<mail_t, 100> queue;
+    mail_t sample = { 1.0f, 2.0f, 3.0f, 0, 0 };
+    mail_t received = sample;
+    uint64_t start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        sample.sampleId = i;
+        queue.put(sample);
+        queue.get(received);
+    }
+    host_test::report("ValueQueue put, get", ROUNDS, host_test::now_ns() - start);
+    CHECK_EQUAL(ROUNDS - 1, received.sampleId);
+
+    static Mail<mail_t, 100> mail;
+    start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        mail_t *block = mail.alloc();
+        *block = sample;
+        block->sampleId = i;
+        mail.put(block);
+        osEvent evt = mail.get();
+        received = *(mail_t*)evt.value.p;
+        mail.free((mail_t*)evt.value.p);
+    }
+    host_test::report("Mail alloc, put, get, free", ROUNDS, host_test::now_ns() - start);
+    CHECK_EQUAL(ROUNDS - 1, received.sampleId);
+
+    static MemoryPool<mail_t, 100> pool;
+    static ValueQueue<mail_t*, 100> pointers;
+    start = host_test::now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        mail_t *block = pool.alloc();
+        *block = sample;
+        block->sampleId = i;
+        pointers.put(block);
+        mail_t *got = NULL;
+        pointers.get(got);
+        received = *got;
+        pool.free(got);
+    }
+    host_test::report("MemoryPool and a pointer queue", ROUNDS, host_test::now_ns() - start);
+    CHECK_EQUAL(ROUNDS - 1, received.sampleId);
+}
@@ -0,0 +1,144 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <algorithm>
+#include <vector>
+
+#include "host_test.h"
+#include "Mutex.h"
+#include "Semaphore.h"
+#include "Thread.h"
+#include "us_ticker_api.h"
+
+using namespace rtos;
+
+/* Wake-up error of Thread::wait_us: time from the requested end of the delay until the
+ thread runs again, measured with the us_ticker. On host the us_ticker interrupt and the
+ threads are scheduled by the host kernel, so the late tail is larger than on the target;
+ the check that holds on both is that no wake-up is early. */
+
+static const uint32_t delays_us[] = { 50, 100, 200, 500, 1000, 2000, 5000, 10000 };
+
+#define SAMPLES 40
+
+TEST(wait_us_wakeup_error) {
+    printf("  %8s %8s %8s %8s %8s   (error in us)\n", "delay", "min", "median", "p95", "max");
+    for (uint32_t d = 0; d < sizeof(delays_us) / sizeof(delays_us[0]); d++) {
+        std::vector<int32_t> errors;
+        for (int i = 0; i < SAMPLES; i++) {
+            uint32_t start_us = us_ticker_read();
+            CHECK_EQUAL(osEventTimeout, Thread::wait_us(delays_us[d]));
+            errors.push_back((int32_t)(us_ticker_read() - start_us - delays_us[d]));
+        }
+        std::sort(errors.begin(), errors.end());
+        CHECK(errors.front() >= 0);
+        printf("  %8u %8d %8d %8d %8d\n", (unsigned)delays_us[d], (int)errors.front(),
+               (int)errors[SAMPLES / 2], (int)errors[SAMPLES * 95 / 100], (int)errors.back());
+    }
+}
+
+TEST(wait_us_zero) {
+    uint32_t start_us = us_ticker_read();
+    CHECK_EQUAL(osEventTimeout, Thread::wait_us(0));
+    CHECK((us_ticker_read() - start_us) < 1000);
+}
+
+/* Microsecond timeouts of Semaphore::wait_us and Mutex::lock_us: a timeout never ends early and
+ ends at most one sleep slice (plus the wake-up error) late, a release is seen during the wait. */
+
+static const uint32_t timeouts_us[] = { 100, 300, 700, 1500, 2500, 4200 };
+
+static Semaphore empty(0);
+
+TEST(semaphore_wait_us_timeout) {
+    printf("  %8s %8s %8s   (semaphore timeout error in us)\n", "timeout", "min", "max");
+    for (uint32_t t = 0; t < sizeof(timeouts_us) / sizeof(timeouts_us[0]); t++) {
+        int32_t min_error = 0x7FFFFFFF, max_error = 0;
+        for (int i = 0; i < SAMPLES / 4; i++) {
+            uint32_t start_us = us_ticker_read();
+            CHECK_EQUAL(0, empty.wait_us(timeouts_us[t]));
+            int32_t error = (int32_t)(us_ticker_read() - start_us - timeouts_us[t]);
+            min_error = std::min(min_error, error);
+            max_error = std::max(max_error, error);
+        }
+        CHECK(min_error >= 0);
+        printf("  %8u %8d %8d\n", (unsigned)timeouts_us[t], (int)min_error, (int)max_error);
+    }
+    CHECK_EQUAL(0, empty.wait_us(0));
+}
+
+static Semaphore handoff(0);
+static Mutex shared;
+static volatile uint32_t released_us;
+
+static void release_after(void const *argument) {
+    Thread::wait_us((uint32_t)(uintptr_t)argument);
+    released_us = us_ticker_read();
+    handoff.release();
+}
+
+static void unlock_after(void const *argument) {
+    shared.lock();
+    handoff.release();
+    Thread::wait_us((uint32_t)(uintptr_t)argument);
+    released_us = us_ticker_read();
+    shared.unlock();
+}
+
+static void join(Thread &thread) {
+    while (thread.get_state() != Thread::Inactive)
+        Thread::wait(1);
+}
+
+TEST(semaphore_wait_us_release) {
+    // released in the tick part and in the last tick of the timeout
+    static const uint32_t release_us[] = { 3000, 500 };
+    for (int i = 0; i < 2; i++) {
+        Thread thread(release_after, (void*)(uintptr_t)release_us[i]);
+        uint32_t start_us = us_ticker_read();
+        CHECK_EQUAL(1, handoff.wait_us(10000));
+        uint32_t now_us = us_ticker_read();
+        CHECK((now_us - start_us) < 10000);
+        printf("    released after %u us, seen %u us later\n", (unsigned)release_us[i],
+               (unsigned)(now_us - released_us));
+        join(thread);
+    }
+}
+
+TEST(mutex_lock_us) {
+    Thread thread(unlock_after, (void*)(uintptr_t)5000);
+    handoff.wait();
+
+    // held for 5 ms: a shorter timeout ends without the mutex, and never early
+    uint32_t start_us = us_ticker_read();
+    CHECK_EQUAL(osErrorTimeoutResource, shared.lock_us(700));
+    CHECK((us_ticker_read() - start_us) >= 700);
+    CHECK_EQUAL(osErrorResource, shared.lock_us(0));
+
+    CHECK_EQUAL(osOK, shared.lock_us(20000));
+    CHECK((us_ticker_read() - start_us) < 20000);
+    printf("    mutex unlocked, locked %u us later\n", (unsigned)(us_ticker_read() - released_us));
+    shared.unlock();
+    join(thread);
+
+    CHECK_EQUAL(osOK, shared.lock_us(100));
+    shared.unlock();
+}